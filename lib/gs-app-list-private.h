@@ -69,8 +69,20 @@ void		 gs_app_list_randomize		(GsAppList	*list);
 void		 gs_app_list_remove_all		(GsAppList	*list);
 void		 gs_app_list_truncate		(GsAppList	*list,
 						 guint		 length);
+GsAppList	*gs_app_list_truncate_sorted	(GsAppList	*list,
+						 guint		 length,
+						 GsAppListSortFunc func,
+						 gpointer	 user_data);
 gboolean	 gs_app_list_has_flag		(GsAppList	*list,
 						 GsAppListFlags	 flag);
+void		 gs_app_list_set_cache_limits	(GsAppList	*list,
+						 guint		 max_size,
+						 guint		 max_age);
+guint		 gs_app_list_expire		(GsAppList	*list);
+void		 gs_app_list_get_cache_stats	(GsAppList	*list,
+						 guint		*hits,
+						 guint		*misses,
+						 guint		*evicted);
 
 G_END_DECLS
 
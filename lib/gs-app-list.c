@@ -35,6 +35,7 @@
 
 #include "gs-app-private.h"
 #include "gs-app-list-private.h"
+#include "gs-utils.h"
 
 struct _GsAppList
 {
@@ -44,6 +45,12 @@ struct _GsAppList
 	GMutex			 mutex;
 	guint			 size_peak;
 	GsAppListFlags		 flags;
+	GHashTable		*last_used;		/* app : seconds, or NULL */
+	guint			 cache_max_size;
+	guint			 cache_max_age;
+	guint			 cache_hits;
+	guint			 cache_misses;
+	guint			 cache_evicted;
 };
 
 G_DEFINE_TYPE (GsAppList, gs_app_list, G_TYPE_OBJECT)
@@ -79,8 +86,21 @@ gs_app_list_get_size_peak (GsAppList *list)
 GsApp *
 gs_app_list_lookup (GsAppList *list, const gchar *unique_id)
 {
+	GsApp *app;
 	g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&list->mutex);
-	return g_hash_table_lookup (list->hash_by_id, unique_id);
+	app = g_hash_table_lookup (list->hash_by_id, unique_id);
+
+	/* keep track of what is still being used */
+	if (list->last_used != NULL) {
+		if (app != NULL) {
+			list->cache_hits++;
+			g_hash_table_insert (list->last_used, app,
+					     GUINT_TO_POINTER (g_get_monotonic_time () / G_USEC_PER_SEC));
+		} else {
+			list->cache_misses++;
+		}
+	}
+	return app;
 }
 
 /**
@@ -121,7 +141,7 @@ gs_app_list_check_for_duplicate (GsAppList *list, GsApp *app)
 	}
 
 	/* do a sanity check */
-	if (!as_utils_unique_id_equal (id, id_old)) {
+	if (!gs_utils_unique_id_equal (id, id_old)) {
 		g_debug ("unique-id non-equal %s as %s but hash matched!",
 			 id, id_old);
 		return TRUE;
@@ -150,13 +170,180 @@ gs_app_list_add_safe (GsAppList *list, GsApp *app)
 
 	/* just use the ref */
 	g_ptr_array_add (list->array, g_object_ref (app));
-	g_hash_table_insert (list->hash_by_id, g_strdup (id), g_object_ref (app));
+	g_hash_table_insert (list->hash_by_id,
+			     (gpointer) gs_utils_intern_ref (id),
+			     g_object_ref (app));
+	if (list->last_used != NULL) {
+		g_hash_table_insert (list->last_used, app,
+				     GUINT_TO_POINTER (g_get_monotonic_time () / G_USEC_PER_SEC));
+	}
 
 	/* update the historical max */
 	if (list->array->len > list->size_peak)
 		list->size_peak = list->array->len;
 }
 
+/* apps that are shown, being changed or installed are never evicted */
+static gboolean
+gs_app_list_is_pinned (GsApp *app)
+{
+	if (gs_app_is_shown (app))
+		return TRUE;
+	if (gs_app_is_installed (app))
+		return TRUE;
+	switch (gs_app_get_state (app)) {
+	case AS_APP_STATE_QUEUED_FOR_INSTALL:
+	case AS_APP_STATE_INSTALLING:
+	case AS_APP_STATE_PURCHASING:
+	case AS_APP_STATE_REMOVING:
+		return TRUE;
+	default:
+		break;
+	}
+	return FALSE;
+}
+
+typedef struct {
+	GsApp		*app;
+	guint		 last_used;
+} GsAppListExpireItem;
+
+static gint
+gs_app_list_expire_sort_cb (gconstpointer a, gconstpointer b)
+{
+	const GsAppListExpireItem *item1 = a;
+	const GsAppListExpireItem *item2 = b;
+	if (item1->last_used < item2->last_used)
+		return -1;
+	if (item1->last_used > item2->last_used)
+		return 1;
+	return 0;
+}
+
+static guint
+gs_app_list_expire_safe (GsAppList *list)
+{
+	guint now = g_get_monotonic_time () / G_USEC_PER_SEC;
+	guint n_evict = 0;
+	g_autoptr(GArray) items = NULL;
+	g_autoptr(GHashTable) evict = NULL;
+
+	if (list->last_used == NULL)
+		return 0;
+
+	/* find everything that could be removed */
+	items = g_array_new (FALSE, FALSE, sizeof (GsAppListExpireItem));
+	for (guint i = 0; i < list->array->len; i++) {
+		GsAppListExpireItem item;
+		item.app = g_ptr_array_index (list->array, i);
+		if (gs_app_list_is_pinned (item.app))
+			continue;
+		item.last_used = GPOINTER_TO_UINT (g_hash_table_lookup (list->last_used, item.app));
+		g_array_append_val (items, item);
+	}
+	g_array_sort (items, gs_app_list_expire_sort_cb);
+
+	/* oldest first, until both limits are met */
+	for (guint i = 0; i < items->len; i++) {
+		GsAppListExpireItem *item = &g_array_index (items, GsAppListExpireItem, i);
+		gboolean too_old = list->cache_max_age > 0 &&
+				   now - item->last_used > list->cache_max_age;
+		gboolean too_many = list->cache_max_size > 0 &&
+				    list->array->len - n_evict > list->cache_max_size;
+		if (!too_old && !too_many)
+			break;
+		n_evict++;
+	}
+	if (n_evict == 0)
+		return 0;
+
+	/* remove them in one pass to keep the order of the rest */
+	evict = g_hash_table_new (g_direct_hash, g_direct_equal);
+	for (guint i = 0; i < n_evict; i++) {
+		GsAppListExpireItem *item = &g_array_index (items, GsAppListExpireItem, i);
+		const gchar *unique_id = gs_app_get_unique_id (item->app);
+		g_hash_table_add (evict, item->app);
+		g_hash_table_remove (list->last_used, item->app);
+		if (unique_id != NULL &&
+		    g_hash_table_lookup (list->hash_by_id, unique_id) == item->app)
+			g_hash_table_remove (list->hash_by_id, unique_id);
+	}
+	for (guint i = list->array->len; i > 0; i--) {
+		if (g_hash_table_contains (evict, g_ptr_array_index (list->array, i - 1)))
+			g_ptr_array_remove_index (list->array, i - 1);
+	}
+	list->cache_evicted += n_evict;
+	return n_evict;
+}
+
+/**
+ * gs_app_list_expire:
+ * @list: A #GsAppList
+ *
+ * Removes the least recently used applications until the list is within the
+ * limits set with gs_app_list_set_cache_limits(). Applications that are
+ * installed, being installed or removed, or shown in the UI are kept.
+ *
+ * Returns: the number of applications removed
+ **/
+guint
+gs_app_list_expire (GsAppList *list)
+{
+	g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&list->mutex);
+	g_return_val_if_fail (GS_IS_APP_LIST (list), 0);
+	return gs_app_list_expire_safe (list);
+}
+
+/**
+ * gs_app_list_set_cache_limits:
+ * @list: A #GsAppList
+ * @max_size: the number of applications to keep, or 0 for no limit
+ * @max_age: the number of seconds to keep unused applications, or 0 for no limit
+ *
+ * Makes the list track when each application was last added or looked up, so
+ * that the least recently used can be removed with gs_app_list_expire().
+ * The size limit is also enforced when adding applications.
+ **/
+void
+gs_app_list_set_cache_limits (GsAppList *list, guint max_size, guint max_age)
+{
+	g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&list->mutex);
+	g_return_if_fail (GS_IS_APP_LIST (list));
+	list->cache_max_size = max_size;
+	list->cache_max_age = max_age;
+	if (list->last_used == NULL) {
+		guint now = g_get_monotonic_time () / G_USEC_PER_SEC;
+		list->last_used = g_hash_table_new (g_direct_hash, g_direct_equal);
+		for (guint i = 0; i < list->array->len; i++) {
+			g_hash_table_insert (list->last_used,
+					     g_ptr_array_index (list->array, i),
+					     GUINT_TO_POINTER (now));
+		}
+	}
+}
+
+/**
+ * gs_app_list_get_cache_stats:
+ * @list: A #GsAppList
+ * @hits: (out) (allow-none): the number of successful lookups
+ * @misses: (out) (allow-none): the number of failed lookups
+ * @evicted: (out) (allow-none): the number of applications expired
+ *
+ * Gets the statistics for a list with cache limits set.
+ **/
+void
+gs_app_list_get_cache_stats (GsAppList *list, guint *hits, guint *misses, guint *evicted)
+{
+	g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&list->mutex);
+	g_return_if_fail (GS_IS_APP_LIST (list));
+	if (hits != NULL)
+		*hits = list->cache_hits;
+	if (misses != NULL)
+		*misses = list->cache_misses;
+	if (evicted != NULL)
+		*evicted = list->cache_evicted;
+}
+
 /**
  * gs_app_list_add:
  * @list: A #GsAppList
@@ -179,6 +366,11 @@ gs_app_list_add (GsAppList *list, GsApp *app)
 	g_return_if_fail (GS_IS_APP_LIST (list));
 	g_return_if_fail (GS_IS_APP (app));
 	gs_app_list_add_safe (list, app);
+
+	/* allow some slack so this is not done on every add */
+	if (list->cache_max_size > 0 &&
+	    list->array->len > list->cache_max_size + list->cache_max_size / 10)
+		gs_app_list_expire_safe (list);
 }
 
 /**
@@ -207,6 +399,8 @@ gs_app_list_remove (GsAppList *list, GsApp *app)
 		app_tmp = g_hash_table_lookup (list->hash_by_id, unique_id);
 		if (app_tmp == NULL)
 			return;
+		if (list->last_used != NULL)
+			g_hash_table_remove (list->last_used, app_tmp);
 		g_hash_table_remove (list->hash_by_id, unique_id);
 		g_ptr_array_remove (list->array, app_tmp);
 	} else {
@@ -295,6 +489,8 @@ gs_app_list_remove_all (GsAppList *list)
 	g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&list->mutex);
 	g_return_if_fail (GS_IS_APP_LIST (list));
 	gs_app_list_remove_all_safe (list);
+	if (list->last_used != NULL)
+		g_hash_table_remove_all (list->last_used);
 }
 
 /**
@@ -407,6 +603,160 @@ gs_app_list_truncate (GsAppList *list, guint length)
 	g_ptr_array_set_size (list->array, length);
 }
 
+typedef struct {
+	GPtrArray		*array;
+	GsAppListSortFunc	 func;
+	gpointer		 user_data;
+} GsAppListTopHelper;
+
+/* orders by @func, and then by position to match a stable sort */
+static gint
+gs_app_list_top_cmp (GsAppListTopHelper *helper, guint idx1, guint idx2)
+{
+	GsApp *app1 = g_ptr_array_index (helper->array, idx1);
+	GsApp *app2 = g_ptr_array_index (helper->array, idx2);
+	gint rc = helper->func (app1, app2, helper->user_data);
+	if (rc != 0)
+		return rc;
+	if (idx1 == idx2)
+		return 0;
+	return idx1 < idx2 ? -1 : 1;
+}
+
+static gint
+gs_app_list_top_sort_cb (gconstpointer a, gconstpointer b, gpointer user_data)
+{
+	GsAppListTopHelper *helper = (GsAppListTopHelper *) user_data;
+	return gs_app_list_top_cmp (helper, *(guint *) a, *(guint *) b);
+}
+
+/* restores the heap property below @pos, where the root sorts last */
+static void
+gs_app_list_top_sift_down (GsAppListTopHelper *helper, guint *heap, guint len, guint pos)
+{
+	for (;;) {
+		guint largest = pos;
+		guint child = 2 * pos + 1;
+		guint tmp;
+		if (child < len &&
+		    gs_app_list_top_cmp (helper, heap[child], heap[largest]) > 0)
+			largest = child;
+		if (child + 1 < len &&
+		    gs_app_list_top_cmp (helper, heap[child + 1], heap[largest]) > 0)
+			largest = child + 1;
+		if (largest == pos)
+			return;
+		tmp = heap[pos];
+		heap[pos] = heap[largest];
+		heap[largest] = tmp;
+		pos = largest;
+	}
+}
+
+static void
+gs_app_list_top_sift_up (GsAppListTopHelper *helper, guint *heap, guint pos)
+{
+	while (pos > 0) {
+		guint parent = (pos - 1) / 2;
+		guint tmp;
+		if (gs_app_list_top_cmp (helper, heap[pos], heap[parent]) <= 0)
+			return;
+		tmp = heap[pos];
+		heap[pos] = heap[parent];
+		heap[parent] = tmp;
+		pos = parent;
+	}
+}
+
+/**
+ * gs_app_list_truncate_sorted:
+ * @list: A #GsAppList
+ * @length: the new length
+ * @func: A #GsAppListSortFunc, or %NULL to keep the existing order
+ * @user_data: user data for @func
+ *
+ * Truncates the application list to the @length applications that sort first,
+ * leaving them sorted. This gives the same result as gs_app_list_sort()
+ * followed by gs_app_list_truncate(), but only the applications that are kept
+ * are fully sorted.
+ *
+ * Returns: (transfer full): the applications that were removed, in their
+ * original order
+ **/
+GsAppList *
+gs_app_list_truncate_sorted (GsAppList *list,
+			     guint length,
+			     GsAppListSortFunc func,
+			     gpointer user_data)
+{
+	GsAppList *rest = gs_app_list_new ();
+	GsAppListTopHelper helper;
+	g_autoptr(GMutexLocker) locker = NULL;
+	g_autofree gboolean *kept = NULL;
+	g_autofree guint *heap = NULL;
+	g_autoptr(GPtrArray) array = NULL;
+	guint heap_len = 0;
+
+	g_return_val_if_fail (GS_IS_APP_LIST (list), rest);
+
+	locker = g_mutex_locker_new (&list->mutex);
+	helper.array = list->array;
+	helper.func = func;
+	helper.user_data = user_data;
+
+	/* keep the best @length in a heap where the root is the worst kept */
+	heap = g_new0 (guint, MIN (length, list->array->len) + 1);
+	kept = g_new0 (gboolean, list->array->len);
+	for (guint i = 0; i < list->array->len; i++) {
+		if (heap_len < length) {
+			heap[heap_len] = i;
+			if (func != NULL)
+				gs_app_list_top_sift_up (&helper, heap, heap_len);
+			heap_len++;
+			kept[i] = TRUE;
+			continue;
+		}
+		if (func == NULL)
+			break;
+		if (length == 0 || gs_app_list_top_cmp (&helper, i, heap[0]) >= 0)
+			continue;
+		kept[heap[0]] = FALSE;
+		kept[i] = TRUE;
+		heap[0] = i;
+		gs_app_list_top_sift_down (&helper, heap, heap_len, 0);
+	}
+	if (func != NULL) {
+		g_qsort_with_data (heap, (gint) heap_len, sizeof (guint),
+				   gs_app_list_top_sort_cb, &helper);
+	}
+
+	/* move everything else to the new list */
+	for (guint i = 0; i < list->array->len; i++) {
+		GsApp *app = g_ptr_array_index (list->array, i);
+		const gchar *unique_id;
+		if (kept[i])
+			continue;
+		unique_id = gs_app_get_unique_id (app);
+		if (unique_id != NULL &&
+		    g_hash_table_lookup (list->hash_by_id, unique_id) == app)
+			g_hash_table_remove (list->hash_by_id, unique_id);
+		gs_app_list_add_safe (rest, app);
+	}
+
+	/* mark this list as unworthy */
+	if (gs_app_list_length (rest) > 0)
+		list->flags |= GS_APP_LIST_FLAG_IS_TRUNCATED;
+
+	/* rebuild the array in sorted order */
+	array = g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
+	for (guint i = 0; i < heap_len; i++)
+		g_ptr_array_add (array, g_object_ref (g_ptr_array_index (list->array, heap[i])));
+	g_ptr_array_set_size (list->array, 0);
+	for (guint i = 0; i < array->len; i++)
+		g_ptr_array_add (list->array, g_object_ref (g_ptr_array_index (array, i)));
+	return rest;
+}
+
 static gint
 gs_app_list_randomize_cb (gconstpointer a, gconstpointer b, gpointer user_data)
 {
@@ -484,15 +834,18 @@ gs_app_list_filter_duplicates (GsAppList *list, GsAppListFilterFlags flags)
 
 	g_return_if_fail (GS_IS_APP_LIST (list));
 
-	/* a hash table to hold apps with unique app ids */
-	hash = g_hash_table_new_full (g_str_hash, g_str_equal,
-				      g_free, (GDestroyNotify) g_object_unref);
+	/* a hash table to hold apps with unique app ids; the keys are
+	 * interned so equal keys are always the same pointer */
+	hash = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+				      (GDestroyNotify) gs_utils_intern_unref,
+				      (GDestroyNotify) g_object_unref);
 	/* an array to hold apps that have NULL app ids */
 	apps_no_id = g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
 
 	for (guint i = 0; i < list->array->len; i++) {
 		GsApp *app;
 		GsApp *found;
+		const gchar *key_interned;
 		g_autoptr(GString) key = NULL;
 
 		app = gs_app_list_index (list, i);
@@ -522,11 +875,12 @@ gs_app_list_filter_duplicates (GsAppList *list, GsAppListFilterFlags flags)
 			g_ptr_array_add (apps_no_id, g_object_ref (app));
 			continue;
 		}
-		found = g_hash_table_lookup (hash, key->str);
+		key_interned = gs_utils_intern_ref (key->str);
+		found = g_hash_table_lookup (hash, key_interned);
 		if (found == NULL) {
 			g_debug ("found new %s", key->str);
 			g_hash_table_insert (hash,
-					     g_strdup (key->str),
+					     (gpointer) key_interned,
 					     g_object_ref (app));
 			continue;
 		}
@@ -540,7 +894,7 @@ gs_app_list_filter_duplicates (GsAppList *list, GsAppListFilterFlags flags)
 					 gs_app_get_priority (app),
 					 gs_app_get_priority (found));
 				g_hash_table_insert (hash,
-						     g_strdup (key->str),
+						     (gpointer) key_interned,
 						     g_object_ref (app));
 				continue;
 			}
@@ -548,9 +902,11 @@ gs_app_list_filter_duplicates (GsAppList *list, GsAppListFilterFlags flags)
 				 key->str,
 				 gs_app_get_priority (app),
 				 gs_app_get_priority (found));
+			gs_utils_intern_unref (key_interned);
 			continue;
 		}
 		g_debug ("ignoring duplicate %s", key->str);
+		gs_utils_intern_unref (key_interned);
 		continue;
 	}
 
@@ -601,6 +957,8 @@ gs_app_list_finalize (GObject *object)
 	GsAppList *list = GS_APP_LIST (object);
 	g_ptr_array_unref (list->array);
 	g_hash_table_unref (list->hash_by_id);
+	if (list->last_used != NULL)
+		g_hash_table_unref (list->last_used);
 	g_mutex_clear (&list->mutex);
 	G_OBJECT_CLASS (gs_app_list_parent_class)->finalize (object);
 }
@@ -618,8 +976,8 @@ gs_app_list_init (GsAppList *list)
 	g_mutex_init (&list->mutex);
 	list->array = g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
 	list->hash_by_id = g_hash_table_new_full ((GHashFunc) as_utils_unique_id_hash,
-						  (GEqualFunc) as_utils_unique_id_equal,
-						  g_free,
+						  (GEqualFunc) gs_utils_unique_id_equal,
+						  (GDestroyNotify) gs_utils_intern_unref,
 						  (GDestroyNotify) g_object_unref);
 }
 
@@ -26,6 +26,8 @@
 
 G_BEGIN_DECLS
 
+#define GS_APP_SNAPSHOT_TYPE	"(suussttsiasssas)"
+
 void		 gs_app_set_priority		(GsApp		*app,
 						 guint		 priority);
 guint		 gs_app_get_priority		(GsApp		*app);
@@ -33,6 +35,19 @@ void		 gs_app_set_unique_id		(GsApp		*app,
 						 const gchar	*unique_id);
 void		 gs_app_remove_addon		(GsApp		*app,
 						 GsApp		*addon);
+guint64		 gs_app_get_refined_flags	(GsApp		*app,
+						 guint		 serial);
+void		 gs_app_add_refined_flags	(GsApp		*app,
+						 guint64	 refined_flags,
+						 guint		 serial);
+void		 gs_app_clear_refined_flags	(GsApp		*app);
+guint		 gs_app_get_created_count	(void);
+gsize		 gs_app_get_memory_size		(GsApp		*app);
+void		 gs_app_shown_inc		(GsApp		*app);
+void		 gs_app_shown_dec		(GsApp		*app);
+gboolean	 gs_app_is_shown		(GsApp		*app);
+GVariant	*gs_app_to_snapshot		(GsApp		*app);
+GsApp		*gs_app_new_from_snapshot	(GVariant	*snapshot);
 
 G_END_DECLS
 
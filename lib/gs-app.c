@@ -52,17 +52,35 @@
 
 #include "gs-app-private.h"
 #include "gs-plugin.h"
+#include "gs-trace.h"
 #include "gs-utils.h"
 
+/* data that most package-only apps never have, allocated on first write;
+ * each member is also %NULL until something is added to it */
+typedef struct
+{
+	GPtrArray		*screenshots;	/* of AsScreenshot */
+	GPtrArray		*key_colors;	/* of GdkRGBA */
+	GHashTable		*urls;
+	GPtrArray		*reviews;	/* of AsReview */
+	GPtrArray		*provides;	/* of AsProvide */
+	GHashTable		*metadata;
+	GPtrArray		*addons;	/* of GsApp */
+	GHashTable		*addons_hash;	/* of "id" */
+	GPtrArray		*related;	/* of GsApp */
+	GHashTable		*related_hash;	/* of "id-source" */
+	GPtrArray		*history;	/* of GsApp */
+} GsAppExtra;
+
 typedef struct
 {
 	GObject			 parent_instance;
 
 	GMutex			 mutex;
-	gchar			*id;
-	gchar			*unique_id;
+	const gchar		*id;		/* interned */
+	const gchar		*unique_id;	/* interned */
 	gboolean		 unique_id_valid;
-	gchar			*branch;
+	const gchar		*branch;	/* interned */
 	gchar			*name;
 	GsAppQuality		 name_quality;
 	GPtrArray		*icons;
@@ -77,28 +95,23 @@ typedef struct
 	gchar			*summary_missing;
 	gchar			*description;
 	GsAppQuality		 description_quality;
-	GPtrArray		*screenshots;
 	GPtrArray		*categories;
-	GPtrArray		*key_colors;
 	GPtrArray		*keywords;
-	GHashTable		*urls;
 	gchar			*license;
 	GsAppQuality		 license_quality;
 	gchar			**menu_path;
-	gchar			*origin;
+	const gchar		*origin;	/* interned */
 	gchar			*origin_hostname;
 	gchar			*update_version;
 	gchar			*update_version_ui;
 	gchar			*update_details;
 	AsUrgencyKind		 update_urgency;
 	GsApp			*update_runtime;
-	gchar			*management_plugin;
+	const gchar		*management_plugin;	/* interned */
 	guint			 match_value;
 	guint			 priority;
 	gint			 rating;
 	GArray			*review_ratings;
-	GPtrArray		*reviews; /* of AsReview */
-	GPtrArray		*provides; /* of AsProvide */
 	guint64			 size_installed;
 	guint64			 size_download;
 	AsAppKind		 kind;
@@ -107,12 +120,6 @@ typedef struct
 	AsAppScope		 scope;
 	AsBundleKind		 bundle_kind;
 	guint			 progress;
-	GHashTable		*metadata;
-	GPtrArray		*addons; /* of GsApp */
-	GHashTable		*addons_hash; /* of "id" */
-	GPtrArray		*related; /* of GsApp */
-	GHashTable		*related_hash; /* of "id-source" */
-	GPtrArray		*history; /* of GsApp */
 	guint64			 install_date;
 	guint64			 kudos;
 	gboolean		 to_be_installed;
@@ -123,6 +130,11 @@ typedef struct
 	AsContentRating		*content_rating;
 	GdkPixbuf		*pixbuf;
 	GsPrice			*price;
+	guint64			 refined_flags;	/* GsPluginRefineFlags */
+	guint			 refined_serial;
+	guint			 notify_pending;	/* bitmask of PROP_* */
+	gint			 shown_count;	/* widgets showing the app */
+	GsAppExtra		*extra;		/* or %NULL */
 } GsAppPrivate;
 
 enum {
@@ -141,8 +153,53 @@ enum {
 	PROP_LAST
 };
 
+static GParamSpec *obj_props[PROP_LAST] = { NULL, };
+
+/* the scalar fields used when sorting and filtering are always written
+ * atomically, so the getters never need to take the mutex */
+G_STATIC_ASSERT (sizeof (AsAppState) == sizeof (gint));
+G_STATIC_ASSERT (sizeof (AsAppKind) == sizeof (gint));
+G_STATIC_ASSERT (sizeof (AsAppQuirk) == sizeof (gint));
+
+#ifdef __ATOMIC_RELAXED
+#define gs_app_atomic_get64(ptr)	__atomic_load_n ((ptr), __ATOMIC_RELAXED)
+#define gs_app_atomic_set64(ptr, val)	__atomic_store_n ((ptr), (val), __ATOMIC_RELAXED)
+#define gs_app_atomic_or64(ptr, val)	__atomic_fetch_or ((ptr), (val), __ATOMIC_RELAXED)
+#else
+static GMutex gs_app_atomic64_mutex;
+
+static guint64
+gs_app_atomic_get64 (guint64 *ptr)
+{
+	guint64 val;
+	g_mutex_lock (&gs_app_atomic64_mutex);
+	val = *ptr;
+	g_mutex_unlock (&gs_app_atomic64_mutex);
+	return val;
+}
+
+static void
+gs_app_atomic_set64 (guint64 *ptr, guint64 val)
+{
+	g_mutex_lock (&gs_app_atomic64_mutex);
+	*ptr = val;
+	g_mutex_unlock (&gs_app_atomic64_mutex);
+}
+
+static void
+gs_app_atomic_or64 (guint64 *ptr, guint64 val)
+{
+	g_mutex_lock (&gs_app_atomic64_mutex);
+	*ptr |= val;
+	g_mutex_unlock (&gs_app_atomic64_mutex);
+}
+#endif
+
 G_DEFINE_TYPE_WITH_PRIVATE (GsApp, gs_app, G_TYPE_OBJECT)
 
+/* the number of GsApp objects created by each thread */
+static GPrivate gs_app_created_count;
+
 static gboolean
 _g_set_str (gchar **str_ptr, const gchar *new_str)
 {
@@ -153,6 +210,18 @@ _g_set_str (gchar **str_ptr, const gchar *new_str)
 	return TRUE;
 }
 
+/* for the identifiers repeated across many apps; see gs_utils_intern_ref() */
+static gboolean
+_g_set_interned_str (const gchar **str_ptr, const gchar *new_str)
+{
+	const gchar *old_str = *str_ptr;
+	if (old_str == new_str || g_strcmp0 (old_str, new_str) == 0)
+		return FALSE;
+	*str_ptr = gs_utils_intern_ref (new_str);
+	gs_utils_intern_unref (old_str);
+	return TRUE;
+}
+
 static gboolean
 _g_set_strv (gchar ***strv_ptr, gchar **new_strv)
 {
@@ -174,6 +243,76 @@ _g_set_ptr_array (GPtrArray **array_ptr, GPtrArray *new_array)
 	return TRUE;
 }
 
+/* returned in place of any unset list, and never modified */
+static GPtrArray *
+gs_app_empty_array (void)
+{
+	static GPtrArray *empty = NULL;
+	if (g_once_init_enter (&empty))
+		g_once_init_leave (&empty, g_ptr_array_new ());
+	return empty;
+}
+
+#define gs_app_extra_get(priv, member)	(g_atomic_pointer_get (&(priv)->extra) != NULL ? (priv)->extra->member : NULL)
+
+static GPtrArray *
+gs_app_extra_get_array (GPtrArray *array)
+{
+	return array != NULL ? array : gs_app_empty_array ();
+}
+
+/* the block is only ever set once and lives until finalize, but not every
+ * caller holds the mutex, so whoever loses the race frees their copy */
+static GsAppExtra *
+gs_app_extra_ensure (GsApp *app)
+{
+	GsAppPrivate *priv = gs_app_get_instance_private (app);
+	GsAppExtra *extra = g_atomic_pointer_get (&priv->extra);
+	if (extra != NULL)
+		return extra;
+	extra = g_slice_new0 (GsAppExtra);
+	if (!g_atomic_pointer_compare_and_exchange (&priv->extra, NULL, extra)) {
+		g_slice_free (GsAppExtra, extra);
+		extra = g_atomic_pointer_get (&priv->extra);
+	}
+	return extra;
+}
+
+static GPtrArray *
+gs_app_extra_ensure_array (GPtrArray **array_ptr, GDestroyNotify free_func)
+{
+	if (*array_ptr == NULL)
+		*array_ptr = g_ptr_array_new_with_free_func (free_func);
+	return *array_ptr;
+}
+
+static GHashTable *
+gs_app_extra_ensure_hash (GHashTable **hash_ptr, GDestroyNotify value_free_func)
+{
+	if (*hash_ptr == NULL) {
+		*hash_ptr = g_hash_table_new_full (g_str_hash, g_str_equal,
+						   g_free, value_free_func);
+	}
+	return *hash_ptr;
+}
+
+static void
+gs_app_extra_free (GsAppExtra *extra)
+{
+	g_clear_pointer (&extra->screenshots, g_ptr_array_unref);
+	g_clear_pointer (&extra->key_colors, g_ptr_array_unref);
+	g_clear_pointer (&extra->urls, g_hash_table_unref);
+	g_clear_pointer (&extra->reviews, g_ptr_array_unref);
+	g_clear_pointer (&extra->provides, g_ptr_array_unref);
+	g_clear_pointer (&extra->metadata, g_hash_table_unref);
+	g_clear_pointer (&extra->addons, g_ptr_array_unref);
+	g_clear_pointer (&extra->addons_hash, g_hash_table_unref);
+	g_clear_pointer (&extra->related, g_ptr_array_unref);
+	g_clear_pointer (&extra->related_hash, g_hash_table_unref);
+	g_clear_pointer (&extra->history, g_ptr_array_unref);
+	g_slice_free (GsAppExtra, extra);
+}
+
 static gboolean
 _g_set_array (GArray **array_ptr, GArray *new_array)
 {
@@ -255,14 +394,15 @@ gs_app_get_unique_id_unlocked (GsApp *app)
 
 	/* hmm, do what we can */
 	if (priv->unique_id == NULL || !priv->unique_id_valid) {
+		g_autofree gchar *unique_id = NULL;
 		g_debug ("autogenerating unique-id for %s", priv->id);
-		g_free (priv->unique_id);
-		priv->unique_id = as_utils_unique_id_build (priv->scope,
-							    priv->bundle_kind,
-							    priv->origin,
-							    priv->kind,
-							    priv->id,
-							    priv->branch);
+		unique_id = as_utils_unique_id_build (priv->scope,
+						      priv->bundle_kind,
+						      priv->origin,
+						      priv->kind,
+						      priv->id,
+						      priv->branch);
+		_g_set_interned_str (&priv->unique_id, unique_id);
 		priv->unique_id_valid = TRUE;
 	}
 	return priv->unique_id;
@@ -387,6 +527,9 @@ gs_app_to_string_append (GsApp *app, GString *str)
 	AsScreenshot *ss;
 	GList *keys;
 	GList *l;
+	GPtrArray *key_colors;
+	GPtrArray *related;
+	GPtrArray *screenshots;
 	const gchar *tmp;
 	guint i;
 
@@ -463,9 +606,10 @@ gs_app_to_string_append (GsApp *app, GString *str)
 		gs_app_kv_lpad (str, "summary", priv->summary);
 	if (priv->description != NULL)
 		gs_app_kv_lpad (str, "description", priv->description);
-	for (i = 0; i < priv->screenshots->len; i++) {
+	screenshots = gs_app_extra_get_array (gs_app_extra_get (priv, screenshots));
+	for (i = 0; i < screenshots->len; i++) {
 		g_autofree gchar *key = NULL;
-		ss = g_ptr_array_index (priv->screenshots, i);
+		ss = g_ptr_array_index (screenshots, i);
 		tmp = as_screenshot_get_caption (ss, NULL);
 		im = as_screenshot_get_image (ss, 0, 0);
 		if (im == NULL)
@@ -500,7 +644,7 @@ gs_app_to_string_append (GsApp *app, GString *str)
 		gs_app_kv_lpad (str, "content-rating",
 				as_content_rating_get_kind (priv->content_rating));
 	}
-	tmp = g_hash_table_lookup (priv->urls, as_url_kind_to_string (AS_URL_KIND_HOMEPAGE));
+	tmp = gs_app_get_url (app, AS_URL_KIND_HOMEPAGE);
 	if (tmp != NULL)
 		gs_app_kv_lpad (str, "url{homepage}", tmp);
 	if (priv->license != NULL) {
@@ -533,10 +677,10 @@ gs_app_to_string_append (GsApp *app, GString *str)
 					  i, rat);
 		}
 	}
-	if (priv->reviews != NULL)
-		gs_app_kv_printf (str, "reviews", "%u", priv->reviews->len);
-	if (priv->provides != NULL)
-		gs_app_kv_printf (str, "provides", "%u", priv->provides->len);
+	if (gs_app_extra_get (priv, reviews) != NULL)
+		gs_app_kv_printf (str, "reviews", "%u", priv->extra->reviews->len);
+	if (gs_app_extra_get (priv, provides) != NULL)
+		gs_app_kv_printf (str, "provides", "%u", priv->extra->provides->len);
 	if (priv->install_date != 0) {
 		gs_app_kv_printf (str, "install-date", "%"
 				  G_GUINT64_FORMAT "",
@@ -550,18 +694,21 @@ gs_app_to_string_append (GsApp *app, GString *str)
 		gs_app_kv_printf (str, "price", "%s %.2f",
 				  gs_price_get_currency (priv->price),
 				  gs_price_get_amount (priv->price));
-	for (i = 0; i < priv->related->len; i++) {
-		GsApp *app_tmp = g_ptr_array_index (priv->related, i);
+	related = gs_app_extra_get_array (gs_app_extra_get (priv, related));
+	for (i = 0; i < related->len; i++) {
+		GsApp *app_tmp = g_ptr_array_index (related, i);
 		gs_app_kv_lpad (str, "related", gs_app_get_unique_id (app_tmp));
 	}
-	if (priv->history->len > 0)
-		gs_app_kv_printf (str, "history", "%u", priv->history->len);
+	if (gs_app_extra_get (priv, history) != NULL &&
+	    priv->extra->history->len > 0)
+		gs_app_kv_printf (str, "history", "%u", priv->extra->history->len);
 	for (i = 0; i < priv->categories->len; i++) {
 		tmp = g_ptr_array_index (priv->categories, i);
 		gs_app_kv_lpad (str, "category", tmp);
 	}
-	for (i = 0; i < priv->key_colors->len; i++) {
-		GdkRGBA *color = g_ptr_array_index (priv->key_colors, i);
+	key_colors = gs_app_extra_get_array (gs_app_extra_get (priv, key_colors));
+	for (i = 0; i < key_colors->len; i++) {
+		GdkRGBA *color = g_ptr_array_index (key_colors, i);
 		g_autofree gchar *key = NULL;
 		key = g_strdup_printf ("key-color-%02u", i);
 		gs_app_kv_printf (str, key, "%.0f,%.0f,%.0f",
@@ -575,14 +722,16 @@ gs_app_to_string_append (GsApp *app, GString *str)
 			gs_app_kv_lpad (str, "keyword", tmp);
 		}
 	}
-	keys = g_hash_table_get_keys (priv->metadata);
-	for (l = keys; l != NULL; l = l->next) {
-		g_autofree gchar *key = NULL;
-		key = g_strdup_printf ("{%s}", (const gchar *) l->data);
-		tmp = g_hash_table_lookup (priv->metadata, l->data);
-		gs_app_kv_lpad (str, key, tmp);
+	if (gs_app_extra_get (priv, metadata) != NULL) {
+		keys = g_hash_table_get_keys (priv->extra->metadata);
+		for (l = keys; l != NULL; l = l->next) {
+			g_autofree gchar *key = NULL;
+			key = g_strdup_printf ("{%s}", (const gchar *) l->data);
+			tmp = g_hash_table_lookup (priv->extra->metadata, l->data);
+			gs_app_kv_lpad (str, key, tmp);
+		}
+		g_list_free (keys);
 	}
-	g_list_free (keys);
 
 	/* add subclassed info */
 	if (klass->to_string != NULL)
@@ -600,36 +749,67 @@ gs_app_to_string_append (GsApp *app, GString *str)
 	g_string_append_printf (str, "\n");
 }
 
-typedef struct {
-	GsApp *app;
-	gchar *property_name;
-} AppNotifyData;
+/* apps with changed properties, notified together from one idle source */
+static GMutex gs_app_notify_mutex;
+static GPtrArray *gs_app_notify_dirty = NULL;
+static guint gs_app_notify_id = 0;
 
 static gboolean
-notify_idle_cb (gpointer data)
-{
-	AppNotifyData *notify_data = data;
-
-	g_object_notify (G_OBJECT (notify_data->app),
-			 notify_data->property_name);
-
-	g_object_unref (notify_data->app);
-	g_free (notify_data->property_name);
-	g_free (notify_data);
-
+gs_app_notify_flush_cb (gpointer user_data)
+{
+	gint64 ts_trace = gs_trace_begin ();
+	g_autoptr(GPtrArray) dirty = NULL;
+
+	g_mutex_lock (&gs_app_notify_mutex);
+	dirty = gs_app_notify_dirty;
+	gs_app_notify_dirty = NULL;
+	gs_app_notify_id = 0;
+	g_mutex_unlock (&gs_app_notify_mutex);
+
+	for (guint i = 0; dirty != NULL && i < dirty->len; i++) {
+		GsApp *app = g_ptr_array_index (dirty, i);
+		GsAppPrivate *priv = gs_app_get_instance_private (app);
+		guint pending = g_atomic_int_and (&priv->notify_pending, 0);
+
+		g_object_freeze_notify (G_OBJECT (app));
+		for (guint prop_id = 1; prop_id < PROP_LAST; prop_id++) {
+			if (pending & (1u << prop_id))
+				g_object_notify_by_pspec (G_OBJECT (app), obj_props[prop_id]);
+		}
+		g_object_thaw_notify (G_OBJECT (app));
+	}
+	if (ts_trace != 0) {
+		g_autofree gchar *tmp = NULL;
+		tmp = g_strdup_printf ("%u", dirty != NULL ? dirty->len : 0);
+		gs_trace_end (ts_trace, "idle", "gs_app_queue_notify",
+			      "apps", tmp,
+			      NULL);
+	}
 	return G_SOURCE_REMOVE;
 }
 
+/* properties can be set from any thread, but must be notified in the main
+ * thread; changes made before the next flush are merged into one signal
+ * for each property, which is flushed just before the next frame is drawn */
 static void
-gs_app_queue_notify (GsApp *app, const gchar *property_name)
+gs_app_queue_notify (GsApp *app, guint prop_id)
 {
-	AppNotifyData *notify_data;
+	GsAppPrivate *priv = gs_app_get_instance_private (app);
 
-	notify_data = g_new (AppNotifyData, 1);
-	notify_data->app = g_object_ref (app);
-	notify_data->property_name = g_strdup (property_name);
+	/* already queued */
+	if (g_atomic_int_or (&priv->notify_pending, 1u << prop_id) != 0)
+		return;
 
-	g_idle_add (notify_idle_cb, notify_data);
+	g_mutex_lock (&gs_app_notify_mutex);
+	if (gs_app_notify_dirty == NULL)
+		gs_app_notify_dirty = g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
+	g_ptr_array_add (gs_app_notify_dirty, g_object_ref (app));
+	if (gs_app_notify_id == 0) {
+		gs_app_notify_id = g_idle_add_full (GDK_PRIORITY_REDRAW - 1,
+						    gs_app_notify_flush_cb,
+						    NULL, NULL);
+	}
+	g_mutex_unlock (&gs_app_notify_mutex);
 }
 
 /**
@@ -663,7 +843,7 @@ gs_app_set_id (GsApp *app, const gchar *id)
 	GsAppPrivate *priv = gs_app_get_instance_private (app);
 	g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&priv->mutex);
 	g_return_if_fail (GS_IS_APP (app));
-	if (_g_set_str (&priv->id, id))
+	if (_g_set_interned_str (&priv->id, id))
 		priv->unique_id_valid = FALSE;
 }
 
@@ -770,7 +950,7 @@ gs_app_get_state (GsApp *app)
 {
 	GsAppPrivate *priv = gs_app_get_instance_private (app);
 	g_return_val_if_fail (GS_IS_APP (app), AS_APP_STATE_UNKNOWN);
-	return priv->state;
+	return g_atomic_int_get ((gint *) &priv->state);
 }
 
 /**
@@ -788,7 +968,7 @@ gs_app_get_progress (GsApp *app)
 {
 	GsAppPrivate *priv = gs_app_get_instance_private (app);
 	g_return_val_if_fail (GS_IS_APP (app), 0);
-	return priv->progress;
+	return (guint) g_atomic_int_get ((gint *) &priv->progress);
 }
 
 /**
@@ -818,8 +998,8 @@ gs_app_set_state_recover (GsApp *app)
 	 * confusing initial states when going through more than one attempt */
 	gs_app_set_progress (app, 0);
 
-	priv->state = priv->state_recover;
-	gs_app_queue_notify (app, "state");
+	g_atomic_int_set ((gint *) &priv->state, priv->state_recover);
+	gs_app_queue_notify (app, PROP_STATE);
 }
 
 /* mutex must be held */
@@ -940,7 +1120,10 @@ gs_app_set_state_internal (GsApp *app, AsAppState state)
 		return FALSE;
 	}
 
-	priv->state = state;
+	g_atomic_int_set ((gint *) &priv->state, state);
+
+	/* plugins may now return different data */
+	priv->refined_flags = 0;
 
 	if (state == AS_APP_STATE_UNKNOWN ||
 	    state == AS_APP_STATE_AVAILABLE_LOCAL ||
@@ -990,8 +1173,8 @@ gs_app_set_progress (GsApp *app, guint percentage)
 			 percentage, gs_app_get_unique_id_unlocked (app));
 		percentage = 100;
 	}
-	priv->progress = percentage;
-	gs_app_queue_notify (app, "progress");
+	g_atomic_int_set ((gint *) &priv->progress, percentage);
+	gs_app_queue_notify (app, PROP_PROGRESS);
 }
 
 /**
@@ -1026,7 +1209,7 @@ gs_app_set_state (GsApp *app, AsAppState state)
 	g_return_if_fail (GS_IS_APP (app));
 
 	if (gs_app_set_state_internal (app, state))
-		gs_app_queue_notify (app, "state");
+		gs_app_queue_notify (app, PROP_STATE);
 }
 
 /**
@@ -1044,7 +1227,7 @@ gs_app_get_kind (GsApp *app)
 {
 	GsAppPrivate *priv = gs_app_get_instance_private (app);
 	g_return_val_if_fail (GS_IS_APP (app), AS_APP_KIND_UNKNOWN);
-	return priv->kind;
+	return g_atomic_int_get ((gint *) &priv->kind);
 }
 
 /**
@@ -1114,8 +1297,8 @@ gs_app_set_kind (GsApp *app, AsAppKind kind)
 		return;
 	}
 
-	priv->kind = kind;
-	gs_app_queue_notify (app, "kind");
+	g_atomic_int_set ((gint *) &priv->kind, kind);
+	gs_app_queue_notify (app, PROP_KIND);
 
 	/* no longer valid */
 	priv->unique_id_valid = FALSE;
@@ -1161,8 +1344,7 @@ gs_app_set_unique_id (GsApp *app, const gchar *unique_id)
 	if (!as_utils_unique_id_valid (unique_id))
 		g_warning ("unique_id %s not valid", unique_id);
 
-	g_free (priv->unique_id);
-	priv->unique_id = g_strdup (unique_id);
+	_g_set_interned_str (&priv->unique_id, unique_id);
 	priv->unique_id_valid = TRUE;
 }
 
@@ -1242,7 +1424,7 @@ gs_app_set_branch (GsApp *app, const gchar *branch)
 	GsAppPrivate *priv = gs_app_get_instance_private (app);
 	g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&priv->mutex);
 	g_return_if_fail (GS_IS_APP (app));
-	if (_g_set_str (&priv->branch, branch))
+	if (_g_set_interned_str (&priv->branch, branch))
 		priv->unique_id_valid = FALSE;
 }
 
@@ -1868,7 +2050,7 @@ gs_app_ui_versions_populate (GsApp *app)
 		priv->version_ui = gs_app_get_ui_version (priv->version, flags[i]);
 		priv->update_version_ui = gs_app_get_ui_version (priv->update_version, flags[i]);
 		if (g_strcmp0 (priv->version_ui, priv->update_version_ui) != 0) {
-			gs_app_queue_notify (app, "version");
+			gs_app_queue_notify (app, PROP_VERSION);
 			return;
 		}
 		gs_app_ui_versions_invalidate (app);
@@ -1941,7 +2123,7 @@ gs_app_set_version (GsApp *app, const gchar *version)
 
 	if (_g_set_str (&priv->version, version)) {
 		gs_app_ui_versions_invalidate (app);
-		gs_app_queue_notify (app, "version");
+		gs_app_queue_notify (app, PROP_VERSION);
 	}
 }
 
@@ -2046,7 +2228,9 @@ gs_app_get_url (GsApp *app, AsUrlKind kind)
 {
 	GsAppPrivate *priv = gs_app_get_instance_private (app);
 	g_return_val_if_fail (GS_IS_APP (app), NULL);
-	return g_hash_table_lookup (priv->urls, as_url_kind_to_string (kind));
+	if (gs_app_extra_get (priv, urls) == NULL)
+		return NULL;
+	return g_hash_table_lookup (priv->extra->urls, as_url_kind_to_string (kind));
 }
 
 /**
@@ -2065,7 +2249,7 @@ gs_app_set_url (GsApp *app, AsUrlKind kind, const gchar *url)
 	GsAppPrivate *priv = gs_app_get_instance_private (app);
 	g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&priv->mutex);
 	g_return_if_fail (GS_IS_APP (app));
-	g_hash_table_insert (priv->urls,
+	g_hash_table_insert (gs_app_extra_ensure_hash (&gs_app_extra_ensure (app)->urls, g_free),
 			     g_strdup (as_url_kind_to_string (kind)),
 			     g_strdup (url));
 }
@@ -2289,8 +2473,7 @@ gs_app_set_origin (GsApp *app, const gchar *origin)
 		return;
 	}
 
-	g_free (priv->origin);
-	priv->origin = g_strdup (origin);
+	_g_set_interned_str (&priv->origin, origin);
 
 	/* no longer valid */
 	priv->unique_id_valid = FALSE;
@@ -2377,9 +2560,13 @@ void
 gs_app_add_screenshot (GsApp *app, AsScreenshot *screenshot)
 {
 	GsAppPrivate *priv = gs_app_get_instance_private (app);
+	g_autoptr(GMutexLocker) locker = NULL;
 	g_return_if_fail (GS_IS_APP (app));
 	g_return_if_fail (AS_IS_SCREENSHOT (screenshot));
-	g_ptr_array_add (priv->screenshots, g_object_ref (screenshot));
+	locker = g_mutex_locker_new (&priv->mutex);
+	g_ptr_array_add (gs_app_extra_ensure_array (&gs_app_extra_ensure (app)->screenshots,
+						    (GDestroyNotify) g_object_unref),
+			 g_object_ref (screenshot));
 }
 
 /**
@@ -2397,7 +2584,7 @@ gs_app_get_screenshots (GsApp *app)
 {
 	GsAppPrivate *priv = gs_app_get_instance_private (app);
 	g_return_val_if_fail (GS_IS_APP (app), NULL);
-	return priv->screenshots;
+	return gs_app_extra_get_array (gs_app_extra_get (priv, screenshots));
 }
 
 /**
@@ -2467,7 +2654,7 @@ gs_app_set_update_version (GsApp *app, const gchar *update_version)
 	g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&priv->mutex);
 	g_return_if_fail (GS_IS_APP (app));
 	gs_app_set_update_version_internal (app, update_version);
-	gs_app_queue_notify (app, "version");
+	gs_app_queue_notify (app, PROP_VERSION);
 }
 
 /**
@@ -2610,8 +2797,7 @@ gs_app_set_management_plugin (GsApp *app, const gchar *management_plugin)
 		return;
 	}
 
-	g_free (priv->management_plugin);
-	priv->management_plugin = g_strdup (management_plugin);
+	_g_set_interned_str (&priv->management_plugin, management_plugin);
 }
 
 /**
@@ -2629,7 +2815,7 @@ gs_app_get_rating (GsApp *app)
 {
 	GsAppPrivate *priv = gs_app_get_instance_private (app);
 	g_return_val_if_fail (GS_IS_APP (app), -1);
-	return priv->rating;
+	return g_atomic_int_get (&priv->rating);
 }
 
 /**
@@ -2649,8 +2835,8 @@ gs_app_set_rating (GsApp *app, gint rating)
 	g_return_if_fail (GS_IS_APP (app));
 	if (rating == priv->rating)
 		return;
-	priv->rating = rating;
-	gs_app_queue_notify (app, "rating");
+	g_atomic_int_set (&priv->rating, rating);
+	gs_app_queue_notify (app, PROP_RATING);
 }
 
 /**
@@ -2671,6 +2857,29 @@ gs_app_get_review_ratings (GsApp *app)
 	return priv->review_ratings;
 }
 
+/**
+ * gs_app_dup_review_ratings:
+ * @app: a #GsApp
+ *
+ * Gets the review ratings, which unlike gs_app_get_review_ratings() is safe
+ * to use while a plugin thread may be replacing them.
+ *
+ * Returns: (element-type gint) (transfer full): a list, or %NULL
+ *
+ * Since: 3.26
+ **/
+GArray *
+gs_app_dup_review_ratings (GsApp *app)
+{
+	GsAppPrivate *priv = gs_app_get_instance_private (app);
+	g_autoptr(GMutexLocker) locker = NULL;
+	g_return_val_if_fail (GS_IS_APP (app), NULL);
+	locker = g_mutex_locker_new (&priv->mutex);
+	if (priv->review_ratings == NULL)
+		return NULL;
+	return g_array_ref (priv->review_ratings);
+}
+
 /**
  * gs_app_set_review_ratings:
  * @app: a #GsApp
@@ -2687,6 +2896,7 @@ gs_app_set_review_ratings (GsApp *app, GArray *review_ratings)
 	g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&priv->mutex);
 	g_return_if_fail (GS_IS_APP (app));
 	_g_set_array (&priv->review_ratings, review_ratings);
+	gs_app_queue_notify (app, PROP_RATING);
 }
 
 /**
@@ -2704,7 +2914,34 @@ gs_app_get_reviews (GsApp *app)
 {
 	GsAppPrivate *priv = gs_app_get_instance_private (app);
 	g_return_val_if_fail (GS_IS_APP (app), NULL);
-	return priv->reviews;
+	return gs_app_extra_get_array (gs_app_extra_get (priv, reviews));
+}
+
+/**
+ * gs_app_dup_reviews:
+ * @app: a #GsApp
+ *
+ * Gets a copy of the user-submitted reviews for the application, which unlike
+ * gs_app_get_reviews() is safe to use while a plugin thread may be adding
+ * reviews.
+ *
+ * Returns: (element-type AsReview) (transfer container): the list of reviews
+ *
+ * Since: 3.26
+ **/
+GPtrArray *
+gs_app_dup_reviews (GsApp *app)
+{
+	GsAppPrivate *priv = gs_app_get_instance_private (app);
+	GPtrArray *reviews;
+	GPtrArray *copy = g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
+	g_autoptr(GMutexLocker) locker = NULL;
+	g_return_val_if_fail (GS_IS_APP (app), copy);
+	locker = g_mutex_locker_new (&priv->mutex);
+	reviews = gs_app_extra_get_array (gs_app_extra_get (priv, reviews));
+	for (guint i = 0; i < reviews->len; i++)
+		g_ptr_array_add (copy, g_object_ref (g_ptr_array_index (reviews, i)));
+	return copy;
 }
 
 /**
@@ -2720,9 +2957,14 @@ void
 gs_app_add_review (GsApp *app, AsReview *review)
 {
 	GsAppPrivate *priv = gs_app_get_instance_private (app);
+	g_autoptr(GMutexLocker) locker = NULL;
 	g_return_if_fail (GS_IS_APP (app));
 	g_return_if_fail (AS_IS_REVIEW (review));
-	g_ptr_array_add (priv->reviews, g_object_ref (review));
+	locker = g_mutex_locker_new (&priv->mutex);
+	g_ptr_array_add (gs_app_extra_ensure_array (&gs_app_extra_ensure (app)->reviews,
+						    (GDestroyNotify) g_object_unref),
+			 g_object_ref (review));
+	gs_app_queue_notify (app, PROP_RATING);
 }
 
 /**
@@ -2738,8 +2980,12 @@ void
 gs_app_remove_review (GsApp *app, AsReview *review)
 {
 	GsAppPrivate *priv = gs_app_get_instance_private (app);
+	g_autoptr(GMutexLocker) locker = NULL;
 	g_return_if_fail (GS_IS_APP (app));
-	g_ptr_array_remove (priv->reviews, review);
+	locker = g_mutex_locker_new (&priv->mutex);
+	if (gs_app_extra_get (priv, reviews) != NULL &&
+	    g_ptr_array_remove (priv->extra->reviews, review))
+		gs_app_queue_notify (app, PROP_RATING);
 }
 
 /**
@@ -2757,7 +3003,7 @@ gs_app_get_provides (GsApp *app)
 {
 	GsAppPrivate *priv = gs_app_get_instance_private (app);
 	g_return_val_if_fail (GS_IS_APP (app), NULL);
-	return priv->provides;
+	return gs_app_extra_get_array (gs_app_extra_get (priv, provides));
 }
 
 /**
@@ -2773,9 +3019,13 @@ void
 gs_app_add_provide (GsApp *app, AsProvide *provide)
 {
 	GsAppPrivate *priv = gs_app_get_instance_private (app);
+	g_autoptr(GMutexLocker) locker = NULL;
 	g_return_if_fail (GS_IS_APP (app));
 	g_return_if_fail (AS_IS_PROVIDE (provide));
-	g_ptr_array_add (priv->provides, g_object_ref (provide));
+	locker = g_mutex_locker_new (&priv->mutex);
+	g_ptr_array_add (gs_app_extra_ensure_array (&gs_app_extra_ensure (app)->provides,
+						    (GDestroyNotify) g_object_unref),
+			 g_object_ref (provide));
 }
 
 /**
@@ -2795,12 +3045,13 @@ guint64
 gs_app_get_size_download (GsApp *app)
 {
 	GsAppPrivate *priv = gs_app_get_instance_private (app);
+	GPtrArray *related;
 	guint64 sz;
 
 	g_return_val_if_fail (GS_IS_APP (app), G_MAXUINT64);
 
 	/* this app */
-	sz = priv->size_download;
+	sz = gs_app_atomic_get64 (&priv->size_download);
 
 	/* add the runtime if this is not installed */
 	if (priv->update_runtime != NULL) {
@@ -2812,8 +3063,9 @@ gs_app_get_size_download (GsApp *app)
 	}
 
 	/* add related apps */
-	for (guint i = 0; i < priv->related->len; i++) {
-		GsApp *app_related = g_ptr_array_index (priv->related, i);
+	related = gs_app_extra_get_array (gs_app_extra_get (priv, related));
+	for (guint i = 0; i < related->len; i++) {
+		GsApp *app_related = g_ptr_array_index (related, i);
 		sz += gs_app_get_size_download (app_related);
 	}
 
@@ -2835,9 +3087,7 @@ gs_app_set_size_download (GsApp *app, guint64 size_download)
 {
 	GsAppPrivate *priv = gs_app_get_instance_private (app);
 	g_return_if_fail (GS_IS_APP (app));
-	if (size_download == priv->size_download)
-		return;
-	priv->size_download = size_download;
+	gs_app_atomic_set64 (&priv->size_download, size_download);
 }
 
 /**
@@ -2855,16 +3105,18 @@ guint64
 gs_app_get_size_installed (GsApp *app)
 {
 	GsAppPrivate *priv = gs_app_get_instance_private (app);
+	GPtrArray *related;
 	guint64 sz;
 
 	g_return_val_if_fail (GS_IS_APP (app), G_MAXUINT64);
 
 	/* this app */
-	sz = priv->size_installed;
+	sz = gs_app_atomic_get64 (&priv->size_installed);
 
 	/* add related apps */
-	for (guint i = 0; i < priv->related->len; i++) {
-		GsApp *app_related = g_ptr_array_index (priv->related, i);
+	related = gs_app_extra_get_array (gs_app_extra_get (priv, related));
+	for (guint i = 0; i < related->len; i++) {
+		GsApp *app_related = g_ptr_array_index (related, i);
 		sz += gs_app_get_size_installed (app_related);
 	}
 
@@ -2885,9 +3137,7 @@ gs_app_set_size_installed (GsApp *app, guint64 size_installed)
 {
 	GsAppPrivate *priv = gs_app_get_instance_private (app);
 	g_return_if_fail (GS_IS_APP (app));
-	if (size_installed == priv->size_installed)
-		return;
-	priv->size_installed = size_installed;
+	gs_app_atomic_set64 (&priv->size_installed, size_installed);
 }
 
 /**
@@ -2909,7 +3159,9 @@ gs_app_get_metadata_item (GsApp *app, const gchar *key)
 	GsAppPrivate *priv = gs_app_get_instance_private (app);
 	g_return_val_if_fail (GS_IS_APP (app), NULL);
 	g_return_val_if_fail (key != NULL, NULL);
-	return g_hash_table_lookup (priv->metadata, key);
+	if (gs_app_extra_get (priv, metadata) == NULL)
+		return NULL;
+	return g_hash_table_lookup (priv->extra->metadata, key);
 }
 
 /**
@@ -2929,18 +3181,21 @@ gs_app_set_metadata (GsApp *app, const gchar *key, const gchar *value)
 {
 	GsAppPrivate *priv = gs_app_get_instance_private (app);
 	g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&priv->mutex);
+	GHashTable *metadata;
 	const gchar *found;
 
 	g_return_if_fail (GS_IS_APP (app));
 
 	/* if no value, then remove the key */
 	if (value == NULL) {
-		g_hash_table_remove (priv->metadata, key);
+		if (gs_app_extra_get (priv, metadata) != NULL)
+			g_hash_table_remove (priv->extra->metadata, key);
 		return;
 	}
 
 	/* check we're not overwriting */
-	found = g_hash_table_lookup (priv->metadata, key);
+	metadata = gs_app_extra_ensure_hash (&gs_app_extra_ensure (app)->metadata, g_free);
+	found = g_hash_table_lookup (metadata, key);
 	if (found != NULL) {
 		if (g_strcmp0 (found, value) == 0)
 			return;
@@ -2948,7 +3203,7 @@ gs_app_set_metadata (GsApp *app, const gchar *key, const gchar *value)
 			   priv->id, key, found, value);
 		return;
 	}
-	g_hash_table_insert (priv->metadata, g_strdup (key), g_strdup (value));
+	g_hash_table_insert (metadata, g_strdup (key), g_strdup (value));
 }
 
 /**
@@ -2966,7 +3221,7 @@ gs_app_get_addons (GsApp *app)
 {
 	GsAppPrivate *priv = gs_app_get_instance_private (app);
 	g_return_val_if_fail (GS_IS_APP (app), NULL);
-	return priv->addons;
+	return gs_app_extra_get_array (gs_app_extra_get (priv, addons));
 }
 
 /**
@@ -2982,6 +3237,7 @@ void
 gs_app_add_addon (GsApp *app, GsApp *addon)
 {
 	GsAppPrivate *priv = gs_app_get_instance_private (app);
+	GsAppExtra *extra;
 	gpointer found;
 	const gchar *id;
 	g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&priv->mutex);
@@ -2989,13 +3245,16 @@ gs_app_add_addon (GsApp *app, GsApp *addon)
 	g_return_if_fail (GS_IS_APP (app));
 	g_return_if_fail (GS_IS_APP (addon));
 
+	extra = gs_app_extra_ensure (app);
 	id = gs_app_get_id (addon);
-	found = g_hash_table_lookup (priv->addons_hash, id);
+	found = g_hash_table_lookup (gs_app_extra_ensure_hash (&extra->addons_hash, NULL), id);
 	if (found != NULL)
 		return;
-	g_hash_table_insert (priv->addons_hash, g_strdup (id), GINT_TO_POINTER (1));
+	g_hash_table_insert (extra->addons_hash, g_strdup (id), GINT_TO_POINTER (1));
 
-	g_ptr_array_add (priv->addons, g_object_ref (addon));
+	g_ptr_array_add (gs_app_extra_ensure_array (&extra->addons,
+						    (GDestroyNotify) g_object_unref),
+			 g_object_ref (addon));
 }
 
 /**
@@ -3014,8 +3273,10 @@ gs_app_remove_addon (GsApp *app, GsApp *addon)
 	g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&priv->mutex);
 	g_return_if_fail (GS_IS_APP (app));
 	g_return_if_fail (GS_IS_APP (addon));
-	g_hash_table_remove (priv->addons_hash, gs_app_get_id (addon));
-	g_ptr_array_remove (priv->addons, addon);
+	if (gs_app_extra_get (priv, addons) == NULL)
+		return;
+	g_hash_table_remove (priv->extra->addons_hash, gs_app_get_id (addon));
+	g_ptr_array_remove (priv->extra->addons, addon);
 }
 
 /**
@@ -3033,7 +3294,7 @@ gs_app_get_related (GsApp *app)
 {
 	GsAppPrivate *priv = gs_app_get_instance_private (app);
 	g_return_val_if_fail (GS_IS_APP (app), NULL);
-	return priv->related;
+	return gs_app_extra_get_array (gs_app_extra_get (priv, related));
 }
 
 /**
@@ -3050,6 +3311,7 @@ gs_app_add_related (GsApp *app, GsApp *app2)
 {
 	GsAppPrivate *priv = gs_app_get_instance_private (app);
 	GsAppPrivate *priv2 = gs_app_get_instance_private (app2);
+	GsAppExtra *extra;
 	gchar *key;
 	gpointer found;
 	g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&priv->mutex);
@@ -3059,21 +3321,24 @@ gs_app_add_related (GsApp *app, GsApp *app2)
 	/* if the app is updatable-live and any related app is not then
 	 * degrade to the offline state */
 	if (priv->state == AS_APP_STATE_UPDATABLE_LIVE &&
-	    priv2->state == AS_APP_STATE_UPDATABLE) {
-		priv->state = priv2->state;
+	    gs_app_get_state (app2) == AS_APP_STATE_UPDATABLE) {
+		g_atomic_int_set ((gint *) &priv->state, AS_APP_STATE_UPDATABLE);
 	}
 
 	key = g_strdup_printf ("%s-%s",
 			       gs_app_get_id (app2),
 			       gs_app_get_source_default (app2));
-	found = g_hash_table_lookup (priv->related_hash, key);
+	extra = gs_app_extra_ensure (app);
+	found = g_hash_table_lookup (gs_app_extra_ensure_hash (&extra->related_hash, NULL), key);
 	if (found != NULL) {
 		g_debug ("Already added %s as a related item", key);
 		g_free (key);
 		return;
 	}
-	g_hash_table_insert (priv->related_hash, key, GINT_TO_POINTER (1));
-	g_ptr_array_add (priv->related, g_object_ref (app2));
+	g_hash_table_insert (extra->related_hash, key, GINT_TO_POINTER (1));
+	g_ptr_array_add (gs_app_extra_ensure_array (&extra->related,
+						    (GDestroyNotify) g_object_unref),
+			 g_object_ref (app2));
 }
 
 /**
@@ -3091,7 +3356,7 @@ gs_app_get_history (GsApp *app)
 {
 	GsAppPrivate *priv = gs_app_get_instance_private (app);
 	g_return_val_if_fail (GS_IS_APP (app), NULL);
-	return priv->history;
+	return gs_app_extra_get_array (gs_app_extra_get (priv, history));
 }
 
 /**
@@ -3109,7 +3374,9 @@ gs_app_add_history (GsApp *app, GsApp *app2)
 	GsAppPrivate *priv = gs_app_get_instance_private (app);
 	g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&priv->mutex);
 	g_return_if_fail (GS_IS_APP (app));
-	g_ptr_array_add (priv->history, g_object_ref (app2));
+	g_ptr_array_add (gs_app_extra_ensure_array (&gs_app_extra_ensure (app)->history,
+						    (GDestroyNotify) g_object_unref),
+			 g_object_ref (app2));
 }
 
 /**
@@ -3324,7 +3591,7 @@ gs_app_get_key_colors (GsApp *app)
 {
 	GsAppPrivate *priv = gs_app_get_instance_private (app);
 	g_return_val_if_fail (GS_IS_APP (app), NULL);
-	return priv->key_colors;
+	return gs_app_extra_get_array (gs_app_extra_get (priv, key_colors));
 }
 
 /**
@@ -3343,7 +3610,7 @@ gs_app_set_key_colors (GsApp *app, GPtrArray *key_colors)
 	g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&priv->mutex);
 	g_return_if_fail (GS_IS_APP (app));
 	g_return_if_fail (key_colors != NULL);
-	_g_set_ptr_array (&priv->key_colors, key_colors);
+	_g_set_ptr_array (&gs_app_extra_ensure (app)->key_colors, key_colors);
 }
 
 /**
@@ -3359,9 +3626,13 @@ void
 gs_app_add_key_color (GsApp *app, GdkRGBA *key_color)
 {
 	GsAppPrivate *priv = gs_app_get_instance_private (app);
+	g_autoptr(GMutexLocker) locker = NULL;
 	g_return_if_fail (GS_IS_APP (app));
 	g_return_if_fail (key_color != NULL);
-	g_ptr_array_add (priv->key_colors, gdk_rgba_copy (key_color));
+	locker = g_mutex_locker_new (&priv->mutex);
+	g_ptr_array_add (gs_app_extra_ensure_array (&gs_app_extra_ensure (app)->key_colors,
+						    (GDestroyNotify) gdk_rgba_free),
+			 gdk_rgba_copy (key_color));
 }
 
 /**
@@ -3417,7 +3688,7 @@ gs_app_add_kudo (GsApp *app, GsAppKudo kudo)
 	g_return_if_fail (GS_IS_APP (app));
 	if (kudo & GS_APP_KUDO_SANDBOXED_SECURE)
 		kudo |= GS_APP_KUDO_SANDBOXED;
-	priv->kudos |= kudo;
+	gs_app_atomic_or64 (&priv->kudos, kudo);
 }
 
 /**
@@ -3436,7 +3707,7 @@ gs_app_has_kudo (GsApp *app, GsAppKudo kudo)
 {
 	GsAppPrivate *priv = gs_app_get_instance_private (app);
 	g_return_val_if_fail (GS_IS_APP (app), FALSE);
-	return (priv->kudos & kudo) > 0;
+	return (gs_app_atomic_get64 (&priv->kudos) & kudo) > 0;
 }
 
 /**
@@ -3454,7 +3725,7 @@ gs_app_get_kudos (GsApp *app)
 {
 	GsAppPrivate *priv = gs_app_get_instance_private (app);
 	g_return_val_if_fail (GS_IS_APP (app), 0);
-	return priv->kudos;
+	return gs_app_atomic_get64 (&priv->kudos);
 }
 
 /**
@@ -3472,42 +3743,45 @@ gs_app_get_kudos_percentage (GsApp *app)
 {
 	GsAppPrivate *priv = gs_app_get_instance_private (app);
 	guint percentage = 0;
+	guint64 kudos;
 
 	g_return_val_if_fail (GS_IS_APP (app), 0);
 
-	if ((priv->kudos & GS_APP_KUDO_MY_LANGUAGE) > 0)
+	kudos = gs_app_atomic_get64 (&priv->kudos);
+
+	if ((kudos & GS_APP_KUDO_MY_LANGUAGE) > 0)
 		percentage += 20;
-	if ((priv->kudos & GS_APP_KUDO_RECENT_RELEASE) > 0)
+	if ((kudos & GS_APP_KUDO_RECENT_RELEASE) > 0)
 		percentage += 20;
-	if ((priv->kudos & GS_APP_KUDO_FEATURED_RECOMMENDED) > 0)
+	if ((kudos & GS_APP_KUDO_FEATURED_RECOMMENDED) > 0)
 		percentage += 20;
-	if ((priv->kudos & GS_APP_KUDO_MODERN_TOOLKIT) > 0)
+	if ((kudos & GS_APP_KUDO_MODERN_TOOLKIT) > 0)
 		percentage += 20;
-	if ((priv->kudos & GS_APP_KUDO_SEARCH_PROVIDER) > 0)
+	if ((kudos & GS_APP_KUDO_SEARCH_PROVIDER) > 0)
 		percentage += 10;
-	if ((priv->kudos & GS_APP_KUDO_INSTALLS_USER_DOCS) > 0)
+	if ((kudos & GS_APP_KUDO_INSTALLS_USER_DOCS) > 0)
 		percentage += 10;
-	if ((priv->kudos & GS_APP_KUDO_USES_NOTIFICATIONS) > 0)
+	if ((kudos & GS_APP_KUDO_USES_NOTIFICATIONS) > 0)
 		percentage += 20;
-	if ((priv->kudos & GS_APP_KUDO_HAS_KEYWORDS) > 0)
+	if ((kudos & GS_APP_KUDO_HAS_KEYWORDS) > 0)
 		percentage += 5;
-	if ((priv->kudos & GS_APP_KUDO_USES_APP_MENU) > 0)
+	if ((kudos & GS_APP_KUDO_USES_APP_MENU) > 0)
 		percentage += 10;
-	if ((priv->kudos & GS_APP_KUDO_HAS_SCREENSHOTS) > 0)
+	if ((kudos & GS_APP_KUDO_HAS_SCREENSHOTS) > 0)
 		percentage += 20;
-	if ((priv->kudos & GS_APP_KUDO_PERFECT_SCREENSHOTS) > 0)
+	if ((kudos & GS_APP_KUDO_PERFECT_SCREENSHOTS) > 0)
 		percentage += 20;
-	if ((priv->kudos & GS_APP_KUDO_HIGH_CONTRAST) > 0)
+	if ((kudos & GS_APP_KUDO_HIGH_CONTRAST) > 0)
 		percentage += 20;
-	if ((priv->kudos & GS_APP_KUDO_HI_DPI_ICON) > 0)
+	if ((kudos & GS_APP_KUDO_HI_DPI_ICON) > 0)
 		percentage += 20;
-	if ((priv->kudos & GS_APP_KUDO_SANDBOXED) > 0)
+	if ((kudos & GS_APP_KUDO_SANDBOXED) > 0)
 		percentage += 20;
-	if ((priv->kudos & GS_APP_KUDO_SANDBOXED_SECURE) > 0)
+	if ((kudos & GS_APP_KUDO_SANDBOXED_SECURE) > 0)
 		percentage += 20;
 
 	/* popular apps should be at *least* 50% */
-	if ((priv->kudos & GS_APP_KUDO_POPULAR) > 0)
+	if ((kudos & GS_APP_KUDO_POPULAR) > 0)
 		percentage = MAX (percentage, 50);
 
 	return MIN (percentage, 100);
@@ -3573,7 +3847,7 @@ gs_app_has_quirk (GsApp *app, AsAppQuirk quirk)
 	GsAppPrivate *priv = gs_app_get_instance_private (app);
 	g_return_val_if_fail (GS_IS_APP (app), FALSE);
 
-	return (priv->quirk & quirk) > 0;
+	return (g_atomic_int_get ((gint *) &priv->quirk) & quirk) > 0;
 }
 
 /**
@@ -3592,8 +3866,8 @@ gs_app_add_quirk (GsApp *app, AsAppQuirk quirk)
 	g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&priv->mutex);
 	g_return_if_fail (GS_IS_APP (app));
 
-	priv->quirk |= quirk;
-	gs_app_queue_notify (app, "quirk");
+	g_atomic_int_or ((guint *) &priv->quirk, quirk);
+	gs_app_queue_notify (app, PROP_QUIRK);
 }
 
 /**
@@ -3612,8 +3886,8 @@ gs_app_remove_quirk (GsApp *app, AsAppQuirk quirk)
 	g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&priv->mutex);
 	g_return_if_fail (GS_IS_APP (app));
 
-	priv->quirk &= ~quirk;
-	gs_app_queue_notify (app, "quirk");
+	g_atomic_int_and ((guint *) &priv->quirk, ~quirk);
+	gs_app_queue_notify (app, PROP_QUIRK);
 }
 
 /**
@@ -3631,7 +3905,7 @@ gs_app_set_match_value (GsApp *app, guint match_value)
 {
 	GsAppPrivate *priv = gs_app_get_instance_private (app);
 	g_return_if_fail (GS_IS_APP (app));
-	priv->match_value = match_value;
+	g_atomic_int_set ((gint *) &priv->match_value, match_value);
 }
 
 /**
@@ -3654,7 +3928,7 @@ gs_app_get_match_value (GsApp *app)
 {
 	GsAppPrivate *priv = gs_app_get_instance_private (app);
 	g_return_val_if_fail (GS_IS_APP (app), 0);
-	return priv->match_value;
+	return (guint) g_atomic_int_get ((gint *) &priv->match_value);
 }
 
 /**
@@ -3671,7 +3945,7 @@ gs_app_set_priority (GsApp *app, guint priority)
 {
 	GsAppPrivate *priv = gs_app_get_instance_private (app);
 	g_return_if_fail (GS_IS_APP (app));
-	priv->priority = priority;
+	g_atomic_int_set ((gint *) &priv->priority, priority);
 }
 
 /**
@@ -3690,7 +3964,381 @@ gs_app_get_priority (GsApp *app)
 {
 	GsAppPrivate *priv = gs_app_get_instance_private (app);
 	g_return_val_if_fail (GS_IS_APP (app), 0);
-	return priv->priority;
+	return (guint) g_atomic_int_get ((gint *) &priv->priority);
+}
+
+/**
+ * gs_app_get_refined_flags:
+ * @app: a #GsApp
+ * @serial: the refine serial of the plugin loader
+ *
+ * Gets the refine flags that have already been satisfied for the
+ * application. Flags recorded with a different serial are ignored.
+ *
+ * Returns: a #GsPluginRefineFlags, or 0 if the app needs a full refine
+ *
+ * Since: 3.26
+ **/
+guint64
+gs_app_get_refined_flags (GsApp *app, guint serial)
+{
+	GsAppPrivate *priv = gs_app_get_instance_private (app);
+	g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&priv->mutex);
+	g_return_val_if_fail (GS_IS_APP (app), 0);
+	if (priv->refined_serial != serial)
+		return 0;
+	return priv->refined_flags;
+}
+
+/**
+ * gs_app_add_refined_flags:
+ * @app: a #GsApp
+ * @refined_flags: a #GsPluginRefineFlags
+ * @serial: the refine serial of the plugin loader
+ *
+ * Records that every plugin has been run for the refine flags, so that
+ * repeat refines for the same data can be skipped.
+ *
+ * Since: 3.26
+ **/
+void
+gs_app_add_refined_flags (GsApp *app, guint64 refined_flags, guint serial)
+{
+	GsAppPrivate *priv = gs_app_get_instance_private (app);
+	g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&priv->mutex);
+	g_return_if_fail (GS_IS_APP (app));
+	if (priv->refined_serial != serial) {
+		priv->refined_serial = serial;
+		priv->refined_flags = 0;
+	}
+	priv->refined_flags |= refined_flags;
+}
+
+/**
+ * gs_app_clear_refined_flags:
+ * @app: a #GsApp
+ *
+ * Forgets any satisfied refine flags, for instance when the data the
+ * plugins hold about the application is no longer valid.
+ *
+ * Since: 3.26
+ **/
+void
+gs_app_clear_refined_flags (GsApp *app)
+{
+	GsAppPrivate *priv = gs_app_get_instance_private (app);
+	g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&priv->mutex);
+	g_return_if_fail (GS_IS_APP (app));
+	priv->refined_flags = 0;
+}
+
+/**
+ * gs_app_get_created_count:
+ *
+ * Gets how many #GsApp objects have been created by the calling thread,
+ * so that the difference between two calls tells how many were created
+ * in between.
+ *
+ * Returns: a count, which may wrap around
+ *
+ * Since: 3.26
+ **/
+guint
+gs_app_get_created_count (void)
+{
+	return GPOINTER_TO_UINT (g_private_get (&gs_app_created_count));
+}
+
+/* the best local icon, which does not need a download */
+static const gchar *
+gs_app_get_snapshot_icon_filename (GsApp *app)
+{
+	GPtrArray *icons = gs_app_get_icons (app);
+	for (guint i = 0; i < icons->len; i++) {
+		AsIcon *icon = g_ptr_array_index (icons, i);
+		if (as_icon_get_kind (icon) != AS_ICON_KIND_CACHED &&
+		    as_icon_get_kind (icon) != AS_ICON_KIND_LOCAL)
+			continue;
+		if (as_icon_get_filename (icon) != NULL)
+			return as_icon_get_filename (icon);
+	}
+	return NULL;
+}
+
+/**
+ * gs_app_to_snapshot:
+ * @app: a #GsApp
+ *
+ * Saves enough details to show the application, and for the plugin that
+ * manages it to refine it again, in the %GS_APP_SNAPSHOT_TYPE format.
+ *
+ * Returns: (transfer floating): a #GVariant, or %NULL if @app has too few
+ * details to be shown
+ *
+ * Since: 3.26
+ **/
+GVariant *
+gs_app_to_snapshot (GsApp *app)
+{
+	GPtrArray *categories;
+	GPtrArray *sources;
+	GVariantBuilder builder_categories;
+	GVariantBuilder builder_sources;
+	const gchar *icon_filename;
+
+	g_return_val_if_fail (GS_IS_APP (app), NULL);
+
+	if (gs_app_get_unique_id (app) == NULL ||
+	    gs_app_get_name (app) == NULL ||
+	    gs_app_get_summary (app) == NULL ||
+	    gs_app_get_kind (app) == AS_APP_KIND_UNKNOWN ||
+	    gs_app_has_quirk (app, AS_APP_QUIRK_MATCH_ANY_PREFIX))
+		return NULL;
+	switch (gs_app_get_state (app)) {
+	case AS_APP_STATE_AVAILABLE:
+	case AS_APP_STATE_INSTALLED:
+	case AS_APP_STATE_UPDATABLE:
+	case AS_APP_STATE_UNAVAILABLE:
+		break;
+	default:
+		return NULL;
+	}
+
+	categories = gs_app_get_categories (app);
+	g_variant_builder_init (&builder_categories, G_VARIANT_TYPE ("as"));
+	for (guint i = 0; i < categories->len; i++) {
+		g_variant_builder_add (&builder_categories, "s",
+				       g_ptr_array_index (categories, i));
+	}
+	sources = gs_app_get_sources (app);
+	g_variant_builder_init (&builder_sources, G_VARIANT_TYPE ("as"));
+	for (guint i = 0; i < sources->len; i++) {
+		g_variant_builder_add (&builder_sources, "s",
+				       g_ptr_array_index (sources, i));
+	}
+	icon_filename = gs_app_get_snapshot_icon_filename (app);
+	return g_variant_new (GS_APP_SNAPSHOT_TYPE,
+			      gs_app_get_unique_id (app),
+			      (guint32) gs_app_get_kind (app),
+			      (guint32) gs_app_get_state (app),
+			      gs_app_get_name (app),
+			      gs_app_get_summary (app),
+			      gs_app_get_size_download (app),
+			      gs_app_get_size_installed (app),
+			      icon_filename != NULL ? icon_filename : "",
+			      (gint32) gs_app_get_rating (app),
+			      &builder_categories,
+			      gs_app_get_management_plugin (app) != NULL ?
+				gs_app_get_management_plugin (app) : "",
+			      gs_app_get_origin (app) != NULL ?
+				gs_app_get_origin (app) : "",
+			      &builder_sources);
+}
+
+/**
+ * gs_app_new_from_snapshot:
+ * @snapshot: a #GVariant of type %GS_APP_SNAPSHOT_TYPE
+ *
+ * Creates an application from the details saved by gs_app_to_snapshot().
+ *
+ * Returns: (transfer full): a #GsApp, or %NULL if the unique ID is invalid
+ *
+ * Since: 3.26
+ **/
+GsApp *
+gs_app_new_from_snapshot (GVariant *snapshot)
+{
+	const gchar *unique_id;
+	const gchar *name;
+	const gchar *summary;
+	const gchar *icon_filename;
+	const gchar *management_plugin;
+	const gchar *origin;
+	const gchar *tmp;
+	guint32 kind;
+	guint32 state;
+	guint64 size_download;
+	guint64 size_installed;
+	gint32 rating;
+	GVariantIter *iter_categories;
+	GVariantIter *iter_sources;
+	GsApp *app;
+
+	g_return_val_if_fail (g_variant_is_of_type (snapshot, G_VARIANT_TYPE (GS_APP_SNAPSHOT_TYPE)), NULL);
+
+	g_variant_get (snapshot, "(&suu&s&stt&sias&s&sas)",
+		       &unique_id, &kind, &state, &name, &summary,
+		       &size_download, &size_installed,
+		       &icon_filename, &rating, &iter_categories,
+		       &management_plugin, &origin, &iter_sources);
+	if (!as_utils_unique_id_valid (unique_id)) {
+		g_variant_iter_free (iter_categories);
+		g_variant_iter_free (iter_sources);
+		return NULL;
+	}
+
+	app = gs_app_new (NULL);
+	gs_app_set_from_unique_id (app, unique_id);
+	gs_app_set_kind (app, kind);
+	gs_app_set_state (app, state);
+	gs_app_set_name (app, GS_APP_QUALITY_LOWEST, name);
+	gs_app_set_summary (app, GS_APP_QUALITY_LOWEST, summary);
+	gs_app_set_size_download (app, size_download);
+	gs_app_set_size_installed (app, size_installed);
+	gs_app_set_rating (app, rating);
+	while (g_variant_iter_next (iter_categories, "&s", &tmp))
+		gs_app_add_category (app, tmp);
+	g_variant_iter_free (iter_categories);
+	while (g_variant_iter_next (iter_sources, "&s", &tmp))
+		gs_app_add_source (app, tmp);
+	g_variant_iter_free (iter_sources);
+	if (management_plugin[0] != '\0')
+		gs_app_set_management_plugin (app, management_plugin);
+	if (origin[0] != '\0')
+		gs_app_set_origin (app, origin);
+	if (icon_filename[0] != '\0') {
+		g_autoptr(AsIcon) icon = as_icon_new ();
+		as_icon_set_kind (icon, AS_ICON_KIND_LOCAL);
+		as_icon_set_filename (icon, icon_filename);
+		gs_app_add_icon (app, icon);
+	}
+	return app;
+}
+
+/**
+ * gs_app_shown_inc:
+ * @app: a #GsApp
+ *
+ * Records that a widget is showing the application, so that caches
+ * keep it until every widget has called gs_app_shown_dec().
+ *
+ * Since: 3.26
+ **/
+void
+gs_app_shown_inc (GsApp *app)
+{
+	GsAppPrivate *priv = gs_app_get_instance_private (app);
+	g_return_if_fail (GS_IS_APP (app));
+	g_atomic_int_inc (&priv->shown_count);
+}
+
+/**
+ * gs_app_shown_dec:
+ * @app: a #GsApp
+ *
+ * Records that a widget has stopped showing the application.
+ *
+ * Since: 3.26
+ **/
+void
+gs_app_shown_dec (GsApp *app)
+{
+	GsAppPrivate *priv = gs_app_get_instance_private (app);
+	g_return_if_fail (GS_IS_APP (app));
+	g_return_if_fail (g_atomic_int_get (&priv->shown_count) > 0);
+	g_atomic_int_add (&priv->shown_count, -1);
+}
+
+/**
+ * gs_app_is_shown:
+ * @app: a #GsApp
+ *
+ * Gets if any widget is showing the application.
+ *
+ * Returns: %TRUE if the application is on screen
+ *
+ * Since: 3.26
+ **/
+gboolean
+gs_app_is_shown (GsApp *app)
+{
+	GsAppPrivate *priv = gs_app_get_instance_private (app);
+	g_return_val_if_fail (GS_IS_APP (app), FALSE);
+	return g_atomic_int_get (&priv->shown_count) > 0;
+}
+
+static gsize
+gs_app_str_size (const gchar *str)
+{
+	return str != NULL ? strlen (str) + 1 : 0;
+}
+
+static gsize
+gs_app_str_array_size (GPtrArray *array)
+{
+	gsize size = 0;
+	for (guint i = 0; i < array->len; i++)
+		size += gs_app_str_size (g_ptr_array_index (array, i));
+	return size;
+}
+
+static gsize
+gs_app_str_hash_size (GHashTable *hash)
+{
+	GHashTableIter iter;
+	gpointer key, value;
+	gsize size = 0;
+	g_hash_table_iter_init (&iter, hash);
+	while (g_hash_table_iter_next (&iter, &key, &value))
+		size += gs_app_str_size (key) + gs_app_str_size (value);
+	return size;
+}
+
+/**
+ * gs_app_get_memory_size:
+ * @app: a #GsApp
+ *
+ * Gets roughly how much memory the application holds for its own strings
+ * and pixbuf, not including any shared objects such as icons, addons or the
+ * interned identifiers.
+ *
+ * Returns: a size in bytes
+ *
+ * Since: 3.26
+ **/
+gsize
+gs_app_get_memory_size (GsApp *app)
+{
+	GsAppPrivate *priv = gs_app_get_instance_private (app);
+	gsize size = sizeof(GsApp) + sizeof(GsAppPrivate);
+	g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&priv->mutex);
+
+	g_return_val_if_fail (GS_IS_APP (app), 0);
+
+	size += gs_app_str_size (priv->name);
+	size += gs_app_str_size (priv->project_group);
+	size += gs_app_str_size (priv->developer_name);
+	size += gs_app_str_size (priv->version);
+	size += gs_app_str_size (priv->version_ui);
+	size += gs_app_str_size (priv->summary);
+	size += gs_app_str_size (priv->summary_missing);
+	size += gs_app_str_size (priv->description);
+	size += gs_app_str_size (priv->license);
+	size += gs_app_str_size (priv->origin_hostname);
+	size += gs_app_str_size (priv->update_version);
+	size += gs_app_str_size (priv->update_version_ui);
+	size += gs_app_str_size (priv->update_details);
+	size += gs_app_str_array_size (priv->sources);
+	size += gs_app_str_array_size (priv->source_ids);
+	size += gs_app_str_array_size (priv->categories);
+	if (priv->keywords != NULL)
+		size += gs_app_str_array_size (priv->keywords);
+	if (priv->menu_path != NULL) {
+		for (guint i = 0; priv->menu_path[i] != NULL; i++)
+			size += gs_app_str_size (priv->menu_path[i]);
+	}
+	if (priv->extra != NULL) {
+		size += sizeof(GsAppExtra);
+		if (priv->extra->metadata != NULL)
+			size += gs_app_str_hash_size (priv->extra->metadata);
+		if (priv->extra->urls != NULL)
+			size += gs_app_str_hash_size (priv->extra->urls);
+	}
+	if (priv->pixbuf != NULL) {
+		size += (gsize) gdk_pixbuf_get_rowstride (priv->pixbuf) *
+			(gsize) gdk_pixbuf_get_height (priv->pixbuf);
+	}
+	return size;
 }
 
 static void
@@ -3777,13 +4425,13 @@ gs_app_set_property (GObject *object, guint prop_id, const GValue *value, GParam
 		gs_app_set_state_internal (app, g_value_get_uint (value));
 		break;
 	case PROP_PROGRESS:
-		priv->progress = g_value_get_uint (value);
+		g_atomic_int_set ((gint *) &priv->progress, g_value_get_uint (value));
 		break;
 	case PROP_INSTALL_DATE:
 		gs_app_set_install_date (app, g_value_get_uint64 (value));
 		break;
 	case PROP_QUIRK:
-		priv->quirk = g_value_get_uint64 (value);
+		g_atomic_int_set ((gint *) &priv->quirk, g_value_get_uint64 (value));
 		break;
 	default:
 		G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
@@ -3800,12 +4448,15 @@ gs_app_dispose (GObject *object)
 	g_clear_object (&priv->runtime);
 	g_clear_object (&priv->update_runtime);
 
-	g_clear_pointer (&priv->addons, g_ptr_array_unref);
-	g_clear_pointer (&priv->history, g_ptr_array_unref);
-	g_clear_pointer (&priv->related, g_ptr_array_unref);
-	g_clear_pointer (&priv->screenshots, g_ptr_array_unref);
-	g_clear_pointer (&priv->reviews, g_ptr_array_unref);
-	g_clear_pointer (&priv->provides, g_ptr_array_unref);
+	/* drop the other apps now to break any reference cycles */
+	if (priv->extra != NULL) {
+		g_clear_pointer (&priv->extra->addons, g_ptr_array_unref);
+		g_clear_pointer (&priv->extra->history, g_ptr_array_unref);
+		g_clear_pointer (&priv->extra->related, g_ptr_array_unref);
+		g_clear_pointer (&priv->extra->screenshots, g_ptr_array_unref);
+		g_clear_pointer (&priv->extra->reviews, g_ptr_array_unref);
+		g_clear_pointer (&priv->extra->provides, g_ptr_array_unref);
+	}
 	g_clear_pointer (&priv->icons, g_ptr_array_unref);
 
 	G_OBJECT_CLASS (gs_app_parent_class)->dispose (object);
@@ -3818,14 +4469,13 @@ gs_app_finalize (GObject *object)
 	GsAppPrivate *priv = gs_app_get_instance_private (app);
 
 	g_mutex_clear (&priv->mutex);
-	g_free (priv->id);
-	g_free (priv->unique_id);
-	g_free (priv->branch);
+	gs_utils_intern_unref (priv->id);
+	gs_utils_intern_unref (priv->unique_id);
+	gs_utils_intern_unref (priv->branch);
 	g_free (priv->name);
-	g_hash_table_unref (priv->urls);
 	g_free (priv->license);
 	g_strfreev (priv->menu_path);
-	g_free (priv->origin);
+	gs_utils_intern_unref (priv->origin);
 	g_free (priv->origin_hostname);
 	g_ptr_array_unref (priv->sources);
 	g_ptr_array_unref (priv->source_ids);
@@ -3839,12 +4489,8 @@ gs_app_finalize (GObject *object)
 	g_free (priv->update_version);
 	g_free (priv->update_version_ui);
 	g_free (priv->update_details);
-	g_free (priv->management_plugin);
-	g_hash_table_unref (priv->metadata);
-	g_hash_table_unref (priv->addons_hash);
-	g_hash_table_unref (priv->related_hash);
+	gs_utils_intern_unref (priv->management_plugin);
 	g_ptr_array_unref (priv->categories);
-	g_ptr_array_unref (priv->key_colors);
 	if (priv->keywords != NULL)
 		g_ptr_array_unref (priv->keywords);
 	if (priv->local_file != NULL)
@@ -3855,6 +4501,8 @@ gs_app_finalize (GObject *object)
 		g_object_unref (priv->pixbuf);
 	if (priv->price != NULL)
 		g_object_unref (priv->price);
+	if (priv->extra != NULL)
+		gs_app_extra_free (priv->extra);
 
 	G_OBJECT_CLASS (gs_app_parent_class)->finalize (object);
 }
@@ -3875,6 +4523,7 @@ gs_app_class_init (GsAppClass *klass)
 	pspec = g_param_spec_string ("id", NULL, NULL,
 				     NULL,
 				     G_PARAM_READWRITE | G_PARAM_CONSTRUCT);
+	obj_props[PROP_ID] = pspec;
 	g_object_class_install_property (object_class, PROP_ID, pspec);
 
 	/**
@@ -3883,6 +4532,7 @@ gs_app_class_init (GsAppClass *klass)
 	pspec = g_param_spec_string ("name", NULL, NULL,
 				     NULL,
 				     G_PARAM_READWRITE | G_PARAM_CONSTRUCT);
+	obj_props[PROP_NAME] = pspec;
 	g_object_class_install_property (object_class, PROP_NAME, pspec);
 
 	/**
@@ -3891,6 +4541,7 @@ gs_app_class_init (GsAppClass *klass)
 	pspec = g_param_spec_string ("version", NULL, NULL,
 				     NULL,
 				     G_PARAM_READWRITE | G_PARAM_CONSTRUCT);
+	obj_props[PROP_VERSION] = pspec;
 	g_object_class_install_property (object_class, PROP_VERSION, pspec);
 
 	/**
@@ -3899,6 +4550,7 @@ gs_app_class_init (GsAppClass *klass)
 	pspec = g_param_spec_string ("summary", NULL, NULL,
 				     NULL,
 				     G_PARAM_READWRITE | G_PARAM_CONSTRUCT);
+	obj_props[PROP_SUMMARY] = pspec;
 	g_object_class_install_property (object_class, PROP_SUMMARY, pspec);
 
 	/**
@@ -3907,6 +4559,7 @@ gs_app_class_init (GsAppClass *klass)
 	pspec = g_param_spec_string ("description", NULL, NULL,
 				     NULL,
 				     G_PARAM_READWRITE | G_PARAM_CONSTRUCT);
+	obj_props[PROP_DESCRIPTION] = pspec;
 	g_object_class_install_property (object_class, PROP_DESCRIPTION, pspec);
 
 	/**
@@ -3915,6 +4568,7 @@ gs_app_class_init (GsAppClass *klass)
 	pspec = g_param_spec_int ("rating", NULL, NULL,
 				  -1, 100, -1,
 				  G_PARAM_READWRITE | G_PARAM_CONSTRUCT);
+	obj_props[PROP_RATING] = pspec;
 	g_object_class_install_property (object_class, PROP_RATING, pspec);
 
 	/**
@@ -3925,6 +4579,7 @@ gs_app_class_init (GsAppClass *klass)
 				   AS_APP_KIND_LAST,
 				   AS_APP_KIND_UNKNOWN,
 				   G_PARAM_READWRITE | G_PARAM_CONSTRUCT);
+	obj_props[PROP_KIND] = pspec;
 	g_object_class_install_property (object_class, PROP_KIND, pspec);
 
 	/**
@@ -3935,6 +4590,7 @@ gs_app_class_init (GsAppClass *klass)
 				   AS_APP_STATE_LAST,
 				   AS_APP_STATE_UNKNOWN,
 				   G_PARAM_READWRITE | G_PARAM_CONSTRUCT);
+	obj_props[PROP_STATE] = pspec;
 	g_object_class_install_property (object_class, PROP_STATE, pspec);
 
 	/**
@@ -3942,6 +4598,7 @@ gs_app_class_init (GsAppClass *klass)
 	 */
 	pspec = g_param_spec_uint ("progress", NULL, NULL, 0, 100, 0,
 				   G_PARAM_READWRITE | G_PARAM_CONSTRUCT);
+	obj_props[PROP_PROGRESS] = pspec;
 	g_object_class_install_property (object_class, PROP_PROGRESS, pspec);
 
 	/**
@@ -3950,6 +4607,7 @@ gs_app_class_init (GsAppClass *klass)
 	pspec = g_param_spec_uint64 ("install-date", NULL, NULL,
 				     0, G_MAXUINT64, 0,
 				     G_PARAM_READWRITE | G_PARAM_CONSTRUCT);
+	obj_props[PROP_INSTALL_DATE] = pspec;
 	g_object_class_install_property (object_class, PROP_INSTALL_DATE, pspec);
 
 	/**
@@ -3958,6 +4616,7 @@ gs_app_class_init (GsAppClass *klass)
 	pspec = g_param_spec_uint64 ("quirk", NULL, NULL,
 				     0, G_MAXUINT64, 0,
 				     G_PARAM_READWRITE | G_PARAM_CONSTRUCT);
+	obj_props[PROP_QUIRK] = pspec;
 	g_object_class_install_property (object_class, PROP_QUIRK, pspec);
 }
 
@@ -3965,34 +4624,13 @@ static void
 gs_app_init (GsApp *app)
 {
 	GsAppPrivate *priv = gs_app_get_instance_private (app);
+	g_private_set (&gs_app_created_count,
+		       GUINT_TO_POINTER (gs_app_get_created_count () + 1));
 	priv->rating = -1;
 	priv->sources = g_ptr_array_new_with_free_func (g_free);
 	priv->source_ids = g_ptr_array_new_with_free_func (g_free);
 	priv->categories = g_ptr_array_new_with_free_func (g_free);
-	priv->key_colors = g_ptr_array_new_with_free_func ((GDestroyNotify) gdk_rgba_free);
-	priv->addons = g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
-	priv->related = g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
-	priv->history = g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
-	priv->screenshots = g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
-	priv->reviews = g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
-	priv->provides = g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
 	priv->icons = g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
-	priv->metadata = g_hash_table_new_full (g_str_hash,
-	                                        g_str_equal,
-	                                        g_free,
-	                                        g_free);
-	priv->addons_hash = g_hash_table_new_full (g_str_hash,
-	                                           g_str_equal,
-	                                           g_free,
-	                                           NULL);
-	priv->related_hash = g_hash_table_new_full (g_str_hash,
-	                                            g_str_equal,
-	                                            g_free,
-	                                            NULL);
-	priv->urls = g_hash_table_new_full (g_str_hash,
-	                                    g_str_equal,
-	                                    g_free,
-	                                    g_free);
 	g_mutex_init (&priv->mutex);
 }
 
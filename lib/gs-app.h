@@ -243,9 +243,11 @@ gint		 gs_app_get_rating		(GsApp		*app);
 void		 gs_app_set_rating		(GsApp		*app,
 						 gint		 rating);
 GArray		*gs_app_get_review_ratings	(GsApp		*app);
+GArray		*gs_app_dup_review_ratings	(GsApp		*app);
 void		 gs_app_set_review_ratings	(GsApp		*app,
 						 GArray		*review_ratings);
 GPtrArray	*gs_app_get_reviews		(GsApp		*app);
+GPtrArray	*gs_app_dup_reviews		(GsApp		*app);
 void		 gs_app_add_review		(GsApp		*app,
 						 AsReview	*review);
 void		 gs_app_remove_review		(GsApp		*app,
@@ -33,13 +33,14 @@
 #include <glib/gi18n.h>
 
 #include "gs-category-private.h"
+#include "gs-utils.h"
 
 struct _GsCategory
 {
 	GObject		 parent_instance;
 
-	gchar		*id;
-	gchar		*name;
+	const gchar	*id;		/* interned */
+	const gchar	*name;		/* interned */
 	gchar		*icon;
 	gint		 score;
 	GPtrArray	*key_colors;
@@ -217,9 +218,11 @@ gs_category_get_name (GsCategory *category)
 void
 gs_category_set_name (GsCategory *category, const gchar *name)
 {
+	const gchar *name_old;
 	g_return_if_fail (GS_IS_CATEGORY (category));
-	g_free (category->name);
-	category->name = g_strdup (name);
+	name_old = category->name;
+	category->name = gs_utils_intern_ref (name);
+	gs_utils_intern_unref (name_old);
 }
 
 /**
@@ -536,8 +539,8 @@ gs_category_finalize (GObject *object)
 	g_ptr_array_unref (category->children);
 	g_ptr_array_unref (category->key_colors);
 	g_ptr_array_unref (category->desktop_groups);
-	g_free (category->id);
-	g_free (category->name);
+	gs_utils_intern_unref (category->id);
+	gs_utils_intern_unref (category->name);
 	g_free (category->icon);
 
 	G_OBJECT_CLASS (gs_category_parent_class)->finalize (object);
@@ -574,7 +577,7 @@ gs_category_new (const gchar *id)
 {
 	GsCategory *category;
 	category = g_object_new (GS_TYPE_CATEGORY, NULL);
-	category->id = g_strdup (id);
+	category->id = gs_utils_intern_ref (id);
 	return GS_CATEGORY (category);
 }
 
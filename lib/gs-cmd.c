@@ -28,6 +28,7 @@
 #include "gnome-software-private.h"
 
 #include "gs-debug.h"
+#include "gs-trace.h"
 
 typedef struct {
 	GsPluginLoader	*plugin_loader;
@@ -71,6 +72,50 @@ gs_cmd_pad_spaces (const gchar *text, guint length)
 	return g_string_free (str, FALSE);
 }
 
+/* the stats are collected by the running service, not by us */
+static gboolean
+gs_cmd_show_stats (GError **error)
+{
+	const gchar *plugin_name;
+	const gchar *vfunc;
+	const gchar *action;
+	guint count;
+	guint errors;
+	guint64 p50, p95, p99, max;
+	g_autoptr(GDBusConnection) connection = NULL;
+	g_autoptr(GVariant) retval = NULL;
+	g_autoptr(GVariantIter) iter = NULL;
+
+	connection = g_bus_get_sync (G_BUS_TYPE_SESSION, NULL, error);
+	if (connection == NULL)
+		return FALSE;
+	retval = g_dbus_connection_call_sync (connection,
+					      "org.gnome.Software",
+					      "/org/gnome/Software",
+					      "org.gnome.Software.Stats",
+					      "GetPluginStats",
+					      NULL,
+					      G_VARIANT_TYPE ("(a(sssuutttt))"),
+					      G_DBUS_CALL_FLAGS_NO_AUTO_START,
+					      -1, NULL, error);
+	if (retval == NULL)
+		return FALSE;
+
+	g_print ("%-24s %-28s %-20s %8s %6s %9s %9s %9s %9s\n",
+		 "plugin", "vfunc", "action", "count", "errors",
+		 "p50/ms", "p95/ms", "p99/ms", "max/ms");
+	g_variant_get (retval, "(a(sssuutttt))", &iter);
+	while (g_variant_iter_next (iter, "(&s&s&suutttt)",
+				    &plugin_name, &vfunc, &action,
+				    &count, &errors, &p50, &p95, &p99, &max)) {
+		g_print ("%-24s %-28s %-20s %8u %6u %9.1f %9.1f %9.1f %9.1f\n",
+			 plugin_name, vfunc, action, count, errors,
+			 (gdouble) p50 / 1000.f, (gdouble) p95 / 1000.f,
+			 (gdouble) p99 / 1000.f, (gdouble) max / 1000.f);
+	}
+	return TRUE;
+}
+
 static void
 gs_cmd_show_results_categories (GPtrArray *list)
 {
@@ -327,6 +372,7 @@ main (int argc, char **argv)
 	g_autofree gchar *plugin_blacklist_str = NULL;
 	g_autofree gchar *plugin_whitelist_str = NULL;
 	g_autofree gchar *refine_flags_str = NULL;
+	g_autofree gchar *trace_filename = NULL;
 	g_autoptr(GsApp) app = NULL;
 	g_autoptr(GFile) file = NULL;
 	g_autoptr(GsCmdSelf) self = g_new0 (GsCmdSelf, 1);
@@ -352,6 +398,8 @@ main (int argc, char **argv)
 		  "Show verbose debugging information", NULL },
 		{ "profile", '\0', 0, G_OPTION_ARG_NONE, &profile_enable,
 		  "Show profiling information", NULL },
+		{ "trace", '\0', 0, G_OPTION_ARG_FILENAME, &trace_filename,
+		  "Write trace events to a file", "FILE" },
 		{ NULL}
 	};
 
@@ -373,8 +421,13 @@ main (int argc, char **argv)
 		g_print ("Failed to parse options: %s\n", error->message);
 		goto out;
 	}
-	if (verbose)
+	if (verbose) {
 		g_setenv ("GS_DEBUG", "1", TRUE);
+		gs_debug_set_verbose (TRUE);
+	}
+
+	if (trace_filename != NULL)
+		gs_trace_set_filename (trace_filename);
 
 	/* prefer local sources */
 	if (prefer_local)
@@ -387,6 +440,13 @@ main (int argc, char **argv)
 		goto out;
 	}
 
+	/* no need to load any plugins */
+	if (argc == 2 && g_strcmp0 (argv[1], "stats") == 0) {
+		if (!gs_cmd_show_stats (&error))
+			g_print ("Failed to get stats: %s\n", error->message);
+		goto out;
+	}
+
 	/* load plugins */
 	self->plugin_loader = gs_plugin_loader_new ();
 	profile = gs_plugin_loader_get_profile (self->plugin_loader);
@@ -704,7 +764,8 @@ main (int argc, char **argv)
 				     "'updates', 'popular', 'get-categories', "
 				     "'get-category-apps', 'filename-to-app', "
 				     "'action install', 'action remove', "
-				     "'sources', 'refresh', 'launch' or 'search'");
+				     "'sources', 'refresh', 'launch', 'stats' "
+				     "or 'search'");
 	}
 	if (!ret) {
 		g_print ("Failed: %s\n", error->message);
@@ -718,8 +779,11 @@ main (int argc, char **argv)
 			gs_cmd_show_results_categories (categories);
 	}
 out:
-	if (profile_enable)
+	if (profile_enable && profile != NULL) {
 		as_profile_dump (profile);
+		gs_plugin_loader_dump_memory (self->plugin_loader);
+	}
+	gs_trace_close ();
 	g_option_context_free (context);
 	return status;
 }
@@ -29,13 +29,213 @@
 struct _GsDebug
 {
 	GObject		 parent_instance;
-	GMutex		 mutex;
 	gboolean	 use_time;
 	gboolean	 use_color;
 };
 
 G_DEFINE_TYPE (GsDebug, gs_debug, G_TYPE_OBJECT)
 
+#define GS_DEBUG_RING_SIZE	256	/* messages per thread */
+
+enum {
+	GS_DEBUG_STATE_UNKNOWN	= 0,
+	GS_DEBUG_STATE_DISABLED	= 1 << 0,
+	GS_DEBUG_STATE_VERBOSE	= 1 << 1,
+	GS_DEBUG_STATE_RING	= 1 << 2,
+};
+
+typedef struct {
+	gint64		 timestamp;
+	gchar		*str;
+} GsDebugEntry;
+
+/* only the owning thread writes to a ring, and each slot is swapped
+ * atomically so a dump can run at the same time without any locking */
+typedef struct {
+	gpointer	 slots[GS_DEBUG_RING_SIZE];	/* of GsDebugEntry */
+	guint		 head;
+	gint		 in_use;
+} GsDebugRing;
+
+static gint gs_debug_state = GS_DEBUG_STATE_UNKNOWN;
+static gint gs_debug_installed = FALSE;	/* else GLib decides */
+static GMutex gs_debug_rings_mutex;
+static GPtrArray *gs_debug_rings = NULL;	/* of GsDebugRing, never freed */
+
+static void gs_debug_ring_release (gpointer data);
+static GPrivate gs_debug_ring_private = G_PRIVATE_INIT (gs_debug_ring_release);
+
+static gint
+gs_debug_get_state (void)
+{
+	gint state = g_atomic_int_get (&gs_debug_state);
+	if (G_UNLIKELY (state == GS_DEBUG_STATE_UNKNOWN)) {
+		state = GS_DEBUG_STATE_DISABLED;
+		if (g_getenv ("GS_DEBUG") != NULL)
+			state |= GS_DEBUG_STATE_VERBOSE;
+		if (g_getenv ("GS_DEBUG_RING") != NULL)
+			state |= GS_DEBUG_STATE_RING;
+		g_atomic_int_set (&gs_debug_state, state);
+	}
+	return state;
+}
+
+/**
+ * gs_debug_is_enabled:
+ *
+ * Gets if debug messages are printed or recorded, without taking any locks.
+ * Use gs_debug_lazy() rather than calling this directly.
+ *
+ * Returns: %TRUE if debugging messages are wanted
+ **/
+gboolean
+gs_debug_is_enabled (void)
+{
+	if (!g_atomic_int_get (&gs_debug_installed))
+		return TRUE;
+	return (gs_debug_get_state () & (GS_DEBUG_STATE_VERBOSE | GS_DEBUG_STATE_RING)) > 0;
+}
+
+/**
+ * gs_debug_set_verbose:
+ * @verbose: if debugging messages should be printed
+ *
+ * Sets if debug messages are printed to the console, overriding the
+ * `GS_DEBUG` environment variable.
+ **/
+void
+gs_debug_set_verbose (gboolean verbose)
+{
+	gint state = gs_debug_get_state ();
+	if (verbose)
+		state |= GS_DEBUG_STATE_VERBOSE;
+	else
+		state &= ~GS_DEBUG_STATE_VERBOSE;
+	g_atomic_int_set (&gs_debug_state, state);
+}
+
+static void
+gs_debug_entry_free (GsDebugEntry *entry)
+{
+	g_free (entry->str);
+	g_slice_free (GsDebugEntry, entry);
+}
+
+/* replaces the slot contents, returning the old entry */
+static GsDebugEntry *
+gs_debug_ring_swap (gpointer *slot, GsDebugEntry *entry)
+{
+	gpointer old;
+	do {
+		old = g_atomic_pointer_get (slot);
+	} while (!g_atomic_pointer_compare_and_exchange (slot, old, entry));
+	return old;
+}
+
+/* rings of threads that have exited are reused by new threads */
+static void
+gs_debug_ring_release (gpointer data)
+{
+	GsDebugRing *ring = (GsDebugRing *) data;
+	g_atomic_int_set (&ring->in_use, FALSE);
+}
+
+static GsDebugRing *
+gs_debug_ring_get (void)
+{
+	GsDebugRing *ring = g_private_get (&gs_debug_ring_private);
+	if (G_LIKELY (ring != NULL))
+		return ring;
+
+	/* only taken once for each thread */
+	g_mutex_lock (&gs_debug_rings_mutex);
+	if (gs_debug_rings == NULL)
+		gs_debug_rings = g_ptr_array_new ();
+	for (guint i = 0; i < gs_debug_rings->len; i++) {
+		GsDebugRing *tmp = g_ptr_array_index (gs_debug_rings, i);
+		if (g_atomic_int_compare_and_exchange (&tmp->in_use, FALSE, TRUE)) {
+			ring = tmp;
+			break;
+		}
+	}
+	if (ring == NULL) {
+		ring = g_new0 (GsDebugRing, 1);
+		ring->in_use = TRUE;
+		g_ptr_array_add (gs_debug_rings, ring);
+	}
+	g_mutex_unlock (&gs_debug_rings_mutex);
+	g_private_set (&gs_debug_ring_private, ring);
+	return ring;
+}
+
+static void
+gs_debug_ring_add (const gchar *log_domain, const gchar *log_message)
+{
+	GsDebugRing *ring = gs_debug_ring_get ();
+	GsDebugEntry *entry = g_slice_new (GsDebugEntry);
+	GsDebugEntry *old;
+
+	entry->timestamp = g_get_real_time ();
+	entry->str = g_strdup_printf ("%p %s %s",
+				      (gpointer) g_thread_self (),
+				      log_domain != NULL ? log_domain : "",
+				      log_message);
+	old = gs_debug_ring_swap (&ring->slots[ring->head++ % GS_DEBUG_RING_SIZE], entry);
+	if (old != NULL)
+		gs_debug_entry_free (old);
+}
+
+static gint
+gs_debug_entry_sort_cb (gconstpointer a, gconstpointer b)
+{
+	GsDebugEntry *entry1 = *((GsDebugEntry **) a);
+	GsDebugEntry *entry2 = *((GsDebugEntry **) b);
+	if (entry1->timestamp < entry2->timestamp)
+		return -1;
+	if (entry1->timestamp > entry2->timestamp)
+		return 1;
+	return 0;
+}
+
+/**
+ * gs_debug_dump:
+ *
+ * Prints and clears the messages recorded by every thread when the
+ * `GS_DEBUG_RING` environment variable is set, oldest first.
+ **/
+void
+gs_debug_dump (void)
+{
+	g_autoptr(GPtrArray) entries = NULL;
+
+	if ((gs_debug_get_state () & GS_DEBUG_STATE_RING) == 0)
+		return;
+
+	entries = g_ptr_array_new_with_free_func ((GDestroyNotify) gs_debug_entry_free);
+	g_mutex_lock (&gs_debug_rings_mutex);
+	for (guint i = 0; gs_debug_rings != NULL && i < gs_debug_rings->len; i++) {
+		GsDebugRing *ring = g_ptr_array_index (gs_debug_rings, i);
+		for (guint j = 0; j < GS_DEBUG_RING_SIZE; j++) {
+			GsDebugEntry *entry = gs_debug_ring_swap (&ring->slots[j], NULL);
+			if (entry != NULL)
+				g_ptr_array_add (entries, entry);
+		}
+	}
+	g_mutex_unlock (&gs_debug_rings_mutex);
+
+	g_ptr_array_sort (entries, gs_debug_entry_sort_cb);
+	for (guint i = 0; i < entries->len; i++) {
+		GsDebugEntry *entry = g_ptr_array_index (entries, i);
+		g_autoptr(GDateTime) dt = g_date_time_new_from_unix_utc (entry->timestamp / G_USEC_PER_SEC);
+		g_print ("%02i:%02i:%02i:%04i %s\n",
+			 g_date_time_get_hour (dt),
+			 g_date_time_get_minute (dt),
+			 g_date_time_get_second (dt),
+			 (gint) ((entry->timestamp % G_USEC_PER_SEC) / 1000),
+			 entry->str);
+	}
+}
+
 static GLogWriterOutput
 gs_log_writer_console (GLogLevelFlags log_level,
 		       const GLogField *fields,
@@ -45,12 +245,16 @@ gs_log_writer_console (GLogLevelFlags log_level,
 	GsDebug *debug = GS_DEBUG (user_data);
 	const gchar *log_domain = NULL;
 	const gchar *log_message = NULL;
+	gint state = gs_debug_get_state ();
+	gboolean is_warning = (log_level & (G_LOG_LEVEL_ERROR |
+					    G_LOG_LEVEL_CRITICAL |
+					    G_LOG_LEVEL_WARNING)) > 0;
 	g_autofree gchar *tmp = NULL;
-	g_autoptr(GMutexLocker) locker = NULL;
 	g_autoptr(GString) domain = NULL;
+	g_autoptr(GString) str = NULL;
 
 	/* enabled */
-	if (g_getenv ("GS_DEBUG") == NULL)
+	if ((state & (GS_DEBUG_STATE_VERBOSE | GS_DEBUG_STATE_RING)) == 0)
 		return G_LOG_WRITER_HANDLED;
 
 	/* get data from arguments */
@@ -65,9 +269,11 @@ gs_log_writer_console (GLogLevelFlags log_level,
 		}
 	}
 
-	/* make threadsafe */
-	locker = g_mutex_locker_new (&debug->mutex);
-	g_assert (locker != NULL);
+	/* record now, print later, unless it needs attention right now */
+	if (!is_warning && (state & GS_DEBUG_STATE_RING) > 0) {
+		gs_debug_ring_add (log_domain, log_message);
+		return G_LOG_WRITER_HANDLED;
+	}
 
 	/* time header */
 	if (debug->use_time) {
@@ -91,12 +297,15 @@ gs_log_writer_console (GLogLevelFlags log_level,
 	for (guint i = domain->len; i < 3; i++)
 		g_string_append (domain, " ");
 
+	/* build the whole line so threads do not interleave */
+	str = g_string_new (NULL);
+
 	/* to file */
 	if (!debug->use_color) {
 		if (tmp != NULL)
-			g_print ("%s ", tmp);
-		g_print ("%s ", domain->str);
-		g_print ("%s\n", log_message);
+			g_string_append_printf (str, "%s ", tmp);
+		g_string_append_printf (str, "%s ", domain->str);
+		g_string_append_printf (str, "%s\n", log_message);
 
 	/* to screen */
 	} else {
@@ -106,19 +315,20 @@ gs_log_writer_console (GLogLevelFlags log_level,
 		case G_LOG_LEVEL_WARNING:
 			/* critical in red */
 			if (tmp != NULL)
-				g_print ("%c[%dm%s ", 0x1B, 32, tmp);
-			g_print ("%s ", domain->str);
-			g_print ("%c[%dm%s\n%c[%dm", 0x1B, 31, log_message, 0x1B, 0);
+				g_string_append_printf (str, "%c[%dm%s ", 0x1B, 32, tmp);
+			g_string_append_printf (str, "%s ", domain->str);
+			g_string_append_printf (str, "%c[%dm%s\n%c[%dm", 0x1B, 31, log_message, 0x1B, 0);
 			break;
 		default:
 			/* debug in blue */
 			if (tmp != NULL)
-				g_print ("%c[%dm%s ", 0x1B, 32, tmp);
-			g_print ("%s ", domain->str);
-			g_print ("%c[%dm%s\n%c[%dm", 0x1B, 34, log_message, 0x1B, 0);
+				g_string_append_printf (str, "%c[%dm%s ", 0x1B, 32, tmp);
+			g_string_append_printf (str, "%s ", domain->str);
+			g_string_append_printf (str, "%c[%dm%s\n%c[%dm", 0x1B, 34, log_message, 0x1B, 0);
 			break;
 		}
 	}
+	g_print ("%s", str->str);
 
 	/* success */
 	return G_LOG_WRITER_HANDLED;
@@ -144,29 +354,17 @@ gs_debug_log_writer (GLogLevelFlags log_level,
 	return gs_log_writer_console (log_level, fields, n_fields, user_data);
 }
 
-static void
-gs_debug_finalize (GObject *object)
-{
-	GsDebug *debug = GS_DEBUG (object);
-
-	g_mutex_clear (&debug->mutex);
-
-	G_OBJECT_CLASS (gs_debug_parent_class)->finalize (object);
-}
-
 static void
 gs_debug_class_init (GsDebugClass *klass)
 {
-	GObjectClass *object_class = G_OBJECT_CLASS (klass);
-	object_class->finalize = gs_debug_finalize;
 }
 
 static void
 gs_debug_init (GsDebug *debug)
 {
-	g_mutex_init (&debug->mutex);
 	debug->use_time = g_getenv ("GS_DEBUG_NO_TIME") == NULL;
 	debug->use_color = (isatty (fileno (stdout)) == 1);
+	g_atomic_int_set (&gs_debug_installed, TRUE);
 	g_log_set_writer_func (gs_debug_log_writer,
 			       g_object_ref (debug),
 			       (GDestroyNotify) g_object_unref);
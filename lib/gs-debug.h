@@ -31,6 +31,16 @@ G_BEGIN_DECLS
 G_DECLARE_FINAL_TYPE (GsDebug, gs_debug, GS, DEBUG, GObject)
 
 GsDebug	 	*gs_debug_new		(void);
+gboolean	 gs_debug_is_enabled	(void);
+void		 gs_debug_set_verbose	(gboolean	 verbose);
+void		 gs_debug_dump		(void);
+
+/* like g_debug(), but the arguments are only evaluated when wanted */
+#define gs_debug_lazy(...)						\
+	G_STMT_START {							\
+		if (G_UNLIKELY (gs_debug_is_enabled ()))		\
+			g_debug (__VA_ARGS__);				\
+	} G_STMT_END
 
 G_END_DECLS
 
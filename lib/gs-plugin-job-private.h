@@ -40,9 +40,12 @@ void			 gs_plugin_job_remove_refine_flags	(GsPluginJob	*self,
 GsPluginFailureFlags	 gs_plugin_job_get_failure_flags	(GsPluginJob	*self);
 guint			 gs_plugin_job_get_max_results		(GsPluginJob	*self);
 guint			 gs_plugin_job_get_timeout		(GsPluginJob	*self);
+GsPluginJobPriority	 gs_plugin_job_get_priority		(GsPluginJob	*self);
 guint64			 gs_plugin_job_get_age			(GsPluginJob	*self);
 GsAppListSortFunc	 gs_plugin_job_get_sort_func		(GsPluginJob	*self);
 gpointer		 gs_plugin_job_get_sort_func_data	(GsPluginJob	*self);
+GsPluginJobPartialFunc	 gs_plugin_job_get_partial_func		(GsPluginJob	*self);
+gpointer		 gs_plugin_job_get_partial_func_data	(GsPluginJob	*self);
 const gchar		*gs_plugin_job_get_search		(GsPluginJob	*self);
 GsAuth			*gs_plugin_job_get_auth			(GsPluginJob	*self);
 GsApp			*gs_plugin_job_get_app			(GsPluginJob	*self);
@@ -53,6 +56,7 @@ GsCategory		*gs_plugin_job_get_category		(GsPluginJob	*self);
 AsReview		*gs_plugin_job_get_review		(GsPluginJob	*self);
 GsPrice			*gs_plugin_job_get_price		(GsPluginJob	*self);
 gchar			*gs_plugin_job_to_string		(GsPluginJob	*self);
+gchar			*gs_plugin_job_get_key			(GsPluginJob	*self);
 void			 gs_plugin_job_set_action		(GsPluginJob	*self,
 								 GsPluginAction	 action);
 
@@ -34,11 +34,14 @@ struct _GsPluginJob
 	GsPluginFailureFlags	 failure_flags;
 	guint			 max_results;
 	guint			 timeout;
+	GsPluginJobPriority	 priority;
 	guint64			 age;
 	GsPlugin		*plugin;
 	GsPluginAction		 action;
 	GsAppListSortFunc	 sort_func;
 	gpointer		 sort_func_data;
+	GsPluginJobPartialFunc	 partial_func;
+	gpointer		 partial_func_data;
 	gchar			*search;
 	GsAuth			*auth;
 	GsApp			*app;
@@ -67,6 +70,7 @@ enum {
 	PROP_MAX_RESULTS,
 	PROP_PRICE,
 	PROP_TIMEOUT,
+	PROP_PRIORITY,
 	PROP_LAST
 };
 
@@ -89,6 +93,10 @@ gs_plugin_job_to_string (GsPluginJob *self)
 	}
 	if (self->timeout > 0)
 		g_string_append_printf (str, " with timeout=%u", self->timeout);
+	if (self->priority == GS_PLUGIN_JOB_PRIORITY_BACKGROUND)
+		g_string_append (str, " with priority=background");
+	else if (self->priority == GS_PLUGIN_JOB_PRIORITY_INTERACTIVE)
+		g_string_append (str, " with priority=interactive");
 	if (self->age != 0) {
 		if (self->age == G_MAXUINT) {
 			g_string_append (str, " with cache age=any");
@@ -150,6 +158,78 @@ gs_plugin_job_to_string (GsPluginJob *self)
 	return g_string_free (str, FALSE);
 }
 
+/* returns a string that is the same for jobs that return the same results,
+ * or %NULL if the results of the job cannot be shared */
+gchar *
+gs_plugin_job_get_key (GsPluginJob *self)
+{
+	GString *str;
+
+	g_return_val_if_fail (GS_IS_PLUGIN_JOB (self), NULL);
+
+	/* only jobs that create a new list of results */
+	switch (self->action) {
+	case GS_PLUGIN_ACTION_GET_UPDATES:
+	case GS_PLUGIN_ACTION_GET_DISTRO_UPDATES:
+	case GS_PLUGIN_ACTION_GET_UNVOTED_REVIEWS:
+	case GS_PLUGIN_ACTION_GET_SOURCES:
+	case GS_PLUGIN_ACTION_GET_INSTALLED:
+	case GS_PLUGIN_ACTION_GET_POPULAR:
+	case GS_PLUGIN_ACTION_GET_FEATURED:
+	case GS_PLUGIN_ACTION_GET_CATEGORY_APPS:
+	case GS_PLUGIN_ACTION_GET_RECENT:
+	case GS_PLUGIN_ACTION_GET_UPDATES_HISTORICAL:
+	case GS_PLUGIN_ACTION_SEARCH:
+	case GS_PLUGIN_ACTION_SEARCH_FILES:
+	case GS_PLUGIN_ACTION_SEARCH_PROVIDES:
+		break;
+	default:
+		return NULL;
+	}
+	if (self->partial_func != NULL ||
+	    self->app != NULL ||
+	    self->file != NULL ||
+	    self->auth != NULL ||
+	    self->review != NULL ||
+	    self->price != NULL ||
+	    gs_app_list_length (self->list) > 0)
+		return NULL;
+
+	/* everything that changes the results, the errors, or when the job
+	 * gets scheduled; the sort function is compared by address */
+	str = g_string_new (gs_plugin_action_to_string (self->action));
+	g_string_append_printf (str, ":%" G_GUINT64_FORMAT, self->refine_flags);
+	g_string_append_printf (str, ":failure=%" G_GUINT64_FORMAT, self->failure_flags);
+	g_string_append_printf (str, ":priority=%u", self->priority);
+	if (self->timeout > 0)
+		g_string_append_printf (str, ":timeout=%u", self->timeout);
+	if (self->max_results > 0)
+		g_string_append_printf (str, ":max-results=%u", self->max_results);
+	if (self->plugin != NULL)
+		g_string_append_printf (str, ":plugin=%s", gs_plugin_get_name (self->plugin));
+	if (self->sort_func != NULL) {
+		g_string_append_printf (str, ":sort=%p/%p",
+					(gpointer) self->sort_func,
+					self->sort_func_data);
+	}
+	if (self->search != NULL)
+		g_string_append_printf (str, ":search=%s", self->search);
+	if (self->category != NULL) {
+		GsCategory *parent = gs_category_get_parent (self->category);
+		if (parent != NULL) {
+			g_string_append_printf (str, ":category=%s/%s",
+						gs_category_get_id (parent),
+						gs_category_get_id (self->category));
+		} else {
+			g_string_append_printf (str, ":category=%s",
+						gs_category_get_id (self->category));
+		}
+	}
+	if (self->age > 0)
+		g_string_append_printf (str, ":age=%" G_GUINT64_FORMAT, self->age);
+	return g_string_free (str, FALSE);
+}
+
 void
 gs_plugin_job_set_refine_flags (GsPluginJob *self, GsPluginRefineFlags refine_flags)
 {
@@ -241,6 +321,21 @@ gs_plugin_job_get_timeout (GsPluginJob *self)
 	return self->timeout;
 }
 
+void
+gs_plugin_job_set_priority (GsPluginJob *self, GsPluginJobPriority priority)
+{
+	g_return_if_fail (GS_IS_PLUGIN_JOB (self));
+	g_return_if_fail (priority < GS_PLUGIN_JOB_PRIORITY_LAST);
+	self->priority = priority;
+}
+
+GsPluginJobPriority
+gs_plugin_job_get_priority (GsPluginJob *self)
+{
+	g_return_val_if_fail (GS_IS_PLUGIN_JOB (self), GS_PLUGIN_JOB_PRIORITY_DEFAULT);
+	return self->priority;
+}
+
 void
 gs_plugin_job_set_age (GsPluginJob *self, guint64 age)
 {
@@ -297,6 +392,34 @@ gs_plugin_job_get_sort_func_data (GsPluginJob *self)
 	return self->sort_func_data;
 }
 
+void
+gs_plugin_job_set_partial_func (GsPluginJob *self, GsPluginJobPartialFunc partial_func)
+{
+	g_return_if_fail (GS_IS_PLUGIN_JOB (self));
+	self->partial_func = partial_func;
+}
+
+GsPluginJobPartialFunc
+gs_plugin_job_get_partial_func (GsPluginJob *self)
+{
+	g_return_val_if_fail (GS_IS_PLUGIN_JOB (self), NULL);
+	return self->partial_func;
+}
+
+void
+gs_plugin_job_set_partial_func_data (GsPluginJob *self, gpointer partial_func_data)
+{
+	g_return_if_fail (GS_IS_PLUGIN_JOB (self));
+	self->partial_func_data = partial_func_data;
+}
+
+gpointer
+gs_plugin_job_get_partial_func_data (GsPluginJob *self)
+{
+	g_return_val_if_fail (GS_IS_PLUGIN_JOB (self), NULL);
+	return self->partial_func_data;
+}
+
 void
 gs_plugin_job_set_search (GsPluginJob *self, const gchar *search)
 {
@@ -481,6 +604,9 @@ gs_plugin_job_get_property (GObject *obj, guint prop_id, GValue *value, GParamSp
 	case PROP_TIMEOUT:
 		g_value_set_uint (value, self->timeout);
 		break;
+	case PROP_PRIORITY:
+		g_value_set_uint (value, self->priority);
+		break;
 	default:
 		G_OBJECT_WARN_INVALID_PROPERTY_ID (obj, prop_id, pspec);
 		break;
@@ -535,6 +661,9 @@ gs_plugin_job_set_property (GObject *obj, guint prop_id, const GValue *value, GP
 	case PROP_TIMEOUT:
 		gs_plugin_job_set_timeout (self, g_value_get_uint (value));
 		break;
+	case PROP_PRIORITY:
+		gs_plugin_job_set_priority (self, g_value_get_uint (value));
+		break;
 	case PROP_PRICE:
 		gs_plugin_job_set_price (self, g_value_get_object (value));
 		break;
@@ -641,6 +770,12 @@ gs_plugin_job_class_init (GsPluginJobClass *klass)
 				   G_PARAM_READWRITE | G_PARAM_CONSTRUCT);
 	g_object_class_install_property (object_class, PROP_TIMEOUT, pspec);
 
+	pspec = g_param_spec_uint ("priority", NULL, NULL,
+				   0, GS_PLUGIN_JOB_PRIORITY_LAST - 1,
+				   GS_PLUGIN_JOB_PRIORITY_DEFAULT,
+				   G_PARAM_READWRITE | G_PARAM_CONSTRUCT);
+	g_object_class_install_property (object_class, PROP_PRIORITY, pspec);
+
 	pspec = g_param_spec_object ("price", NULL, NULL,
 				     GS_TYPE_PRICE,
 				     G_PARAM_READWRITE);
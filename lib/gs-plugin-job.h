@@ -36,6 +36,10 @@ G_BEGIN_DECLS
 
 G_DECLARE_FINAL_TYPE (GsPluginJob, gs_plugin_job, GS, PLUGIN_JOB, GObject)
 
+typedef void	 (*GsPluginJobPartialFunc)		(GsPluginJob	*plugin_job,
+							 GsAppList	*list,
+							 gpointer	 user_data);
+
 void		 gs_plugin_job_set_refine_flags		(GsPluginJob	*self,
 							 GsPluginRefineFlags refine_flags);
 void		 gs_plugin_job_set_refresh_flags	(GsPluginJob	*self,
@@ -46,12 +50,18 @@ void		 gs_plugin_job_set_max_results		(GsPluginJob	*self,
 							 guint		 max_results);
 void		 gs_plugin_job_set_timeout		(GsPluginJob	*self,
 							 guint		 timeout);
+void		 gs_plugin_job_set_priority		(GsPluginJob	*self,
+							 GsPluginJobPriority priority);
 void		 gs_plugin_job_set_age			(GsPluginJob	*self,
 							 guint64	 age);
 void		 gs_plugin_job_set_sort_func		(GsPluginJob	*self,
 							 GsAppListSortFunc sort_func);
 void		 gs_plugin_job_set_sort_func_data	(GsPluginJob	*self,
 							 gpointer	 sort_func_data);
+void		 gs_plugin_job_set_partial_func		(GsPluginJob	*self,
+							 GsPluginJobPartialFunc partial_func);
+void		 gs_plugin_job_set_partial_func_data	(GsPluginJob	*self,
+							 gpointer	 partial_func_data);
 void		 gs_plugin_job_set_search		(GsPluginJob	*self,
 							 const gchar	*search);
 void		 gs_plugin_job_set_auth			(GsPluginJob	*self,
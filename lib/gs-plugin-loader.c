@@ -28,23 +28,47 @@
 #include "gs-app-private.h"
 #include "gs-app-list-private.h"
 #include "gs-category-private.h"
+#include "gs-debug.h"
 #include "gs-plugin-loader.h"
 #include "gs-plugin.h"
 #include "gs-plugin-event.h"
 #include "gs-plugin-job-private.h"
 #include "gs-plugin-private.h"
+#include "gs-trace.h"
 #include "gs-utils.h"
 
 #define GS_PLUGIN_LOADER_UPDATES_CHANGED_DELAY	3	/* s */
 #define GS_PLUGIN_LOADER_RELOAD_DELAY		5	/* s */
+#define GS_PLUGIN_LOADER_JOBS_MAX		16
+#define GS_PLUGIN_LOADER_JOBS_BACKGROUND_MAX	2
+#define GS_PLUGIN_LOADER_REFINE_FLAGS_DONE	((GsPluginRefineFlags) 1 << 63)
+#define GS_PLUGIN_LOADER_GLOBAL_CACHE_MAX	2000	/* apps */
+#define GS_PLUGIN_LOADER_GLOBAL_CACHE_AGE	1800	/* s */
+#define GS_PLUGIN_LOADER_GLOBAL_CACHE_EXPIRE	300	/* s */
+#define GS_PLUGIN_LOADER_SNAPSHOT_VERSION	2
+#define GS_PLUGIN_LOADER_SNAPSHOT_TYPE		"(usa" GS_APP_SNAPSHOT_TYPE ")"
+
+/* memory used by the jobs for each action, protected by stats_mutex */
+typedef struct {
+	guint			 jobs;
+	guint64			 apps_created;
+	guint64			 apps_created_max;
+	guint64			 bytes_held_max;
+	guint64			 rss_peak_delta_max;	/* kB */
+} GsPluginLoaderMemory;
 
 typedef struct
 {
 	GPtrArray		*plugins;
+	GMutex			 plugins_running_mutex;
+	guint			 plugins_running;	/* for GS_PLUGIN_FLAGS_RUNNING_OTHER */
 	GPtrArray		*locations;
 	gchar			*locale;
 	gchar			*language;
 	GsAppList		*global_cache;
+	guint			 global_cache_expire_id;
+	gboolean		 snapshot_enabled;
+	GsAppList		*snapshot;		/* not yet revalidated */
 	AsProfile		*profile;
 	SoupSession		*soup_session;
 	GPtrArray		*auth_array;
@@ -64,12 +88,60 @@ typedef struct
 
 	guint			 updates_changed_id;
 	guint			 reload_id;
+	gint			 refine_serial;		/* bumped on ::reload */
 	GHashTable		*disallow_updates;	/* GsPlugin : const char *name */
 
 	GNetworkMonitor		*network_monitor;
 	gulong			 network_changed_handler;
+
+	GPtrArray		*plugins_for_action[GS_PLUGIN_ACTION_LAST];
+	GPtrArray		*plugins_for_adopt;
+	GHashTable		*plugin_preds;		/* GsPlugin : GPtrArray of GsPlugin */
+
+	GThreadPool		*job_pool;
+	GMutex			 job_mutex;
+	GPtrArray		*jobs_deferred;		/* of GsPluginLoaderJobItem */
+	gboolean		 jobs_shutdown;		/* queued jobs are cancelled */
+	guint			 jobs_running_for_action[GS_PLUGIN_ACTION_LAST];
+	guint			 jobs_running_background;
+	guint64			 jobs_seq;
+	GThreadPool		*refine_pool;		/* of GsPluginLoaderRefineItem */
+
+	GMutex			 flights_mutex;
+	GHashTable		*flights;		/* key : GsPluginLoaderFlight */
+
+	GMutex			 lazy_setup_mutex;
+	GCond			 lazy_setup_cond;
+	GHashTable		*lazy_setup;		/* GsPlugin : GsPluginLoaderLazySetup */
+	gint			 lazy_setup_pending;
+
+	GMutex			 stats_mutex;
+	GHashTable		*stats;			/* GsPluginLoaderStats : itself */
+	GsPluginLoaderMemory	 memory[GS_PLUGIN_ACTION_LAST];
+	gint			 profile_mode;		/* atomic */
 } GsPluginLoaderPrivate;
 
+/* enough to make the p99 meaningful while following recent behaviour */
+#define GS_PLUGIN_LOADER_STATS_SAMPLES		128
+
+typedef struct {
+	GsPlugin		*plugin;
+	GsPluginVfunc		 vfunc;
+	GsPluginAction		 action;
+	guint			 count;
+	guint			 errors;
+	guint64			 max;			/* us */
+	guint64			 apps_created;
+	guint64			 samples[GS_PLUGIN_LOADER_STATS_SAMPLES];
+} GsPluginLoaderStats;
+
+typedef enum {
+	GS_PLUGIN_LOADER_LAZY_SETUP_PENDING,
+	GS_PLUGIN_LOADER_LAZY_SETUP_RUNNING,
+	GS_PLUGIN_LOADER_LAZY_SETUP_DONE,
+	GS_PLUGIN_LOADER_LAZY_SETUP_FAILED
+} GsPluginLoaderLazySetup;
+
 static void gs_plugin_loader_monitor_network (GsPluginLoader *plugin_loader);
 
 G_DEFINE_TYPE_WITH_PRIVATE (GsPluginLoader, gs_plugin_loader, G_TYPE_OBJECT)
@@ -177,18 +249,26 @@ typedef void		 (*GsPluginAdoptAppFunc)	(GsPlugin	*plugin,
 
 /* async helper */
 typedef struct {
+	gint				 ref_count;
 	GsPluginLoader			*plugin_loader;
 	GCancellable			*cancellable;
 	GCancellable			*cancellable_caller;
 	gulong				 cancellable_id;
-	const gchar			*function_name;
+	GsPluginVfunc			 vfunc;
 	const gchar			*function_name_parent;
 	GPtrArray			*catlist;
 	GsPluginJob			*plugin_job;
-	gboolean			 anything_ran;
+	gint				 anything_ran;		/* atomic */
+	gint				 anything_failed;
 	guint				 timeout_id;
-	gboolean			 timeout_triggered;
+	gint				 timeout_triggered;	/* atomic */
 	gchar				**tokens;
+	GMainContext			*context;	/* for partial results */
+	GMutex				 results_mutex;
+	gboolean			 results_done;	/* late results are dropped */
+	GsAppList			*list_backfill;	/* not in the top max-results */
+	GHashTable			*apps_created;	/* GsPlugin : count, uses results_mutex */
+	GHashTable			*results;	/* GsPlugin : GsAppList, uses results_mutex */
 } GsPluginLoaderHelper;
 
 static GsPluginLoaderHelper *
@@ -196,15 +276,30 @@ gs_plugin_loader_helper_new (GsPluginLoader *plugin_loader, GsPluginJob *plugin_
 {
 	GsPluginLoaderHelper *helper = g_slice_new0 (GsPluginLoaderHelper);
 	GsPluginAction action = gs_plugin_job_get_action (plugin_job);
+	helper->ref_count = 1;
+	g_mutex_init (&helper->results_mutex);
+	helper->apps_created = g_hash_table_new (g_direct_hash, g_direct_equal);
+	helper->results = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+						 NULL, (GDestroyNotify) g_object_unref);
 	helper->plugin_loader = g_object_ref (plugin_loader);
 	helper->plugin_job = g_object_ref (plugin_job);
-	helper->function_name = gs_plugin_action_to_function_name (action);
+	helper->vfunc = gs_plugin_action_to_vfunc (action);
+	return helper;
+}
+
+/* plugins left to finish after their time budget keep the helper alive */
+static GsPluginLoaderHelper *
+gs_plugin_loader_helper_ref (GsPluginLoaderHelper *helper)
+{
+	g_atomic_int_inc (&helper->ref_count);
 	return helper;
 }
 
 static void
-gs_plugin_loader_helper_free (GsPluginLoaderHelper *helper)
+gs_plugin_loader_helper_unref (GsPluginLoaderHelper *helper)
 {
+	if (!g_atomic_int_dec_and_test (&helper->ref_count))
+		return;
 	if (helper->cancellable_id > 0) {
 		g_cancellable_disconnect (helper->cancellable_caller,
 					  helper->cancellable_id);
@@ -221,6 +316,13 @@ gs_plugin_loader_helper_free (GsPluginLoaderHelper *helper)
 	if (helper->catlist != NULL)
 		g_ptr_array_unref (helper->catlist);
 	g_strfreev (helper->tokens);
+	if (helper->context != NULL)
+		g_main_context_unref (helper->context);
+	if (helper->list_backfill != NULL)
+		g_object_unref (helper->list_backfill);
+	g_hash_table_unref (helper->apps_created);
+	g_hash_table_unref (helper->results);
+	g_mutex_clear (&helper->results_mutex);
 	g_slice_free (GsPluginLoaderHelper, helper);
 }
 
@@ -231,7 +333,7 @@ gs_plugin_loader_job_debug (GsPluginLoaderHelper *helper)
 	g_info ("%s", str);
 }
 
-G_DEFINE_AUTOPTR_CLEANUP_FUNC(GsPluginLoaderHelper, gs_plugin_loader_helper_free)
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(GsPluginLoaderHelper, gs_plugin_loader_helper_unref)
 
 static gint
 gs_plugin_loader_app_sort_name_cb (GsApp *app1, GsApp *app2, gpointer user_data)
@@ -261,9 +363,13 @@ gs_plugin_loader_action_start (GsPluginLoader *plugin_loader,
 {
 	GsPluginLoaderPrivate *priv = gs_plugin_loader_get_instance_private (plugin_loader);
 	guint i;
+	g_autoptr(GMutexLocker) locker = NULL;
 
 	/* set plugin as SELF and all plugins as OTHER */
 	gs_plugin_action_start (plugin, exclusive);
+	locker = g_mutex_locker_new (&priv->plugins_running_mutex);
+	if (priv->plugins_running++ > 0)
+		return;
 	for (i = 0; i < priv->plugins->len; i++) {
 		GsPlugin *plugin_tmp;
 		plugin_tmp = g_ptr_array_index (priv->plugins, i);
@@ -278,9 +384,13 @@ gs_plugin_loader_action_stop (GsPluginLoader *plugin_loader, GsPlugin *plugin)
 {
 	GsPluginLoaderPrivate *priv = gs_plugin_loader_get_instance_private (plugin_loader);
 	guint i;
+	g_autoptr(GMutexLocker) locker = NULL;
 
-	/* clear plugin as SELF and all plugins as OTHER */
+	/* clear plugin as SELF, and all plugins as OTHER once none are running */
 	gs_plugin_action_stop (plugin);
+	locker = g_mutex_locker_new (&priv->plugins_running_mutex);
+	if (--priv->plugins_running > 0)
+		return;
 	for (i = 0; i < priv->plugins->len; i++) {
 		GsPlugin *plugin_tmp;
 		plugin_tmp = g_ptr_array_index (priv->plugins, i);
@@ -294,7 +404,9 @@ static gboolean
 gs_plugin_loader_notify_idle_cb (gpointer user_data)
 {
 	GsPluginLoader *plugin_loader = GS_PLUGIN_LOADER (user_data);
+	gint64 ts_trace = gs_trace_begin ();
 	g_object_notify (G_OBJECT (plugin_loader), "events");
+	gs_trace_end (ts_trace, "idle", G_STRFUNC, NULL);
 	return FALSE;
 }
 
@@ -391,7 +503,7 @@ gs_plugin_error_handle_failure (GsPluginLoaderHelper *helper,
 	if (error_local == NULL) {
 		g_critical ("%s did not set error for %s",
 			    gs_plugin_get_name (plugin),
-			    helper->function_name);
+			    gs_plugin_vfunc_to_string (helper->vfunc));
 		return TRUE;
 	}
 
@@ -411,6 +523,7 @@ gs_plugin_error_handle_failure (GsPluginLoaderHelper *helper,
 			*error = g_error_copy (error_local);
 		return FALSE;
 	}
+	g_atomic_int_set (&helper->anything_failed, TRUE);
 
 	/* fallback to console warning */
 	if ((flags & GS_PLUGIN_FAILURE_FLAGS_NO_CONSOLE) == 0) {
@@ -418,7 +531,7 @@ gs_plugin_error_handle_failure (GsPluginLoaderHelper *helper,
 				      GS_PLUGIN_ERROR,
 				      GS_PLUGIN_ERROR_CANCELLED)) {
 			g_warning ("failed to call %s on %s: %s",
-				   helper->function_name,
+				   gs_plugin_vfunc_to_string (helper->vfunc),
 				   gs_plugin_get_name (plugin),
 				   error_local->message);
 		}
@@ -427,6 +540,152 @@ gs_plugin_error_handle_failure (GsPluginLoaderHelper *helper,
 	return TRUE;
 }
 
+static guint
+gs_plugin_loader_stats_hash (gconstpointer key)
+{
+	const GsPluginLoaderStats *stats = key;
+	return g_direct_hash (stats->plugin) ^
+		((guint) stats->vfunc << 8) ^
+		((guint) stats->action << 16);
+}
+
+static gboolean
+gs_plugin_loader_stats_equal (gconstpointer a, gconstpointer b)
+{
+	const GsPluginLoaderStats *stats_a = a;
+	const GsPluginLoaderStats *stats_b = b;
+	return stats_a->plugin == stats_b->plugin &&
+		stats_a->vfunc == stats_b->vfunc &&
+		stats_a->action == stats_b->action;
+}
+
+static void
+gs_plugin_loader_stats_add (GsPluginLoader *plugin_loader,
+			    GsPlugin *plugin,
+			    GsPluginVfunc vfunc,
+			    GsPluginAction action,
+			    guint64 duration,
+			    gboolean failed,
+			    guint apps_created)
+{
+	GsPluginLoaderPrivate *priv = gs_plugin_loader_get_instance_private (plugin_loader);
+	GsPluginLoaderStats key = { plugin, vfunc, action };
+	GsPluginLoaderStats *stats;
+	g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&priv->stats_mutex);
+
+	stats = g_hash_table_lookup (priv->stats, &key);
+	if (stats == NULL) {
+		stats = g_slice_new0 (GsPluginLoaderStats);
+		stats->plugin = plugin;
+		stats->vfunc = vfunc;
+		stats->action = action;
+		g_hash_table_add (priv->stats, stats);
+	}
+	stats->samples[stats->count % GS_PLUGIN_LOADER_STATS_SAMPLES] = duration;
+	stats->count++;
+	if (failed)
+		stats->errors++;
+	stats->max = MAX (stats->max, duration);
+	stats->apps_created += apps_created;
+}
+
+static void
+gs_plugin_loader_stats_free (GsPluginLoaderStats *stats)
+{
+	g_slice_free (GsPluginLoaderStats, stats);
+}
+
+static gint
+gs_plugin_loader_stats_sample_sort_cb (gconstpointer a, gconstpointer b, gpointer user_data)
+{
+	guint64 sample_a = *((const guint64 *) a);
+	guint64 sample_b = *((const guint64 *) b);
+	if (sample_a < sample_b)
+		return -1;
+	if (sample_a > sample_b)
+		return 1;
+	return 0;
+}
+
+/* runs the setup of a plugin with %GS_PLUGIN_FLAGS_LAZY_SETUP the first time
+ * it is used, with any other callers waiting for it to complete; the caller
+ * must have already called gs_plugin_loader_action_start() so the setup holds
+ * the plugin lock like the other vfuncs; returns %FALSE if the plugin cannot
+ * be used */
+static gboolean
+gs_plugin_loader_ensure_setup (GsPluginLoader *plugin_loader, GsPlugin *plugin)
+{
+	GsPluginLoaderPrivate *priv = gs_plugin_loader_get_instance_private (plugin_loader);
+	GsPluginLoaderLazySetup state;
+	GsPluginSetupFunc setup_func;
+	gboolean ret;
+	gint64 time_start;
+	g_autoptr(GError) error_local = NULL;
+
+	/* everything already set up */
+	if (g_atomic_int_get (&priv->lazy_setup_pending) == 0)
+		return TRUE;
+
+	g_mutex_lock (&priv->lazy_setup_mutex);
+	for (;;) {
+		gpointer value;
+		if (!g_hash_table_lookup_extended (priv->lazy_setup, plugin, NULL, &value)) {
+			g_mutex_unlock (&priv->lazy_setup_mutex);
+			return TRUE;
+		}
+		state = GPOINTER_TO_INT (value);
+		if (state != GS_PLUGIN_LOADER_LAZY_SETUP_RUNNING)
+			break;
+		g_cond_wait (&priv->lazy_setup_cond, &priv->lazy_setup_mutex);
+	}
+	if (state != GS_PLUGIN_LOADER_LAZY_SETUP_PENDING) {
+		g_mutex_unlock (&priv->lazy_setup_mutex);
+		return state == GS_PLUGIN_LOADER_LAZY_SETUP_DONE;
+	}
+	g_hash_table_insert (priv->lazy_setup, plugin,
+			     GINT_TO_POINTER (GS_PLUGIN_LOADER_LAZY_SETUP_RUNNING));
+	g_mutex_unlock (&priv->lazy_setup_mutex);
+
+	/* not cancellable, as a failure disables the plugin for good */
+	g_debug ("setting up %s on first use", gs_plugin_get_name (plugin));
+	time_start = g_get_monotonic_time ();
+	setup_func = gs_plugin_get_vfunc (plugin, GS_PLUGIN_VFUNC_SETUP);
+	ret = setup_func (plugin, NULL, &error_local);
+	gs_plugin_set_setup_time (plugin, (g_get_monotonic_time () - time_start) / 1000);
+	if (!ret) {
+		g_debug ("disabling %s as setup failed: %s",
+			 gs_plugin_get_name (plugin),
+			 error_local != NULL ? error_local->message : "unknown error");
+		gs_plugin_set_enabled (plugin, FALSE);
+	}
+
+	g_mutex_lock (&priv->lazy_setup_mutex);
+	g_hash_table_insert (priv->lazy_setup, plugin,
+			     GINT_TO_POINTER (ret ? GS_PLUGIN_LOADER_LAZY_SETUP_DONE :
+						    GS_PLUGIN_LOADER_LAZY_SETUP_FAILED));
+	g_atomic_int_add (&priv->lazy_setup_pending, -1);
+	g_cond_broadcast (&priv->lazy_setup_cond);
+	g_mutex_unlock (&priv->lazy_setup_mutex);
+	return ret;
+}
+
+/* returns %TRUE if the plugin has %GS_PLUGIN_FLAGS_LAZY_SETUP and has not
+ * been used yet */
+static gboolean
+gs_plugin_loader_setup_is_pending (GsPluginLoader *plugin_loader, GsPlugin *plugin)
+{
+	GsPluginLoaderPrivate *priv = gs_plugin_loader_get_instance_private (plugin_loader);
+	gpointer value;
+	g_autoptr(GMutexLocker) locker = NULL;
+
+	if (g_atomic_int_get (&priv->lazy_setup_pending) == 0)
+		return FALSE;
+	locker = g_mutex_locker_new (&priv->lazy_setup_mutex);
+	if (!g_hash_table_lookup_extended (priv->lazy_setup, plugin, NULL, &value))
+		return FALSE;
+	return GPOINTER_TO_INT (value) == GS_PLUGIN_LOADER_LAZY_SETUP_PENDING;
+}
+
 static void
 gs_plugin_loader_run_adopt (GsPluginLoader *plugin_loader, GsAppList *list)
 {
@@ -435,27 +694,30 @@ gs_plugin_loader_run_adopt (GsPluginLoader *plugin_loader, GsAppList *list)
 	guint j;
 
 	/* go through each plugin in order */
-	for (i = 0; i < priv->plugins->len; i++) {
+	for (i = 0; i < priv->plugins_for_adopt->len; i++) {
 		GsPluginAdoptAppFunc adopt_app_func = NULL;
-		GsPlugin *plugin = g_ptr_array_index (priv->plugins, i);
-		adopt_app_func = gs_plugin_get_symbol (plugin, "gs_plugin_adopt_app");
+		GsPlugin *plugin = g_ptr_array_index (priv->plugins_for_adopt, i);
+		adopt_app_func = gs_plugin_get_vfunc (plugin, GS_PLUGIN_VFUNC_ADOPT_APP);
 		if (adopt_app_func == NULL)
 			continue;
+
+		/* adopting only looks at the app, so is not a reason to set
+		 * up a plugin with %GS_PLUGIN_FLAGS_LAZY_SETUP */
+		gs_plugin_loader_action_start (plugin_loader, plugin, FALSE);
 		for (j = 0; j < gs_app_list_length (list); j++) {
 			GsApp *app = gs_app_list_index (list, j);
 			if (gs_app_get_management_plugin (app) != NULL)
 				continue;
 			if (gs_app_has_quirk (app, AS_APP_QUIRK_MATCH_ANY_PREFIX))
 				continue;
-			gs_plugin_loader_action_start (plugin_loader, plugin, FALSE);
 			adopt_app_func (plugin, app);
-			gs_plugin_loader_action_stop (plugin_loader, plugin);
 			if (gs_app_get_management_plugin (app) != NULL) {
 				g_debug ("%s adopted %s",
 					 gs_plugin_get_name (plugin),
 					 gs_app_get_unique_id (app));
 			}
 		}
+		gs_plugin_loader_action_stop (plugin_loader, plugin);
 	}
 	for (j = 0; j < gs_app_list_length (list); j++) {
 		GsApp *app = gs_app_list_index (list, j);
@@ -479,40 +741,60 @@ gs_plugin_loader_review_score_sort_cb (gconstpointer a, gconstpointer b)
 	return 0;
 }
 
+/* the caller must have already called gs_plugin_loader_action_start() */
 static gboolean
-gs_plugin_loader_call_vfunc (GsPluginLoaderHelper *helper,
-			     GsPlugin *plugin,
-			     GsApp *app,
-			     GsAppList *list,
-			     GCancellable *cancellable,
-			     GError **error)
+gs_plugin_loader_call_vfunc_locked (GsPluginLoaderHelper *helper,
+				    GsPlugin *plugin,
+				    GsPluginVfunc vfunc,
+				    GsApp *app,
+				    GsAppList *list,
+				    GCancellable *cancellable,
+				    GError **error)
 {
 	GsPluginLoaderPrivate *priv = gs_plugin_loader_get_instance_private (helper->plugin_loader);
 	GsPluginAction action = gs_plugin_job_get_action (helper->plugin_job);
 	gboolean ret = TRUE;
+	gdouble elapsed;
+	gint64 time_start;
+	gint64 ts_trace;
+	guint apps_created;
 	gpointer func = NULL;
 	g_autoptr(GError) error_local = NULL;
-	g_autoptr(GTimer) timer = g_timer_new ();
 	g_autoptr(AsProfileTask) ptask = NULL;
 
-	/* load the possible symbol */
-	func = gs_plugin_get_symbol (plugin, helper->function_name);
+	/* use the precompiled vfunc */
+	func = gs_plugin_get_vfunc (plugin, vfunc);
 	if (func == NULL)
 		return TRUE;
 
+	/* refining apps that another plugin manages is not a reason to set up
+	 * a plugin on first use */
+	if (vfunc == GS_PLUGIN_VFUNC_REFINE_APP && app != NULL &&
+	    g_strcmp0 (gs_app_get_management_plugin (app),
+		       gs_plugin_get_name (plugin)) != 0 &&
+	    gs_plugin_loader_setup_is_pending (helper->plugin_loader, plugin))
+		return TRUE;
+
+	/* set up on first use */
+	if (vfunc != GS_PLUGIN_VFUNC_INITIALIZE &&
+	    vfunc != GS_PLUGIN_VFUNC_DESTROY &&
+	    vfunc != GS_PLUGIN_VFUNC_SETUP &&
+	    !gs_plugin_loader_ensure_setup (helper->plugin_loader, plugin))
+		return TRUE;
+
 	/* profile */
-	if (g_strcmp0 (helper->function_name, "gs_plugin_refine_app") != 0) {
+	if (vfunc != GS_PLUGIN_VFUNC_REFINE_APP) {
 		if (helper->function_name_parent == NULL) {
 			ptask = as_profile_start (priv->profile,
 						  "GsPlugin::%s(%s)",
 						  gs_plugin_get_name (plugin),
-						  helper->function_name);
+						  gs_plugin_vfunc_to_string (vfunc));
 		} else {
 			ptask = as_profile_start (priv->profile,
 						  "GsPlugin::%s(%s;%s)",
 						  gs_plugin_get_name (plugin),
 						  helper->function_name_parent,
-						  helper->function_name);
+						  gs_plugin_vfunc_to_string (vfunc));
 		}
 		g_assert (ptask != NULL);
 	}
@@ -523,11 +805,10 @@ gs_plugin_loader_call_vfunc (GsPluginLoaderHelper *helper,
 	if (list == NULL)
 		list = gs_plugin_job_get_list (helper->plugin_job);
 
-	/* set what plugin is running on the job */
-	gs_plugin_job_set_plugin (helper->plugin_job, plugin);
-
 	/* run the correct vfunc */
-	gs_plugin_loader_action_start (helper->plugin_loader, plugin, FALSE);
+	ts_trace = gs_trace_begin ();
+	apps_created = gs_app_get_created_count ();
+	time_start = g_get_monotonic_time ();
 	switch (action) {
 	case GS_PLUGIN_ACTION_INITIALIZE:
 	case GS_PLUGIN_ACTION_DESTROY:
@@ -543,37 +824,37 @@ gs_plugin_loader_call_vfunc (GsPluginLoaderHelper *helper,
 		}
 		break;
 	case GS_PLUGIN_ACTION_REFINE:
-		if (g_strcmp0 (helper->function_name, "gs_plugin_refine_wildcard") == 0) {
+		if (vfunc == GS_PLUGIN_VFUNC_REFINE_WILDCARD) {
 			GsPluginRefineWildcardFunc plugin_func = func;
 			ret = plugin_func (plugin, app, list,
 					   gs_plugin_job_get_refine_flags (helper->plugin_job),
 					   cancellable, &error_local);
-		} else if (g_strcmp0 (helper->function_name, "gs_plugin_refine_app") == 0) {
+		} else if (vfunc == GS_PLUGIN_VFUNC_REFINE_APP) {
 			GsPluginRefineAppFunc plugin_func = func;
 			ret = plugin_func (plugin, app,
 					   gs_plugin_job_get_refine_flags (helper->plugin_job),
 					   cancellable, &error_local);
-		} else if (g_strcmp0 (helper->function_name, "gs_plugin_refine") == 0) {
+		} else if (vfunc == GS_PLUGIN_VFUNC_REFINE) {
 			GsPluginRefineFunc plugin_func = func;
 			ret = plugin_func (plugin, list,
 					   gs_plugin_job_get_refine_flags (helper->plugin_job),
 					   cancellable, &error_local);
 		} else {
-			g_critical ("function_name %s invalid for %s",
-				    helper->function_name,
+			g_critical ("vfunc %s invalid for %s",
+				    gs_plugin_vfunc_to_string (vfunc),
 				    gs_plugin_action_to_string (action));
 		}
 		break;
 	case GS_PLUGIN_ACTION_UPDATE:
-		if (g_strcmp0 (helper->function_name, "gs_plugin_update_app") == 0) {
+		if (vfunc == GS_PLUGIN_VFUNC_UPDATE_APP) {
 			GsPluginActionFunc plugin_func = func;
 			ret = plugin_func (plugin, app, cancellable, &error_local);
-		} else if (g_strcmp0 (helper->function_name, "gs_plugin_update") == 0) {
+		} else if (vfunc == GS_PLUGIN_VFUNC_UPDATE) {
 			GsPluginUpdateFunc plugin_func = func;
 			ret = plugin_func (plugin, list, cancellable, &error_local);
 		} else {
-			g_critical ("function_name %s invalid for %s",
-				    helper->function_name,
+			g_critical ("vfunc %s invalid for %s",
+				    gs_plugin_vfunc_to_string (vfunc),
 				    gs_plugin_action_to_string (action));
 		}
 		break;
@@ -702,10 +983,33 @@ gs_plugin_loader_call_vfunc (GsPluginLoaderHelper *helper,
 		}
 		break;
 	default:
-		g_critical ("no handler for %s", helper->function_name);
+		g_critical ("no handler for %s",
+			    gs_plugin_vfunc_to_string (vfunc));
 		break;
 	}
-	gs_plugin_loader_action_stop (helper->plugin_loader, plugin);
+	elapsed = (gdouble) (g_get_monotonic_time () - time_start) / G_USEC_PER_SEC;
+	apps_created = gs_app_get_created_count () - apps_created;
+	gs_plugin_loader_stats_add (helper->plugin_loader, plugin, vfunc, action,
+				    (guint64) (g_get_monotonic_time () - time_start),
+				    !ret, apps_created);
+	if (apps_created > 0) {
+		gpointer value;
+		g_mutex_lock (&helper->results_mutex);
+		value = g_hash_table_lookup (helper->apps_created, plugin);
+		g_hash_table_insert (helper->apps_created, plugin,
+				     GUINT_TO_POINTER (GPOINTER_TO_UINT (value) + apps_created));
+		g_mutex_unlock (&helper->results_mutex);
+	}
+	if (ts_trace != 0) {
+		g_autofree gchar *apps = NULL;
+		apps = g_strdup_printf ("%u", list != NULL ? gs_app_list_length (list) :
+							     app != NULL ? 1 : 0);
+		gs_trace_end (ts_trace, "vfunc", gs_plugin_vfunc_to_string (vfunc),
+			      "plugin", gs_plugin_get_name (plugin),
+			      "action", gs_plugin_action_to_string (action),
+			      "apps", apps,
+			      NULL);
+	}
 
 	/* plugin did not return error on cancellable abort */
 	if (ret && g_cancellable_set_error_if_cancelled (cancellable, &error_local)) {
@@ -719,7 +1023,7 @@ gs_plugin_loader_call_vfunc (GsPluginLoaderHelper *helper,
 	if (!ret) {
 		/* we returned cancelled, but this was because of a timeout,
 		 * so re-create error, throwing the plugin under the bus */
-		if (helper->timeout_triggered &&
+		if (g_atomic_int_get (&helper->timeout_triggered) &&
 		    g_error_matches (error_local, GS_PLUGIN_ERROR, GS_PLUGIN_ERROR_CANCELLED)) {
 			g_debug ("converting cancelled to timeout");
 			g_clear_error (&error_local);
@@ -741,28 +1045,580 @@ gs_plugin_loader_call_vfunc (GsPluginLoaderHelper *helper,
 	case GS_PLUGIN_ACTION_INITIALIZE:
 	case GS_PLUGIN_ACTION_DESTROY:
 	case GS_PLUGIN_ACTION_SETUP:
-		if (g_timer_elapsed (timer, NULL) > 0.5f) {
+		if (elapsed > 0.5f) {
 			g_warning ("plugin %s took %.1f seconds to do %s",
 				   gs_plugin_get_name (plugin),
-				   g_timer_elapsed (timer, NULL),
+				   elapsed,
 				   gs_plugin_action_to_string (action));
 		}
 		break;
 	default:
-		if (g_timer_elapsed (timer, NULL) > 0.5f) {
+		if (elapsed > 0.5f) {
 			g_debug ("plugin %s took %.1f seconds to do %s",
 				 gs_plugin_get_name (plugin),
-				 g_timer_elapsed (timer, NULL),
+				 elapsed,
 				 gs_plugin_action_to_string (action));
 			}
 		break;
 	}
 
 	/* success */
-	helper->anything_ran = TRUE;
+	g_atomic_int_set (&helper->anything_ran, TRUE);
+	return TRUE;
+}
+
+static gboolean
+gs_plugin_loader_call_vfunc (GsPluginLoaderHelper *helper,
+			     GsPlugin *plugin,
+			     GsApp *app,
+			     GsAppList *list,
+			     GCancellable *cancellable,
+			     GError **error)
+{
+	gboolean ret;
+
+	/* avoid locking the plugin if there is nothing to run */
+	if (gs_plugin_get_vfunc (plugin, helper->vfunc) == NULL)
+		return TRUE;
+
+	/* set what plugin is running on the job */
+	gs_plugin_job_set_plugin (helper->plugin_job, plugin);
+
+	gs_plugin_loader_action_start (helper->plugin_loader, plugin, FALSE);
+	ret = gs_plugin_loader_call_vfunc_locked (helper, plugin, helper->vfunc,
+						  app, list, cancellable, error);
+	gs_plugin_loader_action_stop (helper->plugin_loader, plugin);
+	return ret;
+}
+
+typedef gboolean	 (*GsPluginLoaderDagFunc)	(GsPluginLoaderHelper *helper,
+							 GsPlugin	*plugin,
+							 gpointer	 user_data,
+							 GCancellable	*cancellable,
+							 GError		**error);
+typedef gboolean	 (*GsPluginLoaderDagExclusiveFunc) (GsPlugin	*plugin,
+							 gpointer	 user_data);
+
+typedef struct {
+	guint			 succ;
+	gboolean		 hard;		/* not just because of the order */
+} GsPluginLoaderDagEdge;
+
+typedef struct {
+	gint			 ref_count;
+	GsPluginLoaderHelper	*helper;
+	GPtrArray		*plugins;
+	GsPluginLoaderDagFunc	 func;
+	gpointer		 user_data;	/* a GObject, or NULL */
+	GCancellable		*cancellable;
+	GThreadPool		*pool;
+	guint			*npreds;	/* unfinished predecessors */
+	GArray			**succs;	/* of GsPluginLoaderDagEdge */
+	gboolean		*exclusive;
+	gint64			*started;	/* monotonic, or 0 */
+	gboolean		*finished;
+	gboolean		*released;	/* over budget, successors started */
+	guint			 remaining;
+	gboolean		 abandoned;
+	GMutex			 mutex;
+	GCond			 cond;
+	GError			*error;		/* first fatal error */
+} GsPluginLoaderDag;
+
+static void
+gs_plugin_loader_dag_unref (GsPluginLoaderDag *dag)
+{
+	if (!g_atomic_int_dec_and_test (&dag->ref_count))
+		return;
+	if (dag->pool != NULL)
+		g_thread_pool_free (dag->pool, FALSE, FALSE);
+	for (guint i = 0; i < dag->plugins->len; i++)
+		g_array_unref (dag->succs[i]);
+	g_free (dag->succs);
+	g_free (dag->npreds);
+	g_free (dag->exclusive);
+	g_free (dag->started);
+	g_free (dag->finished);
+	g_free (dag->released);
+	g_ptr_array_unref (dag->plugins);
+	if (dag->user_data != NULL)
+		g_object_unref (dag->user_data);
+	if (dag->cancellable != NULL)
+		g_object_unref (dag->cancellable);
+	gs_plugin_loader_helper_unref (dag->helper);
+	g_mutex_clear (&dag->mutex);
+	g_cond_clear (&dag->cond);
+	g_clear_error (&dag->error);
+	g_slice_free (GsPluginLoaderDag, dag);
+}
+
+/* called with the mutex held */
+static void
+gs_plugin_loader_dag_push (GsPluginLoaderDag *dag, guint idx)
+{
+	g_atomic_int_inc (&dag->ref_count);
+	g_thread_pool_push (dag->pool, GUINT_TO_POINTER (idx + 1), NULL);
+}
+
+static gboolean
+gs_plugin_loader_array_has_plugin (GPtrArray *array, GsPlugin *plugin)
+{
+	for (guint i = 0; i < array->len; i++) {
+		if (g_ptr_array_index (array, i) == plugin)
+			return TRUE;
+	}
+	return FALSE;
+}
+
+static gboolean
+gs_plugin_loader_plugin_runs_after (GsPluginLoader *plugin_loader,
+				    GsPlugin *plugin,
+				    GsPlugin *dep)
+{
+	GsPluginLoaderPrivate *priv = gs_plugin_loader_get_instance_private (plugin_loader);
+	GPtrArray *preds = g_hash_table_lookup (priv->plugin_preds, plugin);
+	if (preds == NULL)
+		return FALSE;
+	return gs_plugin_loader_array_has_plugin (preds, dep);
+}
+
+static void
+gs_plugin_loader_dag_thread_cb (gpointer data, gpointer user_data)
+{
+	GsPluginLoaderDag *dag = (GsPluginLoaderDag *) user_data;
+	guint idx = GPOINTER_TO_UINT (data) - 1;
+	GsPlugin *plugin = g_ptr_array_index (dag->plugins, idx);
+	gboolean skip;
+	g_autoptr(GError) error_local = NULL;
+
+	/* another plugin already failed fatally */
+	g_mutex_lock (&dag->mutex);
+	skip = dag->error != NULL;
+	dag->started[idx] = g_get_monotonic_time ();
+	g_mutex_unlock (&dag->mutex);
+	if (!skip && !dag->func (dag->helper, plugin, dag->user_data,
+				 dag->cancellable, &error_local)) {
+		g_mutex_lock (&dag->mutex);
+		if (dag->error == NULL)
+			dag->error = g_steal_pointer (&error_local);
+		g_mutex_unlock (&dag->mutex);
+	}
+
+	/* start any plugins that were only waiting for this one */
+	g_mutex_lock (&dag->mutex);
+	dag->finished[idx] = TRUE;
+	if (dag->abandoned) {
+		g_debug ("%s finished after %s returned",
+			 gs_plugin_get_name (plugin),
+			 gs_plugin_action_to_string (gs_plugin_job_get_action (dag->helper->plugin_job)));
+	}
+	for (guint i = 0; i < dag->succs[idx]->len; i++) {
+		GsPluginLoaderDagEdge *edge = &g_array_index (dag->succs[idx], GsPluginLoaderDagEdge, i);
+		if (!edge->hard && dag->released[idx])
+			continue;
+		if (--dag->npreds[edge->succ] == 0)
+			gs_plugin_loader_dag_push (dag, edge->succ);
+	}
+	dag->remaining--;
+	g_cond_signal (&dag->cond);
+	g_mutex_unlock (&dag->mutex);
+	gs_plugin_loader_dag_unref (dag);
+}
+
+/* plugins that only wait for a plugin over its time budget because of the
+ * order do not need anything it sets, so start them rather than abandoning
+ * them along with it; called with the mutex held */
+static void
+gs_plugin_loader_dag_release_late (GsPluginLoaderDag *dag)
+{
+	GsPluginAction action = gs_plugin_job_get_action (dag->helper->plugin_job);
+	gint64 now = g_get_monotonic_time ();
+
+	for (guint i = 0; i < dag->plugins->len; i++) {
+		GsPlugin *plugin = g_ptr_array_index (dag->plugins, i);
+		gint64 budget;
+
+		if (dag->started[i] == 0 || dag->finished[i] || dag->released[i])
+			continue;
+		budget = (gint64) gs_plugin_get_budget (plugin, action) * 1000;
+		if (budget == 0 || now < dag->started[i] + budget)
+			continue;
+		g_debug ("%s is over budget, not holding up later plugins",
+			 gs_plugin_get_name (plugin));
+		dag->released[i] = TRUE;
+		for (guint j = 0; j < dag->succs[i]->len; j++) {
+			GsPluginLoaderDagEdge *edge = &g_array_index (dag->succs[i], GsPluginLoaderDagEdge, j);
+			if (edge->hard)
+				continue;
+			if (--dag->npreds[edge->succ] == 0)
+				gs_plugin_loader_dag_push (dag, edge->succ);
+		}
+	}
+}
+
+/* returns %TRUE if every plugin still to finish is over its time budget, or
+ * waiting for one that is, and can be left to finish in the background;
+ * called with the mutex held */
+static gboolean
+gs_plugin_loader_dag_can_abandon (GsPluginLoaderDag *dag, gint64 *deadline)
+{
+	GsPluginAction action = gs_plugin_job_get_action (dag->helper->plugin_job);
+	gboolean ret = TRUE;
+	gint64 now = g_get_monotonic_time ();
+	guint late = 0;
+
+	*deadline = 0;
+	for (guint i = 0; i < dag->plugins->len; i++) {
+		GsPlugin *plugin = g_ptr_array_index (dag->plugins, i);
+		gint64 budget;
+
+		if (dag->finished[i])
+			continue;
+
+		/* these may change the list the caller gets back */
+		if (dag->exclusive[i])
+			return FALSE;
+
+		/* queued, or blocked behind another plugin */
+		if (dag->started[i] == 0) {
+			if (dag->npreds[i] == 0)
+				ret = FALSE;
+			continue;
+		}
+
+		budget = (gint64) gs_plugin_get_budget (plugin, action) * 1000;
+		if (budget == 0) {
+			ret = FALSE;
+		} else if (now < dag->started[i] + budget) {
+			if (*deadline == 0 || dag->started[i] + budget < *deadline)
+				*deadline = dag->started[i] + budget;
+			ret = FALSE;
+		} else {
+			late++;
+		}
+	}
+	return ret && late > 0;
+}
+
+/* runs @func on each plugin, running plugins with no ordering relationship
+ * at the same time and only starting a plugin once all the plugins it has
+ * to run after have finished; with @by_order set, plugins that work on the
+ * same apps also wait for every plugin with a lower order, as many rely on
+ * data set by earlier plugins without declaring a rule for it */
+static gboolean
+gs_plugin_loader_run_dag (GsPluginLoaderHelper *helper,
+			  GPtrArray *plugins,
+			  GsPluginLoaderDagFunc func,
+			  GsPluginLoaderDagExclusiveFunc exclusive_func,
+			  gboolean by_order,
+			  gpointer user_data,
+			  GCancellable *cancellable,
+			  GError **error)
+{
+	GsPluginLoaderDag *dag;
+	gboolean use_budgets;
+	g_autoptr(GError) error_pool = NULL;
+	g_autoptr(GError) error_dag = NULL;
+
+	/* only interactive jobs return before the slowest plugin */
+	use_budgets = gs_plugin_job_get_priority (helper->plugin_job) == GS_PLUGIN_JOB_PRIORITY_INTERACTIVE;
+
+	/* nothing to schedule */
+	if (plugins->len == 0 || (plugins->len == 1 && !use_budgets)) {
+		for (guint i = 0; i < plugins->len; i++) {
+			if (!func (helper, g_ptr_array_index (plugins, i),
+				   user_data, cancellable, error))
+				return FALSE;
+		}
+		return TRUE;
+	}
+
+	/* this outlives the call if plugins are left to finish late */
+	dag = g_slice_new0 (GsPluginLoaderDag);
+	dag->ref_count = 1;
+	dag->helper = gs_plugin_loader_helper_ref (helper);
+	dag->plugins = g_ptr_array_ref (plugins);
+	dag->func = func;
+	if (user_data != NULL)
+		dag->user_data = g_object_ref (user_data);
+	if (cancellable != NULL)
+		dag->cancellable = g_object_ref (cancellable);
+	g_mutex_init (&dag->mutex);
+	g_cond_init (&dag->cond);
+
+	/* exclusive plugins run after everything ordered before them and
+	 * before everything ordered after them */
+	dag->exclusive = g_new0 (gboolean, plugins->len);
+	for (guint i = 0; i < plugins->len; i++) {
+		GsPlugin *plugin = g_ptr_array_index (plugins, i);
+		if (exclusive_func != NULL)
+			dag->exclusive[i] = exclusive_func (plugin, user_data);
+	}
+
+	/* build the edges for just these plugins */
+	dag->npreds = g_new0 (guint, plugins->len);
+	dag->succs = g_new0 (GArray *, plugins->len);
+	dag->started = g_new0 (gint64, plugins->len);
+	dag->finished = g_new0 (gboolean, plugins->len);
+	dag->released = g_new0 (gboolean, plugins->len);
+	for (guint i = 0; i < plugins->len; i++)
+		dag->succs[i] = g_array_new (FALSE, FALSE, sizeof (GsPluginLoaderDagEdge));
+	for (guint i = 0; i < plugins->len; i++) {
+		GsPlugin *plugin = g_ptr_array_index (plugins, i);
+		for (guint j = 0; j < i; j++) {
+			GsPlugin *dep = g_ptr_array_index (plugins, j);
+			GsPluginLoaderDagEdge edge = { i, FALSE };
+			edge.hard = dag->exclusive[i] || dag->exclusive[j] ||
+				    gs_plugin_loader_plugin_runs_after (helper->plugin_loader,
+									plugin, dep);
+			if (!edge.hard &&
+			    !(by_order && gs_plugin_get_order (dep) < gs_plugin_get_order (plugin)))
+				continue;
+			g_array_append_val (dag->succs[j], edge);
+			dag->npreds[i]++;
+		}
+	}
+
+	/* run everything that has no predecessors */
+	dag->remaining = plugins->len;
+	dag->pool = g_thread_pool_new (gs_plugin_loader_dag_thread_cb,
+				       dag,
+				       (gint) g_get_num_processors (),
+				       FALSE,
+				       &error_pool);
+	if (dag->pool == NULL) {
+		g_set_error (error,
+			     GS_PLUGIN_ERROR,
+			     GS_PLUGIN_ERROR_FAILED,
+			     "failed to create thread pool: %s",
+			     error_pool->message);
+		gs_plugin_loader_dag_unref (dag);
+		return FALSE;
+	}
+	g_mutex_lock (&dag->mutex);
+	for (guint i = 0; i < plugins->len; i++) {
+		if (dag->npreds[i] == 0)
+			gs_plugin_loader_dag_push (dag, i);
+	}
+
+	/* wait for every plugin to finish, or to run out of time */
+	while (dag->remaining > 0) {
+		gint64 deadline = 0;
+		if (use_budgets)
+			gs_plugin_loader_dag_release_late (dag);
+		if (use_budgets && gs_plugin_loader_dag_can_abandon (dag, &deadline)) {
+			dag->abandoned = TRUE;
+			break;
+		}
+		if (deadline > 0)
+			g_cond_wait_until (&dag->cond, &dag->mutex, deadline);
+		else
+			g_cond_wait (&dag->cond, &dag->mutex);
+	}
+	if (dag->abandoned) {
+		for (guint i = 0; i < plugins->len; i++) {
+			if (dag->finished[i])
+				continue;
+			g_debug ("not waiting for %s to %s",
+				 gs_plugin_get_name (g_ptr_array_index (plugins, i)),
+				 gs_plugin_action_to_string (gs_plugin_job_get_action (helper->plugin_job)));
+		}
+
+		/* the results are not complete */
+		g_atomic_int_set (&helper->anything_failed, TRUE);
+	}
+	error_dag = g_steal_pointer (&dag->error);
+	g_mutex_unlock (&dag->mutex);
+	gs_plugin_loader_dag_unref (dag);
+
+	if (error_dag != NULL) {
+		g_propagate_error (error, g_steal_pointer (&error_dag));
+		return FALSE;
+	}
+	return TRUE;
+}
+
+typedef struct {
+	GsPluginLoaderHelper	*helper;
+	GsPlugin		*plugin;
+	GCancellable		*cancellable;
+	GMutex			 mutex;
+	GCond			 cond;
+	guint			 pending;	/* apps not yet refined */
+	GError			*error;		/* first fatal error */
+} GsPluginLoaderRefineBatch;
+
+typedef struct {
+	GsPluginLoaderRefineBatch *batch;
+	GsApp			*app;
+} GsPluginLoaderRefineItem;
+
+static void
+gs_plugin_loader_refine_app_thread_cb (gpointer data, gpointer user_data)
+{
+	GsPluginLoaderRefineItem *item = (GsPluginLoaderRefineItem *) data;
+	GsPluginLoaderRefineBatch *batch = item->batch;
+	gboolean skip;
+	g_autoptr(GError) error_local = NULL;
+
+	/* another app already failed fatally */
+	g_mutex_lock (&batch->mutex);
+	skip = batch->error != NULL;
+	g_mutex_unlock (&batch->mutex);
+
+	if (!skip &&
+	    !gs_plugin_loader_call_vfunc_locked (batch->helper, batch->plugin,
+						 GS_PLUGIN_VFUNC_REFINE_APP,
+						 item->app, NULL,
+						 batch->cancellable,
+						 &error_local)) {
+		g_mutex_lock (&batch->mutex);
+		if (batch->error == NULL)
+			batch->error = g_steal_pointer (&error_local);
+		g_mutex_unlock (&batch->mutex);
+	}
+
+	/* the batch is on the stack of the waiting thread */
+	g_mutex_lock (&batch->mutex);
+	if (--batch->pending == 0)
+		g_cond_signal (&batch->cond);
+	g_mutex_unlock (&batch->mutex);
+	g_slice_free (GsPluginLoaderRefineItem, item);
+}
+
+/* runs gs_plugin_refine_app() on each app using the shared refine pool,
+ * returning only when every app has been refined */
+static gboolean
+gs_plugin_loader_run_refine_app_parallel (GsPluginLoaderHelper *helper,
+					  GsPlugin *plugin,
+					  GsAppList *list,
+					  GCancellable *cancellable,
+					  GError **error)
+{
+	GsPluginLoaderPrivate *priv = gs_plugin_loader_get_instance_private (helper->plugin_loader);
+	GsPluginLoaderRefineBatch batch = { helper, plugin, cancellable };
+
+	g_mutex_init (&batch.mutex);
+	g_cond_init (&batch.cond);
+	g_mutex_lock (&batch.mutex);
+	for (guint i = 0; i < gs_app_list_length (list); i++) {
+		GsApp *app = gs_app_list_index (list, i);
+		GsPluginLoaderRefineItem *item;
+		if (gs_app_has_quirk (app, AS_APP_QUIRK_MATCH_ANY_PREFIX))
+			continue;
+		item = g_slice_new0 (GsPluginLoaderRefineItem);
+		item->batch = &batch;
+		item->app = app;
+		batch.pending++;
+		g_thread_pool_push (priv->refine_pool, item, NULL);
+	}
+
+	/* wait for all the queued apps to finish */
+	while (batch.pending > 0)
+		g_cond_wait (&batch.cond, &batch.mutex);
+	g_mutex_unlock (&batch.mutex);
+	g_cond_clear (&batch.cond);
+	g_mutex_clear (&batch.mutex);
+	if (batch.error != NULL) {
+		g_propagate_error (error, batch.error);
+		return FALSE;
+	}
 	return TRUE;
 }
 
+static gboolean
+gs_plugin_loader_run_refine_plugin (GsPluginLoaderHelper *helper,
+				    GsPlugin *plugin,
+				    gpointer user_data,
+				    GCancellable *cancellable,
+				    GError **error)
+{
+	GsAppList *list = GS_APP_LIST (user_data);
+	gboolean ret = TRUE;
+	g_autoptr(GsAppList) app_list = NULL;
+
+	gs_plugin_loader_action_start (helper->plugin_loader, plugin, FALSE);
+
+	/* run the batched plugin symbol then the per-app plugin */
+	if (!gs_plugin_loader_call_vfunc_locked (helper, plugin,
+						 GS_PLUGIN_VFUNC_REFINE,
+						 NULL, list,
+						 cancellable, error)) {
+		ret = FALSE;
+		goto out;
+	}
+
+	/* no per-app vfuncs, so avoid copying the list */
+	if (gs_plugin_get_vfunc (plugin, GS_PLUGIN_VFUNC_REFINE_APP) == NULL &&
+	    gs_plugin_get_vfunc (plugin, GS_PLUGIN_VFUNC_REFINE_WILDCARD) == NULL)
+		goto out;
+
+	/* use a copy of the list for the loop because a function called
+	 * on the plugin may affect the list which can lead to problems
+	 * (e.g. inserting an app in the list on every call results in
+	 * an infinite loop) */
+	app_list = gs_app_list_copy (list);
+	if (gs_plugin_has_flags (plugin, GS_PLUGIN_FLAGS_PARALLEL_REFINE) &&
+	    gs_app_list_length (app_list) > 1) {
+		/* the wildcards may add to the list, so do them first */
+		for (guint j = 0; j < gs_app_list_length (app_list); j++) {
+			GsApp *app = gs_app_list_index (app_list, j);
+			if (!gs_app_has_quirk (app, AS_APP_QUIRK_MATCH_ANY_PREFIX))
+				continue;
+			if (!gs_plugin_loader_call_vfunc_locked (helper, plugin,
+								 GS_PLUGIN_VFUNC_REFINE_WILDCARD,
+								 app, NULL,
+								 cancellable, error)) {
+				ret = FALSE;
+				goto out;
+			}
+		}
+		if (!gs_plugin_loader_run_refine_app_parallel (helper, plugin,
+							       app_list,
+							       cancellable,
+							       error)) {
+			ret = FALSE;
+			goto out;
+		}
+	} else {
+		for (guint j = 0; j < gs_app_list_length (app_list); j++) {
+			GsApp *app = gs_app_list_index (app_list, j);
+			GsPluginVfunc vfunc = GS_PLUGIN_VFUNC_REFINE_APP;
+			if (gs_app_has_quirk (app, AS_APP_QUIRK_MATCH_ANY_PREFIX))
+				vfunc = GS_PLUGIN_VFUNC_REFINE_WILDCARD;
+			if (!gs_plugin_loader_call_vfunc_locked (helper, plugin, vfunc,
+								 app, NULL,
+								 cancellable, error)) {
+				ret = FALSE;
+				goto out;
+			}
+		}
+	}
+out:
+	gs_plugin_loader_action_stop (helper->plugin_loader, plugin);
+	if (ret)
+		gs_plugin_status_update (plugin, NULL, GS_PLUGIN_STATUS_FINISHED);
+	return ret;
+}
+
+/* plugins that can add or remove apps from the shared list must not run at
+ * the same time as any other plugin */
+static gboolean
+gs_plugin_loader_refine_is_exclusive (GsPlugin *plugin, gpointer user_data)
+{
+	GsAppList *list = GS_APP_LIST (user_data);
+	if (gs_plugin_get_vfunc (plugin, GS_PLUGIN_VFUNC_REFINE) != NULL)
+		return TRUE;
+	if (gs_plugin_get_vfunc (plugin, GS_PLUGIN_VFUNC_REFINE_WILDCARD) == NULL)
+		return FALSE;
+	for (guint i = 0; i < gs_app_list_length (list); i++) {
+		GsApp *app = gs_app_list_index (list, i);
+		if (gs_app_has_quirk (app, AS_APP_QUIRK_MATCH_ANY_PREFIX))
+			return TRUE;
+	}
+	return FALSE;
+}
+
 static gboolean
 gs_plugin_loader_run_refine_internal (GsPluginLoaderHelper *helper,
 				      GsAppList *list,
@@ -775,43 +1631,59 @@ gs_plugin_loader_run_refine_internal (GsPluginLoaderHelper *helper,
 	GPtrArray *addons;
 	GPtrArray *related;
 	GsApp *app;
+	GsPluginRefineFlags refine_flags;
+	GsPluginRefineFlags refine_flags_missing = 0;
+	guint refine_serial;
+	gboolean has_wildcard = FALSE;
+	g_autoptr(GPtrArray) plugins = g_ptr_array_new ();
+	g_autoptr(GsAppList) list_todo = gs_app_list_new ();
 
 	/* try to adopt each application with a plugin */
 	gs_plugin_loader_run_adopt (helper->plugin_loader, list);
 
-	/* run each plugin */
-	for (i = 0; i < priv->plugins->len; i++) {
-		g_autoptr(AsProfileTask) ptask = NULL;
-		GsPlugin *plugin = g_ptr_array_index (priv->plugins, i);
-		g_autoptr(GsAppList) app_list = NULL;
+	/* only refine the apps that are missing some of the requested
+	 * flags, where the done bit means a refine has happened at all */
+	refine_flags = gs_plugin_job_get_refine_flags (helper->plugin_job);
+	refine_serial = (guint) g_atomic_int_get (&priv->refine_serial);
+	for (i = 0; i < gs_app_list_length (list); i++) {
+		GsPluginRefineFlags missing;
+		app = gs_app_list_index (list, i);
+		missing = (refine_flags | GS_PLUGIN_LOADER_REFINE_FLAGS_DONE) &
+			  ~gs_app_get_refined_flags (app, refine_serial);
+		if (gs_app_has_quirk (app, AS_APP_QUIRK_MATCH_ANY_PREFIX))
+			has_wildcard = TRUE;
+		else if (missing == 0)
+			continue;
+		refine_flags_missing |= missing;
+		gs_app_list_add (list_todo, app);
+	}
+	if (gs_app_list_length (list_todo) == 0)
+		return TRUE;
 
-		/* run the batched plugin symbol then the per-app plugin */
-		helper->function_name = "gs_plugin_refine";
-		if (!gs_plugin_loader_call_vfunc (helper, plugin, NULL, list,
-						  cancellable, error)) {
-			return FALSE;
-		}
+	/* wildcards add the apps they resolve to into the caller list */
+	if (has_wildcard) {
+		g_object_unref (list_todo);
+		list_todo = g_object_ref (list);
+	}
 
-		/* use a copy of the list for the loop because a function called
-		 * on the plugin may affect the list which can lead to problems
-		 * (e.g. inserting an app in the list on every call results in
-		 * an infinite loop) */
-		app_list = gs_app_list_copy (list);
-		for (j = 0; j < gs_app_list_length (app_list); j++) {
-			app = gs_app_list_index (app_list, j);
-			if (!gs_app_has_quirk (app, AS_APP_QUIRK_MATCH_ANY_PREFIX)) {
-				helper->function_name = "gs_plugin_refine_app";
-			} else {
-				helper->function_name = "gs_plugin_refine_wildcard";
-			}
-			if (!gs_plugin_loader_call_vfunc (helper, plugin, app, NULL,
-							  cancellable, error)) {
-				return FALSE;
-			}
-		}
-		gs_plugin_status_update (plugin, NULL, GS_PLUGIN_STATUS_FINISHED);
+	/* only run plugins that handle any of the missing flags */
+	for (i = 0; i < priv->plugins_for_action[GS_PLUGIN_ACTION_REFINE]->len; i++) {
+		GsPlugin *plugin = g_ptr_array_index (priv->plugins_for_action[GS_PLUGIN_ACTION_REFINE], i);
+		GsPluginRefineFlags plugin_flags = gs_plugin_get_refine_flags (plugin);
+		if (plugin_flags != 0 && (plugin_flags & refine_flags_missing) == 0)
+			continue;
+		g_ptr_array_add (plugins, plugin);
 	}
 
+	/* run each plugin that implements any of the refine vfuncs */
+	if (!gs_plugin_loader_run_dag (helper, plugins,
+				       gs_plugin_loader_run_refine_plugin,
+				       gs_plugin_loader_refine_is_exclusive,
+				       TRUE, list_todo, cancellable, error))
+		return FALSE;
+
+	list = list_todo;
+
 	/* ensure these are sorted by score */
 	if (gs_plugin_job_has_refine_flags (helper->plugin_job,
 						GS_PLUGIN_REFINE_FLAGS_REQUIRE_REVIEWS)) {
@@ -824,50 +1696,74 @@ gs_plugin_loader_run_refine_internal (GsPluginLoaderHelper *helper,
 		}
 	}
 
-	/* refine addons one layer deep */
+	/* refine addons, runtimes and related apps one layer deep in a
+	 * single extra pass so the plugins can batch their lookups */
 	if (gs_plugin_job_has_refine_flags (helper->plugin_job,
-						GS_PLUGIN_REFINE_FLAGS_REQUIRE_ADDONS)) {
-		g_autoptr(GsAppList) addons_list = NULL;
-		gs_plugin_job_remove_refine_flags (helper->plugin_job,
-						   GS_PLUGIN_REFINE_FLAGS_REQUIRE_ADDONS |
-						   GS_PLUGIN_REFINE_FLAGS_REQUIRE_REVIEWS |
-						   GS_PLUGIN_REFINE_FLAGS_REQUIRE_REVIEW_RATINGS);
-		addons_list = gs_app_list_new ();
-		for (i = 0; i < gs_app_list_length (list); i++) {
-			app = gs_app_list_index (list, i);
-			addons = gs_app_get_addons (app);
-			for (j = 0; j < addons->len; j++) {
-				GsApp *addon = g_ptr_array_index (addons, j);
-				g_debug ("refining app %s addon %s",
-					 gs_app_get_id (app),
-					 gs_app_get_id (addon));
-				gs_app_list_add (addons_list, addon);
-			}
+					    GS_PLUGIN_REFINE_FLAGS_REQUIRE_ADDONS |
+					    GS_PLUGIN_REFINE_FLAGS_REQUIRE_RUNTIME |
+					    GS_PLUGIN_REFINE_FLAGS_REQUIRE_RELATED)) {
+		gboolean do_addons;
+		gboolean do_runtime;
+		gboolean do_related;
+		g_autoptr(GHashTable) seen = g_hash_table_new (g_direct_hash, g_direct_equal);
+		g_autoptr(GsAppList) list_secondary = gs_app_list_new ();
+
+		do_addons = gs_plugin_job_has_refine_flags (helper->plugin_job,
+							    GS_PLUGIN_REFINE_FLAGS_REQUIRE_ADDONS);
+		do_runtime = gs_plugin_job_has_refine_flags (helper->plugin_job,
+							     GS_PLUGIN_REFINE_FLAGS_REQUIRE_RUNTIME);
+		do_related = gs_plugin_job_has_refine_flags (helper->plugin_job,
+							     GS_PLUGIN_REFINE_FLAGS_REQUIRE_RELATED);
+		if (do_addons) {
+			gs_plugin_job_remove_refine_flags (helper->plugin_job,
+							   GS_PLUGIN_REFINE_FLAGS_REQUIRE_ADDONS |
+							   GS_PLUGIN_REFINE_FLAGS_REQUIRE_REVIEWS |
+							   GS_PLUGIN_REFINE_FLAGS_REQUIRE_REVIEW_RATINGS);
 		}
-		if (gs_app_list_length (addons_list) > 0) {
-			if (!gs_plugin_loader_run_refine_internal (helper,
-								   addons_list,
-								   cancellable,
-								   error)) {
-				return FALSE;
-			}
+		if (do_related) {
+			gs_plugin_job_remove_refine_flags (helper->plugin_job,
+							   GS_PLUGIN_REFINE_FLAGS_REQUIRE_RELATED);
 		}
-	}
 
-	/* also do runtime */
-	if (gs_plugin_job_has_refine_flags (helper->plugin_job,
-						GS_PLUGIN_REFINE_FLAGS_REQUIRE_RUNTIME)) {
-		g_autoptr(GsAppList) list2 = gs_app_list_new ();
+		/* the primary apps have already been refined */
+		for (i = 0; i < gs_app_list_length (list); i++)
+			g_hash_table_add (seen, gs_app_list_index (list, i));
+
 		for (i = 0; i < gs_app_list_length (list); i++) {
-			GsApp *runtime;
 			app = gs_app_list_index (list, i);
-			runtime = gs_app_get_runtime (app);
-			if (runtime != NULL)
-				gs_app_list_add (list2, runtime);
+			if (do_addons) {
+				addons = gs_app_get_addons (app);
+				for (j = 0; j < addons->len; j++) {
+					GsApp *addon = g_ptr_array_index (addons, j);
+					if (!g_hash_table_add (seen, addon))
+						continue;
+					g_debug ("refining app %s addon %s",
+						 gs_app_get_id (app),
+						 gs_app_get_id (addon));
+					gs_app_list_add (list_secondary, addon);
+				}
+			}
+			if (do_runtime) {
+				GsApp *runtime = gs_app_get_runtime (app);
+				if (runtime != NULL && g_hash_table_add (seen, runtime))
+					gs_app_list_add (list_secondary, runtime);
+			}
+			if (do_related) {
+				related = gs_app_get_related (app);
+				for (j = 0; j < related->len; j++) {
+					GsApp *app_tmp = g_ptr_array_index (related, j);
+					if (!g_hash_table_add (seen, app_tmp))
+						continue;
+					g_debug ("refining related: %s[%s]",
+						 gs_app_get_id (app_tmp),
+						 gs_app_get_source_default (app_tmp));
+					gs_app_list_add (list_secondary, app_tmp);
+				}
+			}
 		}
-		if (gs_app_list_length (list2) > 0) {
+		if (gs_app_list_length (list_secondary) > 0) {
 			if (!gs_plugin_loader_run_refine_internal (helper,
-								   list2,
+								   list_secondary,
 								   cancellable,
 								   error)) {
 				return FALSE;
@@ -875,31 +1771,16 @@ gs_plugin_loader_run_refine_internal (GsPluginLoaderHelper *helper,
 		}
 	}
 
-	/* also do related packages one layer deep */
-	if (gs_plugin_job_has_refine_flags (helper->plugin_job,
-						GS_PLUGIN_REFINE_FLAGS_REQUIRE_RELATED)) {
-		g_autoptr(GsAppList) related_list = NULL;
-		gs_plugin_job_remove_refine_flags (helper->plugin_job,
-						   GS_PLUGIN_REFINE_FLAGS_REQUIRE_RELATED);
-		related_list = gs_app_list_new ();
+	/* every plugin has now had a chance to add the data; failures are
+	 * not recorded so the next refine can try again */
+	if (!g_atomic_int_get (&helper->anything_failed)) {
 		for (i = 0; i < gs_app_list_length (list); i++) {
 			app = gs_app_list_index (list, i);
-			related = gs_app_get_related (app);
-			for (j = 0; j < related->len; j++) {
-				app = g_ptr_array_index (related, j);
-				g_debug ("refining related: %s[%s]",
-					 gs_app_get_id (app),
-					 gs_app_get_source_default (app));
-				gs_app_list_add (related_list, app);
-			}
-		}
-		if (gs_app_list_length (related_list) > 0) {
-			if (!gs_plugin_loader_run_refine_internal (helper,
-								   related_list,
-								   cancellable,
-								   error)) {
-				return FALSE;
-			}
+			if (gs_app_has_quirk (app, AS_APP_QUIRK_MATCH_ANY_PREFIX))
+				continue;
+			gs_app_add_refined_flags (app,
+						  refine_flags | GS_PLUGIN_LOADER_REFINE_FLAGS_DONE,
+						  refine_serial);
 		}
 	}
 
@@ -935,9 +1816,10 @@ gs_plugin_loader_run_refine (GsPluginLoaderHelper *helper,
 					 "list", list,
 					 "refine-flags", gs_plugin_job_get_refine_flags (helper->plugin_job),
 					 "failure-flags", gs_plugin_job_get_failure_flags (helper->plugin_job),
+					 "priority", gs_plugin_job_get_priority (helper->plugin_job),
 					 NULL);
 	helper2 = gs_plugin_loader_helper_new (helper->plugin_loader, plugin_job);
-	helper2->function_name_parent = helper->function_name;
+	helper2->function_name_parent = gs_plugin_vfunc_to_string (helper->vfunc);
 	ret = gs_plugin_loader_run_refine_internal (helper2, list, cancellable, error);
 	if (!ret)
 		goto out;
@@ -1043,12 +1925,190 @@ gs_plugin_loader_job_sorted_truncation (GsPluginLoaderHelper *helper)
 		g_debug ("no ->sort_func() set for %s, using random!",
 			 gs_plugin_action_to_string (action));
 		gs_app_list_randomize (list);
-	} else {
-		gpointer sort_func_data;
-		sort_func_data = gs_plugin_job_get_sort_func_data (helper->plugin_job);
-		gs_app_list_sort (list, sort_func, sort_func_data);
 	}
-	gs_app_list_truncate (list, max_results);
+
+	/* only the kept apps get refined, the rest are used if any of those
+	 * are filtered out later */
+	helper->list_backfill = gs_app_list_truncate_sorted (list, max_results, sort_func,
+							     gs_plugin_job_get_sort_func_data (helper->plugin_job));
+}
+
+/* actions where the plugins only append to a thread-safe #GsAppList */
+static gboolean
+gs_plugin_loader_action_is_concurrent (GsPluginAction action)
+{
+	switch (action) {
+	case GS_PLUGIN_ACTION_GET_UPDATES:
+	case GS_PLUGIN_ACTION_GET_UPDATES_HISTORICAL:
+	case GS_PLUGIN_ACTION_GET_DISTRO_UPDATES:
+	case GS_PLUGIN_ACTION_GET_UNVOTED_REVIEWS:
+	case GS_PLUGIN_ACTION_GET_SOURCES:
+	case GS_PLUGIN_ACTION_GET_INSTALLED:
+	case GS_PLUGIN_ACTION_GET_POPULAR:
+	case GS_PLUGIN_ACTION_GET_FEATURED:
+	case GS_PLUGIN_ACTION_GET_RECENT:
+	case GS_PLUGIN_ACTION_GET_CATEGORY_APPS:
+	case GS_PLUGIN_ACTION_SEARCH:
+	case GS_PLUGIN_ACTION_SEARCH_FILES:
+	case GS_PLUGIN_ACTION_SEARCH_PROVIDES:
+		return TRUE;
+	default:
+		break;
+	}
+	return FALSE;
+}
+
+static void gs_plugin_loader_job_filter_results (GsPluginLoaderHelper *helper,
+						 GsAppList *list);
+
+typedef struct {
+	GsPluginLoaderHelper	*helper;
+	GsAppList		*list;
+} GsPluginLoaderPartial;
+
+static void
+gs_plugin_loader_partial_free (GsPluginLoaderPartial *partial)
+{
+	gs_plugin_loader_helper_unref (partial->helper);
+	g_object_unref (partial->list);
+	g_slice_free (GsPluginLoaderPartial, partial);
+}
+
+static gboolean
+gs_plugin_loader_helper_get_results_done (GsPluginLoaderHelper *helper)
+{
+	g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&helper->results_mutex);
+	return helper->results_done;
+}
+
+static gboolean
+gs_plugin_loader_partial_cb (gpointer user_data)
+{
+	GsPluginLoaderPartial *partial = (GsPluginLoaderPartial *) user_data;
+	GsPluginLoaderHelper *helper = partial->helper;
+	GsPluginJobPartialFunc partial_func;
+
+	/* the caller is no longer interested */
+	if (g_cancellable_is_cancelled (helper->cancellable))
+		return G_SOURCE_REMOVE;
+
+	/* the final results include these, and may already have been
+	 * returned to the caller */
+	if (gs_plugin_loader_helper_get_results_done (helper))
+		return G_SOURCE_REMOVE;
+
+	partial_func = gs_plugin_job_get_partial_func (helper->plugin_job);
+	partial_func (helper->plugin_job, partial->list,
+		      gs_plugin_job_get_partial_func_data (helper->plugin_job));
+	return G_SOURCE_REMOVE;
+}
+
+/* refine and filter the results of one plugin, and send them to the caller */
+static void
+gs_plugin_loader_job_partial_refine (GsPluginLoaderHelper *helper,
+				     GsAppList *list,
+				     GCancellable *cancellable)
+{
+	GsPluginLoaderPartial *partial;
+	g_autoptr(GError) error_local = NULL;
+	g_autoptr(GsAppList) list_partial = NULL;
+
+	if (gs_plugin_loader_helper_get_results_done (helper))
+		return;
+	if (gs_plugin_job_get_refine_flags (helper->plugin_job) != 0) {
+		if (!gs_plugin_loader_run_refine (helper, list, cancellable, &error_local)) {
+			g_debug ("failed to refine partial results: %s",
+				 error_local->message);
+			return;
+		}
+	}
+	list_partial = gs_app_list_copy (list);
+	gs_plugin_loader_job_filter_results (helper, list_partial);
+	if (gs_app_list_length (list_partial) == 0)
+		return;
+
+	partial = g_slice_new0 (GsPluginLoaderPartial);
+	partial->helper = gs_plugin_loader_helper_ref (helper);
+	partial->list = g_steal_pointer (&list_partial);
+	g_main_context_invoke_full (helper->context,
+				    G_PRIORITY_DEFAULT,
+				    gs_plugin_loader_partial_cb,
+				    partial,
+				    (GDestroyNotify) gs_plugin_loader_partial_free);
+}
+
+static void
+gs_plugin_loader_job_partial_thread_cb (GTask *task,
+					gpointer object,
+					gpointer task_data,
+					GCancellable *cancellable)
+{
+	GsPluginLoaderPartial *partial = (GsPluginLoaderPartial *) task_data;
+	gs_plugin_loader_job_partial_refine (partial->helper, partial->list, cancellable);
+	g_task_return_boolean (task, TRUE);
+}
+
+/* the refine happens in another thread so the plugins that run after this
+ * one in the DAG are not held up */
+static void
+gs_plugin_loader_job_partial (GsPluginLoaderHelper *helper, GsAppList *list)
+{
+	GsPluginLoaderPartial *partial;
+	g_autoptr(GTask) task = NULL;
+
+	if (gs_app_list_length (list) == 0)
+		return;
+	if (gs_plugin_loader_helper_get_results_done (helper))
+		return;
+
+	/* a copy, as refining can add apps to the list */
+	partial = g_slice_new0 (GsPluginLoaderPartial);
+	partial->helper = gs_plugin_loader_helper_ref (helper);
+	partial->list = gs_app_list_copy (list);
+	task = g_task_new (helper->plugin_loader, helper->cancellable, NULL, NULL);
+	g_task_set_task_data (task, partial, (GDestroyNotify) gs_plugin_loader_partial_free);
+	g_task_run_in_thread (task, gs_plugin_loader_job_partial_thread_cb);
+}
+
+static gboolean
+gs_plugin_loader_run_results_plugin (GsPluginLoaderHelper *helper,
+				     GsPlugin *plugin,
+				     gpointer user_data,
+				     GCancellable *cancellable,
+				     GError **error)
+{
+	gboolean ret;
+	g_autoptr(GsAppList) list = NULL;
+
+	if (g_cancellable_set_error_if_cancelled (cancellable, error)) {
+		gs_utils_error_convert_gio (error);
+		return FALSE;
+	}
+
+	/* keep the results of each plugin apart so they can be streamed, or
+	 * dropped if the plugin finishes after the job has returned */
+	list = gs_app_list_new ();
+
+	gs_plugin_loader_action_start (helper->plugin_loader, plugin, FALSE);
+	ret = gs_plugin_loader_call_vfunc_locked (helper, plugin, helper->vfunc,
+						  NULL, list, cancellable, error);
+	gs_plugin_loader_action_stop (helper->plugin_loader, plugin);
+	if (!ret)
+		return FALSE;
+	gs_plugin_status_update (plugin, NULL, GS_PLUGIN_STATUS_FINISHED);
+
+	if (helper->context != NULL)
+		gs_plugin_loader_job_partial (helper, list);
+	g_mutex_lock (&helper->results_mutex);
+	if (!helper->results_done) {
+		g_hash_table_insert (helper->results, plugin, g_object_ref (list));
+	} else if (gs_app_list_length (list) > 0) {
+		g_debug ("ignoring %u late results from %s",
+			 gs_app_list_length (list),
+			 gs_plugin_get_name (plugin));
+	}
+	g_mutex_unlock (&helper->results_mutex);
+	return TRUE;
 }
 
 static gboolean
@@ -1057,16 +2117,40 @@ gs_plugin_loader_run_results (GsPluginLoaderHelper *helper,
 			      GError **error)
 {
 	GsPluginLoaderPrivate *priv = gs_plugin_loader_get_instance_private (helper->plugin_loader);
+	GsPluginAction action = gs_plugin_job_get_action (helper->plugin_job);
+	GPtrArray *plugins = priv->plugins_for_action[action];
 	g_autoptr(AsProfileTask) ptask = NULL;
 
 	/* profile */
 	ptask = as_profile_start (priv->profile, "GsPlugin::*(%s)",
-				  helper->function_name);
+				  gs_plugin_vfunc_to_string (helper->vfunc));
 	g_assert (ptask != NULL);
 
-	/* run each plugin */
-	for (guint i = 0; i < priv->plugins->len; i++) {
-		GsPlugin *plugin = g_ptr_array_index (priv->plugins, i);
+	/* run unrelated plugins at the same time */
+	if (gs_plugin_loader_action_is_concurrent (action)) {
+		gboolean ret = gs_plugin_loader_run_dag (helper, plugins,
+							 gs_plugin_loader_run_results_plugin,
+							 NULL, FALSE, NULL,
+							 cancellable, error);
+
+		/* merge in plugin order so the duplicates kept do not depend
+		 * on which plugin finished first */
+		g_mutex_lock (&helper->results_mutex);
+		helper->results_done = TRUE;
+		for (guint i = 0; i < plugins->len; i++) {
+			GsAppList *list = g_hash_table_lookup (helper->results,
+							       g_ptr_array_index (plugins, i));
+			if (list != NULL)
+				gs_app_list_add_list (gs_plugin_job_get_list (helper->plugin_job), list);
+		}
+		g_hash_table_remove_all (helper->results);
+		g_mutex_unlock (&helper->results_mutex);
+		return ret;
+	}
+
+	/* run each plugin that implements the action */
+	for (guint i = 0; i < plugins->len; i++) {
+		GsPlugin *plugin = g_ptr_array_index (plugins, i);
 		if (g_cancellable_set_error_if_cancelled (cancellable, error)) {
 			gs_utils_error_convert_gio (error);
 			return FALSE;
@@ -1140,9 +2224,9 @@ gs_plugin_loader_app_is_valid_installed (GsApp *app, gpointer user_data)
 	case AS_APP_KIND_OS_UPGRADE:
 	case AS_APP_KIND_CODEC:
 	case AS_APP_KIND_FONT:
-		g_debug ("app invalid as %s: %s",
-			 as_app_kind_to_string (gs_app_get_kind (app)),
-			 gs_plugin_loader_get_app_str (app));
+		gs_debug_lazy ("app invalid as %s: %s",
+			       as_app_kind_to_string (gs_app_get_kind (app)),
+			       gs_plugin_loader_get_app_str (app));
 		return FALSE;
 		break;
 	default:
@@ -1172,51 +2256,51 @@ gs_plugin_loader_app_is_valid (GsApp *app, gpointer user_data)
 
 	/* never show addons */
 	if (gs_app_get_kind (app) == AS_APP_KIND_ADDON) {
-		g_debug ("app invalid as addon %s",
-			 gs_plugin_loader_get_app_str (app));
+		gs_debug_lazy ("app invalid as addon %s",
+			       gs_plugin_loader_get_app_str (app));
 		return FALSE;
 	}
 
 	/* never show CLI apps */
 	if (gs_app_get_kind (app) == AS_APP_KIND_CONSOLE) {
-		g_debug ("app invalid as console %s",
-			 gs_plugin_loader_get_app_str (app));
+		gs_debug_lazy ("app invalid as console %s",
+			       gs_plugin_loader_get_app_str (app));
 		return FALSE;
 	}
 
 	/* don't show unknown state */
 	if (gs_app_get_state (app) == AS_APP_STATE_UNKNOWN) {
-		g_debug ("app invalid as state unknown %s",
-			 gs_plugin_loader_get_app_str (app));
+		gs_debug_lazy ("app invalid as state unknown %s",
+			       gs_plugin_loader_get_app_str (app));
 		return FALSE;
 	}
 
 	/* don't show unconverted unavailables */
 	if (gs_app_get_kind (app) == AS_APP_KIND_UNKNOWN &&
 		gs_app_get_state (app) == AS_APP_STATE_UNAVAILABLE) {
-		g_debug ("app invalid as unconverted unavailable %s",
-			 gs_plugin_loader_get_app_str (app));
+		gs_debug_lazy ("app invalid as unconverted unavailable %s",
+			       gs_plugin_loader_get_app_str (app));
 		return FALSE;
 	}
 
 	/* don't show blacklisted apps */
 	if (gs_app_has_category (app, "Blacklisted")) {
-		g_debug ("app invalid as blacklisted %s",
-			 gs_plugin_loader_get_app_str (app));
+		gs_debug_lazy ("app invalid as blacklisted %s",
+			       gs_plugin_loader_get_app_str (app));
 		return FALSE;
 	}
 
 	/* don't show sources */
 	if (gs_app_get_kind (app) == AS_APP_KIND_SOURCE) {
-		g_debug ("app invalid as source %s",
-			 gs_plugin_loader_get_app_str (app));
+		gs_debug_lazy ("app invalid as source %s",
+			       gs_plugin_loader_get_app_str (app));
 		return FALSE;
 	}
 
 	/* don't show unknown kind */
 	if (gs_app_get_kind (app) == AS_APP_KIND_UNKNOWN) {
-		g_debug ("app invalid as kind unknown %s",
-			 gs_plugin_loader_get_app_str (app));
+		gs_debug_lazy ("app invalid as kind unknown %s",
+			       gs_plugin_loader_get_app_str (app));
 		return FALSE;
 	}
 
@@ -1232,19 +2316,19 @@ gs_plugin_loader_app_is_valid (GsApp *app, gpointer user_data)
 
 	/* don't show apps that do not have the required details */
 	if (gs_app_get_name (app) == NULL) {
-		g_debug ("app invalid as no name %s",
-			 gs_plugin_loader_get_app_str (app));
+		gs_debug_lazy ("app invalid as no name %s",
+			       gs_plugin_loader_get_app_str (app));
 		return FALSE;
 	}
 	if (gs_app_get_summary (app) == NULL) {
-		g_debug ("app invalid as no summary %s",
-			 gs_plugin_loader_get_app_str (app));
+		gs_debug_lazy ("app invalid as no summary %s",
+			       gs_plugin_loader_get_app_str (app));
 		return FALSE;
 	}
 	if (gs_app_get_kind (app) == AS_APP_KIND_DESKTOP &&
 	    gs_app_get_pixbuf (app) == NULL) {
-		g_debug ("app invalid as no pixbuf %s",
-			 gs_plugin_loader_get_app_str (app));
+		gs_debug_lazy ("app invalid as no pixbuf %s",
+			       gs_plugin_loader_get_app_str (app));
 		return FALSE;
 	}
 	return TRUE;
@@ -1267,23 +2351,23 @@ gs_plugin_loader_filter_qt_for_gtk (GsApp *app, gpointer user_data)
 	    g_strcmp0 (gs_app_get_id (app), "gimagereader-qt5.desktop") == 0 ||
 	    g_strcmp0 (gs_app_get_id (app), "nntpgrab_server_qt.desktop") == 0 ||
 	    g_strcmp0 (gs_app_get_id (app), "hotot-qt.desktop") == 0) {
-		g_debug ("removing QT version of %s",
-			 gs_plugin_loader_get_app_str (app));
+		gs_debug_lazy ("removing QT version of %s",
+			       gs_plugin_loader_get_app_str (app));
 		return FALSE;
 	}
 
 	/* hide the KDE version in preference to the GTK one */
 	if (g_strcmp0 (gs_app_get_id (app), "qalculate_kde.desktop") == 0) {
-		g_debug ("removing KDE version of %s",
-			 gs_plugin_loader_get_app_str (app));
+		gs_debug_lazy ("removing KDE version of %s",
+			       gs_plugin_loader_get_app_str (app));
 		return FALSE;
 	}
 
 	/* hide the KDE version in preference to the Qt one */
 	if (g_strcmp0 (gs_app_get_id (app), "kid3.desktop") == 0 ||
 	    g_strcmp0 (gs_app_get_id (app), "kchmviewer.desktop") == 0) {
-		g_debug ("removing KDE version of %s",
-			 gs_plugin_loader_get_app_str (app));
+		gs_debug_lazy ("removing KDE version of %s",
+			       gs_plugin_loader_get_app_str (app));
 		return FALSE;
 	}
 	return TRUE;
@@ -1510,68 +2594,309 @@ gs_plugin_loader_fix_category_all (GsCategory *category)
 		return;
 	gs_category_set_size (cat_all, gs_category_get_size (category));
 
-	/* add the desktop groups from all children */
-	children = gs_category_get_children (category);
-	for (i = 0; i < children->len; i++) {
-		GPtrArray *desktop_groups;
-		GsCategory *child;
+	/* add the desktop groups from all children */
+	children = gs_category_get_children (category);
+	for (i = 0; i < children->len; i++) {
+		GPtrArray *desktop_groups;
+		GsCategory *child;
+
+		/* ignore the all category */
+		child = g_ptr_array_index (children, i);
+		if (g_strcmp0 (gs_category_get_id (child), "all") == 0)
+			continue;
+
+		/* add all desktop groups */
+		desktop_groups = gs_category_get_desktop_groups (child);
+		for (j = 0; j < desktop_groups->len; j++) {
+			const gchar *tmp = g_ptr_array_index (desktop_groups, j);
+			gs_category_add_desktop_group (cat_all, tmp);
+		}
+	}
+}
+
+static void
+gs_plugin_loader_job_get_categories_thread_cb (GTask *task,
+					      gpointer object,
+					      gpointer task_data,
+					      GCancellable *cancellable)
+{
+	GError *error = NULL;
+	GsPluginLoaderHelper *helper = (GsPluginLoaderHelper *) task_data;
+
+	/* run each plugin */
+	if (!gs_plugin_loader_run_results (helper, cancellable, &error)) {
+		g_task_return_error (task, error);
+		return;
+	}
+
+	/* make sure 'All' has the right categories */
+	for (guint i = 0; i < helper->catlist->len; i++) {
+		GsCategory *cat = g_ptr_array_index (helper->catlist, i);
+		gs_plugin_loader_fix_category_all (cat);
+	}
+
+	/* sort by name */
+	g_ptr_array_sort (helper->catlist, gs_plugin_loader_category_sort_cb);
+	for (guint i = 0; i < helper->catlist->len; i++) {
+		GsCategory *cat = GS_CATEGORY (g_ptr_array_index (helper->catlist, i));
+		gs_category_sort_children (cat);
+	}
+
+	/* success */
+	if (helper->catlist->len == 0) {
+		g_task_return_new_error (task,
+					 GS_PLUGIN_ERROR,
+					 GS_PLUGIN_ERROR_NOT_SUPPORTED,
+					 "no categories to show");
+		return;
+	}
+
+	/* show elapsed time */
+	gs_plugin_loader_job_debug (helper);
+
+	/* success */
+	g_task_return_pointer (task, g_ptr_array_ref (helper->catlist), (GDestroyNotify) g_ptr_array_unref);
+}
+
+typedef struct {
+	GTask			*task;
+	GTaskThreadFunc		 func;
+	GsPluginAction		 action;
+	GsPluginJobPriority	 priority;
+	guint64			 seq;
+} GsPluginLoaderJobItem;
+
+static void
+gs_plugin_loader_job_item_free (GsPluginLoaderJobItem *item)
+{
+	g_object_unref (item->task);
+	g_slice_free (GsPluginLoaderJobItem, item);
+}
+
+/* completes a queued job that will never run */
+static void
+gs_plugin_loader_job_item_cancel (GsPluginLoaderJobItem *item)
+{
+	g_autoptr(GError) error = NULL;
+	g_set_error_literal (&error,
+			     G_IO_ERROR,
+			     G_IO_ERROR_CANCELLED,
+			     "the plugin loader is shutting down");
+	gs_utils_error_convert_gio (&error);
+	g_task_return_error (item->task, g_steal_pointer (&error));
+	gs_plugin_loader_job_item_free (item);
+}
+
+/* some actions are not safe, or not useful, to run more than once at a time */
+static guint
+gs_plugin_loader_action_get_max_jobs (GsPluginAction action)
+{
+	switch (action) {
+	case GS_PLUGIN_ACTION_REFRESH:
+	case GS_PLUGIN_ACTION_UPGRADE_DOWNLOAD:
+	case GS_PLUGIN_ACTION_UPGRADE_TRIGGER:
+		return 1;
+	default:
+		return 0;
+	}
+}
+
+static gint
+gs_plugin_loader_job_item_sort_cb (gconstpointer a, gconstpointer b, gpointer user_data)
+{
+	const GsPluginLoaderJobItem *item1 = a;
+	const GsPluginLoaderJobItem *item2 = b;
+
+	/* higher priority first, then in the order they were queued */
+	if (item1->priority > item2->priority)
+		return -1;
+	if (item1->priority < item2->priority)
+		return 1;
+	if (item1->seq < item2->seq)
+		return -1;
+	if (item1->seq > item2->seq)
+		return 1;
+	return 0;
+}
+
+/* called with job_mutex held */
+static gboolean
+gs_plugin_loader_job_item_can_run (GsPluginLoader *plugin_loader,
+				   GsPluginLoaderJobItem *item)
+{
+	GsPluginLoaderPrivate *priv = gs_plugin_loader_get_instance_private (plugin_loader);
+	guint max_jobs = gs_plugin_loader_action_get_max_jobs (item->action);
+
+	if (max_jobs > 0 && priv->jobs_running_for_action[item->action] >= max_jobs)
+		return FALSE;
+
+	/* always keep some threads free for the user */
+	if (item->priority == GS_PLUGIN_JOB_PRIORITY_BACKGROUND &&
+	    priv->jobs_running_background >= GS_PLUGIN_LOADER_JOBS_BACKGROUND_MAX)
+		return FALSE;
+	return TRUE;
+}
+
+/* reading procfs and walking the results is not free, so only do it
+ * when someone is going to look at the numbers */
+static gboolean
+gs_plugin_loader_memory_is_enabled (GsPluginLoader *plugin_loader)
+{
+	GsPluginLoaderPrivate *priv = gs_plugin_loader_get_instance_private (plugin_loader);
+	return g_atomic_int_get (&priv->profile_mode) ||
+	       gs_debug_is_enabled () ||
+	       gs_trace_is_enabled ();
+}
 
-		/* ignore the all category */
-		child = g_ptr_array_index (children, i);
-		if (g_strcmp0 (gs_category_get_id (child), "all") == 0)
-			continue;
+/* the high-water mark of the resident set size in kB, or 0 if unknown */
+static guint64
+gs_plugin_loader_get_rss_peak (void)
+{
+	g_autofree gchar *data = NULL;
+	const gchar *tmp;
 
-		/* add all desktop groups */
-		desktop_groups = gs_category_get_desktop_groups (child);
-		for (j = 0; j < desktop_groups->len; j++) {
-			const gchar *tmp = g_ptr_array_index (desktop_groups, j);
-			gs_category_add_desktop_group (cat_all, tmp);
-		}
-	}
+	if (!g_file_get_contents ("/proc/self/status", &data, NULL, NULL))
+		return 0;
+	tmp = g_strstr_len (data, -1, "VmHWM:");
+	if (tmp == NULL)
+		return 0;
+	return g_ascii_strtoull (tmp + 6, NULL, 10);
 }
 
+/* the peak RSS is for the whole process, so overlapping jobs share blame */
 static void
-gs_plugin_loader_job_get_categories_thread_cb (GTask *task,
-					      gpointer object,
-					      gpointer task_data,
-					      GCancellable *cancellable)
+gs_plugin_loader_job_memory_add (GsPluginLoader *plugin_loader,
+				 GsPluginLoaderHelper *helper,
+				 guint64 rss_peak_start)
 {
-	GError *error = NULL;
-	GsPluginLoaderHelper *helper = (GsPluginLoaderHelper *) task_data;
+	GsPluginLoaderPrivate *priv = gs_plugin_loader_get_instance_private (plugin_loader);
+	GsPluginAction action = gs_plugin_job_get_action (helper->plugin_job);
+	GsAppList *list = gs_plugin_job_get_list (helper->plugin_job);
+	GsPluginLoaderMemory *memory;
+	GHashTableIter iter;
+	gpointer key, value;
+	guint64 apps_created = 0;
+	guint64 bytes_held = 0;
+	guint64 rss_peak_delta = 0;
+	guint64 rss_peak_end = gs_plugin_loader_get_rss_peak ();
+	g_autoptr(GString) str = g_string_new (NULL);
+
+	if (rss_peak_start > 0 && rss_peak_end > rss_peak_start)
+		rss_peak_delta = rss_peak_end - rss_peak_start;
+	for (guint i = 0; list != NULL && i < gs_app_list_length (list); i++)
+		bytes_held += gs_app_get_memory_size (gs_app_list_index (list, i));
+	g_mutex_lock (&helper->results_mutex);
+	g_hash_table_iter_init (&iter, helper->apps_created);
+	while (g_hash_table_iter_next (&iter, &key, &value)) {
+		apps_created += GPOINTER_TO_UINT (value);
+		g_string_append_printf (str, "%s%s:%u", str->len > 0 ? ", " : "",
+					gs_plugin_get_name (GS_PLUGIN (key)),
+					GPOINTER_TO_UINT (value));
+	}
+	g_mutex_unlock (&helper->results_mutex);
+
+	gs_debug_lazy ("%s job created %" G_GUINT64_FORMAT " apps [%s], "
+		       "results hold %" G_GUINT64_FORMAT " kB, "
+		       "peak RSS grew %" G_GUINT64_FORMAT " kB",
+		       gs_plugin_action_to_string (action),
+		       apps_created, str->str, bytes_held / 1024,
+		       rss_peak_delta);
+
+	g_mutex_lock (&priv->stats_mutex);
+	memory = &priv->memory[action];
+	memory->jobs++;
+	memory->apps_created += apps_created;
+	memory->apps_created_max = MAX (memory->apps_created_max, apps_created);
+	memory->bytes_held_max = MAX (memory->bytes_held_max, bytes_held);
+	memory->rss_peak_delta_max = MAX (memory->rss_peak_delta_max, rss_peak_delta);
+	g_mutex_unlock (&priv->stats_mutex);
+}
 
-	/* run each plugin */
-	if (!gs_plugin_loader_run_results (helper, cancellable, &error)) {
-		g_task_return_error (task, error);
+static void
+gs_plugin_loader_job_pool_cb (gpointer data, gpointer user_data)
+{
+	GsPluginLoaderJobItem *item = (GsPluginLoaderJobItem *) data;
+	GsPluginLoader *plugin_loader = GS_PLUGIN_LOADER (user_data);
+	GsPluginLoaderPrivate *priv = gs_plugin_loader_get_instance_private (plugin_loader);
+	guint64 rss_peak = 0;
+	gboolean memory_enabled;
+
+	/* park the job until a job that is blocking it has finished */
+	g_mutex_lock (&priv->job_mutex);
+	if (priv->jobs_shutdown) {
+		g_mutex_unlock (&priv->job_mutex);
+		gs_plugin_loader_job_item_cancel (item);
 		return;
 	}
-
-	/* make sure 'All' has the right categories */
-	for (guint i = 0; i < helper->catlist->len; i++) {
-		GsCategory *cat = g_ptr_array_index (helper->catlist, i);
-		gs_plugin_loader_fix_category_all (cat);
-	}
-
-	/* sort by name */
-	g_ptr_array_sort (helper->catlist, gs_plugin_loader_category_sort_cb);
-	for (guint i = 0; i < helper->catlist->len; i++) {
-		GsCategory *cat = GS_CATEGORY (g_ptr_array_index (helper->catlist, i));
-		gs_category_sort_children (cat);
+	if (!gs_plugin_loader_job_item_can_run (plugin_loader, item)) {
+		g_debug ("deferring %s job", gs_plugin_action_to_string (item->action));
+		g_ptr_array_add (priv->jobs_deferred, item);
+		g_mutex_unlock (&priv->job_mutex);
+		return;
 	}
+	priv->jobs_running_for_action[item->action]++;
+	if (item->priority == GS_PLUGIN_JOB_PRIORITY_BACKGROUND)
+		priv->jobs_running_background++;
+	g_mutex_unlock (&priv->job_mutex);
+
+	memory_enabled = gs_plugin_loader_memory_is_enabled (plugin_loader);
+	if (memory_enabled)
+		rss_peak = gs_plugin_loader_get_rss_peak ();
+	item->func (item->task,
+		    g_task_get_source_object (item->task),
+		    g_task_get_task_data (item->task),
+		    g_task_get_cancellable (item->task));
+	if (memory_enabled) {
+		gs_plugin_loader_job_memory_add (plugin_loader,
+						 g_task_get_task_data (item->task),
+						 rss_peak);
+	}
+
+	/* requeue any parked jobs, the pool puts them back in order */
+	g_mutex_lock (&priv->job_mutex);
+	priv->jobs_running_for_action[item->action]--;
+	if (item->priority == GS_PLUGIN_JOB_PRIORITY_BACKGROUND)
+		priv->jobs_running_background--;
+	for (guint i = 0; i < priv->jobs_deferred->len; i++) {
+		g_thread_pool_push (priv->job_pool,
+				    g_ptr_array_index (priv->jobs_deferred, i),
+				    NULL);
+	}
+
+	/* the pool owns them again, so do not cancel them */
+	g_ptr_array_set_free_func (priv->jobs_deferred, NULL);
+	g_ptr_array_set_size (priv->jobs_deferred, 0);
+	g_ptr_array_set_free_func (priv->jobs_deferred,
+				   (GDestroyNotify) gs_plugin_loader_job_item_cancel);
+	g_mutex_unlock (&priv->job_mutex);
+
+	gs_plugin_loader_job_item_free (item);
+}
 
-	/* success */
-	if (helper->catlist->len == 0) {
-		g_task_return_new_error (task,
-					 GS_PLUGIN_ERROR,
-					 GS_PLUGIN_ERROR_NOT_SUPPORTED,
-					 "no categories to show");
+/* like g_task_run_in_thread(), but queued by priority on the loader pool */
+static void
+gs_plugin_loader_job_run_in_thread (GsPluginLoader *plugin_loader,
+				    GTask *task,
+				    GTaskThreadFunc func)
+{
+	GsPluginLoaderPrivate *priv = gs_plugin_loader_get_instance_private (plugin_loader);
+	GsPluginLoaderHelper *helper = g_task_get_task_data (task);
+	GsPluginLoaderJobItem *item = g_slice_new0 (GsPluginLoaderJobItem);
+
+	item->task = g_object_ref (task);
+	item->func = func;
+	item->action = gs_plugin_job_get_action (helper->plugin_job);
+	item->priority = gs_plugin_job_get_priority (helper->plugin_job);
+
+	g_mutex_lock (&priv->job_mutex);
+	if (priv->jobs_shutdown) {
+		g_mutex_unlock (&priv->job_mutex);
+		gs_plugin_loader_job_item_cancel (item);
 		return;
 	}
-
-	/* show elapsed time */
-	gs_plugin_loader_job_debug (helper);
-
-	/* success */
-	g_task_return_pointer (task, g_ptr_array_ref (helper->catlist), (GDestroyNotify) g_ptr_array_unref);
+	item->seq = priv->jobs_seq++;
+	g_thread_pool_push (priv->job_pool, item, NULL);
+	g_mutex_unlock (&priv->job_mutex);
 }
 
 /**
@@ -1600,8 +2925,9 @@ gs_plugin_loader_job_get_categories_async (GsPluginLoader *plugin_loader,
 
 	/* run in a thread */
 	task = g_task_new (plugin_loader, cancellable, callback, user_data);
-	g_task_set_task_data (task, helper, (GDestroyNotify) gs_plugin_loader_helper_free);
-	g_task_run_in_thread (task, gs_plugin_loader_job_get_categories_thread_cb);
+	g_task_set_task_data (task, helper, (GDestroyNotify) gs_plugin_loader_helper_unref);
+	gs_plugin_loader_job_run_in_thread (plugin_loader, task,
+					    gs_plugin_loader_job_get_categories_thread_cb);
 }
 
 /**
@@ -1628,7 +2954,9 @@ gs_plugin_loader_job_get_categories_finish (GsPluginLoader *plugin_loader,
 static gboolean
 emit_pending_apps_idle (gpointer loader)
 {
+	gint64 ts_trace = gs_trace_begin ();
 	g_signal_emit (loader, signals[SIGNAL_PENDING_APPS_CHANGED], 0);
+	gs_trace_end (ts_trace, "idle", G_STRFUNC, NULL);
 	g_object_unref (loader);
 
 	return G_SOURCE_REMOVE;
@@ -2080,6 +3408,10 @@ gs_plugin_loader_reload_cb (GsPlugin *plugin,
 			    GsPluginLoader *plugin_loader)
 {
 	GsPluginLoaderPrivate *priv = gs_plugin_loader_get_instance_private (plugin_loader);
+
+	/* invalidate the refine flags satisfied for every app */
+	g_atomic_int_inc (&priv->refine_serial);
+
 	if (priv->reload_id != 0)
 		return;
 	priv->reload_id =
@@ -2188,7 +3520,113 @@ gs_plugin_loader_plugin_sort_fn (gconstpointer a, gconstpointer b)
 		return -1;
 	if (gs_plugin_get_order (*pa) > gs_plugin_get_order (*pb))
 		return 1;
-	return 0;
+	return g_strcmp0 (gs_plugin_get_name (*pa), gs_plugin_get_name (*pb));
+}
+
+static gboolean
+gs_plugin_loader_plugin_implements_action (GsPlugin *plugin, GsPluginAction action)
+{
+	if (gs_plugin_get_vfunc (plugin, gs_plugin_action_to_vfunc (action)) != NULL)
+		return TRUE;
+
+	/* some actions are implemented by more than one vfunc */
+	switch (action) {
+	case GS_PLUGIN_ACTION_REFINE:
+		return gs_plugin_get_vfunc (plugin, GS_PLUGIN_VFUNC_REFINE_APP) != NULL ||
+		       gs_plugin_get_vfunc (plugin, GS_PLUGIN_VFUNC_REFINE_WILDCARD) != NULL;
+	case GS_PLUGIN_ACTION_UPDATE:
+		return gs_plugin_get_vfunc (plugin, GS_PLUGIN_VFUNC_UPDATE_APP) != NULL;
+	case GS_PLUGIN_ACTION_GET_UPDATES:
+		return gs_plugin_get_vfunc (plugin, GS_PLUGIN_VFUNC_ADD_UPDATES_PENDING) != NULL;
+	default:
+		break;
+	}
+	return FALSE;
+}
+
+static void
+gs_plugin_loader_add_plugin_preds (GsPluginLoader *plugin_loader,
+				   GsPlugin *plugin,
+				   GPtrArray *preds)
+{
+	GsPluginLoaderPrivate *priv = gs_plugin_loader_get_instance_private (plugin_loader);
+	GPtrArray *deps;
+	guint j;
+
+	/* plugins this one is ordered after */
+	deps = gs_plugin_get_rules (plugin, GS_PLUGIN_RULE_RUN_AFTER);
+	for (guint i = 0; i < deps->len; i++) {
+		const gchar *name = g_ptr_array_index (deps, i);
+		GsPlugin *dep = gs_plugin_loader_find_plugin (plugin_loader, name);
+		if (dep == NULL || !gs_plugin_get_enabled (dep))
+			continue;
+		if (gs_plugin_loader_array_has_plugin (preds, dep))
+			continue;
+		g_ptr_array_add (preds, dep);
+		gs_plugin_loader_add_plugin_preds (plugin_loader, dep, preds);
+	}
+
+	/* plugins that are ordered before this one */
+	for (guint i = 0; i < priv->plugins->len; i++) {
+		GsPlugin *dep = g_ptr_array_index (priv->plugins, i);
+		if (!gs_plugin_get_enabled (dep))
+			continue;
+		if (gs_plugin_loader_array_has_plugin (preds, dep))
+			continue;
+		deps = gs_plugin_get_rules (dep, GS_PLUGIN_RULE_RUN_BEFORE);
+		for (j = 0; j < deps->len; j++) {
+			const gchar *name = g_ptr_array_index (deps, j);
+			if (g_strcmp0 (name, gs_plugin_get_name (plugin)) == 0)
+				break;
+		}
+		if (j == deps->len)
+			continue;
+		g_ptr_array_add (preds, dep);
+		gs_plugin_loader_add_plugin_preds (plugin_loader, dep, preds);
+	}
+}
+
+/* build the transitive closure of the ordering rules so that plugins with
+ * no relationship can be run at the same time */
+static void
+gs_plugin_loader_build_dag (GsPluginLoader *plugin_loader)
+{
+	GsPluginLoaderPrivate *priv = gs_plugin_loader_get_instance_private (plugin_loader);
+
+	g_hash_table_remove_all (priv->plugin_preds);
+	for (guint i = 0; i < priv->plugins->len; i++) {
+		GsPlugin *plugin = g_ptr_array_index (priv->plugins, i);
+		g_autoptr(GPtrArray) preds = g_ptr_array_new ();
+		if (!gs_plugin_get_enabled (plugin))
+			continue;
+		gs_plugin_loader_add_plugin_preds (plugin_loader, plugin, preds);
+		g_ptr_array_remove (preds, plugin);
+		g_hash_table_insert (priv->plugin_preds,
+				     plugin, g_ptr_array_ref (preds));
+	}
+}
+
+/* build the per-action dispatch lists, which must be done each time the
+ * plugin order changes or plugins are disabled */
+static void
+gs_plugin_loader_rebuild_dispatch (GsPluginLoader *plugin_loader)
+{
+	GsPluginLoaderPrivate *priv = gs_plugin_loader_get_instance_private (plugin_loader);
+
+	for (guint j = 0; j < GS_PLUGIN_ACTION_LAST; j++)
+		g_ptr_array_set_size (priv->plugins_for_action[j], 0);
+	g_ptr_array_set_size (priv->plugins_for_adopt, 0);
+	for (guint i = 0; i < priv->plugins->len; i++) {
+		GsPlugin *plugin = g_ptr_array_index (priv->plugins, i);
+		if (!gs_plugin_get_enabled (plugin))
+			continue;
+		for (guint j = 0; j < GS_PLUGIN_ACTION_LAST; j++) {
+			if (gs_plugin_loader_plugin_implements_action (plugin, j))
+				g_ptr_array_add (priv->plugins_for_action[j], plugin);
+		}
+		if (gs_plugin_get_vfunc (plugin, GS_PLUGIN_VFUNC_ADOPT_APP) != NULL)
+			g_ptr_array_add (priv->plugins_for_adopt, plugin);
+	}
 }
 
 static void
@@ -2280,6 +3718,239 @@ gs_plugin_loader_setup_again (GsPluginLoader *plugin_loader)
 	}
 }
 
+/* a plugin failing to set up is disabled rather than failing the loader */
+static gboolean
+gs_plugin_loader_setup_plugin (GsPluginLoaderHelper *helper,
+			       GsPlugin *plugin,
+			       gpointer user_data,
+			       GCancellable *cancellable,
+			       GError **error)
+{
+	gboolean ret;
+	gint64 time_start = g_get_monotonic_time ();
+	g_autoptr(GError) error_local = NULL;
+
+	gs_plugin_loader_action_start (helper->plugin_loader, plugin, FALSE);
+	ret = gs_plugin_loader_call_vfunc_locked (helper, plugin, helper->vfunc,
+						  NULL, NULL, cancellable,
+						  &error_local);
+	gs_plugin_loader_action_stop (helper->plugin_loader, plugin);
+	gs_plugin_set_setup_time (plugin, (g_get_monotonic_time () - time_start) / 1000);
+	if (!ret) {
+		g_debug ("disabling %s as setup failed: %s",
+			 gs_plugin_get_name (plugin),
+			 error_local->message);
+		gs_plugin_set_enabled (plugin, FALSE);
+	}
+	return TRUE;
+}
+
+static gchar *
+gs_plugin_loader_snapshot_get_filename (GError **error)
+{
+	return gs_utils_get_cache_filename ("snapshot", "apps.gvariant",
+					    GS_UTILS_CACHE_FLAG_WRITEABLE,
+					    error);
+}
+
+static gboolean
+gs_plugin_loader_snapshot_save (GsPluginLoader *plugin_loader, GError **error)
+{
+	GsPluginLoaderPrivate *priv = gs_plugin_loader_get_instance_private (plugin_loader);
+	GVariantBuilder builder;
+	guint n_apps = 0;
+	g_autofree gchar *filename = NULL;
+	g_autoptr(GVariant) snapshot = NULL;
+
+	filename = gs_plugin_loader_snapshot_get_filename (error);
+	if (filename == NULL)
+		return FALSE;
+
+	/* only apps with enough details to be shown */
+	g_variant_builder_init (&builder, G_VARIANT_TYPE ("a" GS_APP_SNAPSHOT_TYPE));
+	for (guint i = 0; i < gs_app_list_length (priv->global_cache); i++) {
+		GsApp *app = gs_app_list_index (priv->global_cache, i);
+		GVariant *value = gs_app_to_snapshot (app);
+		if (value == NULL)
+			continue;
+		g_variant_builder_add_value (&builder, value);
+		n_apps++;
+	}
+	snapshot = g_variant_ref_sink (g_variant_new ("(us@a" GS_APP_SNAPSHOT_TYPE ")",
+						      (guint32) GS_PLUGIN_LOADER_SNAPSHOT_VERSION,
+						      priv->locale,
+						      g_variant_builder_end (&builder)));
+	g_debug ("saving %u apps to %s", n_apps, filename);
+	return g_file_set_contents (filename,
+				    g_variant_get_data (snapshot),
+				    (gssize) g_variant_get_size (snapshot),
+				    error);
+}
+
+/* adds the apps from the last session to the global cache so they can be
+ * shown before the plugins have finished loading their metadata */
+static void
+gs_plugin_loader_snapshot_load (GsPluginLoader *plugin_loader)
+{
+	GsPluginLoaderPrivate *priv = gs_plugin_loader_get_instance_private (plugin_loader);
+	GVariantIter iter;
+	guint32 version = 0;
+	const gchar *locale = NULL;
+	g_autofree gchar *filename = NULL;
+	g_autoptr(GBytes) bytes = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GMappedFile) mapped_file = NULL;
+	g_autoptr(GVariant) apps = NULL;
+	g_autoptr(GVariant) snapshot = NULL;
+
+	filename = gs_plugin_loader_snapshot_get_filename (&error);
+	if (filename == NULL) {
+		g_warning ("failed to get snapshot filename: %s", error->message);
+		return;
+	}
+	if (!g_file_test (filename, G_FILE_TEST_EXISTS))
+		return;
+	mapped_file = g_mapped_file_new (filename, FALSE, &error);
+	if (mapped_file == NULL) {
+		g_warning ("failed to load snapshot: %s", error->message);
+		return;
+	}
+
+	/* the data is checked as it is read */
+	bytes = g_mapped_file_get_bytes (mapped_file);
+	snapshot = g_variant_ref_sink (g_variant_new_from_bytes (G_VARIANT_TYPE (GS_PLUGIN_LOADER_SNAPSHOT_TYPE),
+								 bytes, FALSE));
+	g_variant_get_child (snapshot, 0, "u", &version);
+	g_variant_get_child (snapshot, 1, "&s", &locale);
+	if (version != GS_PLUGIN_LOADER_SNAPSHOT_VERSION ||
+	    g_strcmp0 (locale, priv->locale) != 0) {
+		g_debug ("ignoring snapshot with version %u and locale %s",
+			 version, locale);
+		return;
+	}
+
+	priv->snapshot = gs_app_list_new ();
+	apps = g_variant_get_child_value (snapshot, 2);
+	g_variant_iter_init (&iter, apps);
+	while (TRUE) {
+		const gchar *unique_id = NULL;
+		g_autoptr(GsApp) app = NULL;
+		g_autoptr(GVariant) value = g_variant_iter_next_value (&iter);
+
+		if (value == NULL)
+			break;
+
+		/* something already created it */
+		g_variant_get_child (value, 0, "&s", &unique_id);
+		if (gs_app_list_lookup (priv->global_cache, unique_id) != NULL)
+			continue;
+		app = gs_app_new_from_snapshot (value);
+		if (app == NULL)
+			continue;
+		gs_app_list_add (priv->global_cache, app);
+		gs_app_list_add (priv->snapshot, app);
+	}
+	g_debug ("loaded %u apps from %s",
+		 gs_app_list_length (priv->snapshot), filename);
+}
+
+static void
+gs_plugin_loader_snapshot_revalidate_cb (GObject *source,
+					 GAsyncResult *res,
+					 gpointer user_data)
+{
+	GsPluginLoader *plugin_loader = GS_PLUGIN_LOADER (source);
+	GsPluginLoaderPrivate *priv = gs_plugin_loader_get_instance_private (plugin_loader);
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GsAppList) list = user_data;
+	g_autoptr(GsAppList) list_refined = NULL;
+
+	list_refined = gs_plugin_loader_job_process_finish (plugin_loader, res, &error);
+	if (list_refined == NULL) {
+		g_warning ("failed to revalidate snapshot: %s", error->message);
+		return;
+	}
+
+	/* anything no plugin claimed has gone away */
+	for (guint i = 0; i < gs_app_list_length (list); i++) {
+		GsApp *app = gs_app_list_index (list, i);
+		if (gs_app_get_management_plugin (app) != NULL &&
+		    gs_app_get_state (app) != AS_APP_STATE_UNKNOWN)
+			continue;
+		g_debug ("removing stale %s from the snapshot",
+			 gs_app_get_unique_id (app));
+		gs_app_list_remove (priv->global_cache, app);
+	}
+}
+
+/* check the snapshot data against the real plugins, after anything the
+ * user is waiting for */
+static void
+gs_plugin_loader_snapshot_revalidate (GsPluginLoader *plugin_loader)
+{
+	GsPluginLoaderPrivate *priv = gs_plugin_loader_get_instance_private (plugin_loader);
+	g_autoptr(GsAppList) list = g_steal_pointer (&priv->snapshot);
+	g_autoptr(GsPluginJob) plugin_job = NULL;
+
+	if (list == NULL || gs_app_list_length (list) == 0)
+		return;
+
+	/* the plugin that managed the app last time may have been disabled,
+	 * in which case another plugin has to adopt it */
+	for (guint i = 0; i < gs_app_list_length (list); i++) {
+		GsApp *app = gs_app_list_index (list, i);
+		const gchar *management_plugin = gs_app_get_management_plugin (app);
+		GsPlugin *plugin;
+
+		/* the state is from last time, so make the managing plugin
+		 * find the app again for it to be kept */
+		gs_app_set_state (app, AS_APP_STATE_UNKNOWN);
+
+		if (management_plugin == NULL)
+			continue;
+		plugin = gs_plugin_loader_find_plugin (plugin_loader, management_plugin);
+		if (plugin != NULL && gs_plugin_get_enabled (plugin))
+			continue;
+		g_debug ("%s is not available to manage %s",
+			 management_plugin, gs_app_get_unique_id (app));
+		gs_app_set_management_plugin (app, NULL);
+	}
+
+	/* ask the plugins to refresh the details that would be stale */
+	plugin_job = gs_plugin_job_newv (GS_PLUGIN_ACTION_REFINE,
+					 "list", list,
+					 "refine-flags", GS_PLUGIN_REFINE_FLAGS_REQUIRE_ICON |
+							 GS_PLUGIN_REFINE_FLAGS_REQUIRE_RATING |
+							 GS_PLUGIN_REFINE_FLAGS_REQUIRE_SETUP_ACTION |
+							 GS_PLUGIN_REFINE_FLAGS_REQUIRE_ORIGIN |
+							 GS_PLUGIN_REFINE_FLAGS_REQUIRE_VERSION,
+					 "priority", GS_PLUGIN_JOB_PRIORITY_BACKGROUND,
+					 NULL);
+	gs_plugin_loader_job_process_async (plugin_loader, plugin_job, NULL,
+					    gs_plugin_loader_snapshot_revalidate_cb,
+					    g_object_ref (list));
+}
+
+/**
+ * gs_plugin_loader_set_snapshot_enabled:
+ * @plugin_loader: a #GsPluginLoader
+ * @snapshot_enabled: if a snapshot of the global cache should be kept
+ *
+ * Sets if the refined applications should be saved to a snapshot in the
+ * cache directory on shutdown, and loaded again by gs_plugin_loader_setup()
+ * so they can be shown before the plugins have loaded their metadata.
+ * The loaded applications are checked against the plugins in the background.
+ *
+ * This must be called before gs_plugin_loader_setup().
+ */
+void
+gs_plugin_loader_set_snapshot_enabled (GsPluginLoader *plugin_loader,
+				       gboolean snapshot_enabled)
+{
+	GsPluginLoaderPrivate *priv = gs_plugin_loader_get_instance_private (plugin_loader);
+	priv->snapshot_enabled = snapshot_enabled;
+}
+
 /**
  * gs_plugin_loader_setup:
  * @plugin_loader: a #GsPluginLoader
@@ -2303,16 +3974,15 @@ gs_plugin_loader_setup (GsPluginLoader *plugin_loader,
 	GsPluginLoaderPrivate *priv = gs_plugin_loader_get_instance_private (plugin_loader);
 	const gchar *filename_tmp;
 	const gchar *plugin_name;
-	gboolean changes;
 	GPtrArray *deps;
 	GsPlugin *dep;
 	GsPlugin *plugin;
-	guint dep_loop_check = 0;
 	guint i;
 	guint j;
 	g_autoptr(AsProfileTask) ptask = NULL;
 	g_autoptr(GsPluginLoaderHelper) helper = NULL;
 	g_autoptr(GsPluginJob) plugin_job = NULL;
+	g_autoptr(GPtrArray) plugins_setup = NULL;
 
 	/* use the default, but this requires a 'make install' */
 	if (priv->locations->len == 0) {
@@ -2395,6 +4065,9 @@ gs_plugin_loader_setup (GsPluginLoader *plugin_loader,
 		}
 	}
 
+	/* only dispatch to the plugins that implement each action */
+	gs_plugin_loader_rebuild_dispatch (plugin_loader);
+
 	/* run the plugins */
 	plugin_job = gs_plugin_job_newv (GS_PLUGIN_ACTION_INITIALIZE, NULL);
 	helper = gs_plugin_loader_helper_new (plugin_loader, plugin_job);
@@ -2405,76 +4078,11 @@ gs_plugin_loader_setup (GsPluginLoader *plugin_loader,
 		return FALSE;
 
 	/* order by deps */
-	do {
-		changes = FALSE;
-		for (i = 0; i < priv->plugins->len; i++) {
-			plugin = g_ptr_array_index (priv->plugins, i);
-			deps = gs_plugin_get_rules (plugin, GS_PLUGIN_RULE_RUN_AFTER);
-			for (j = 0; j < deps->len && !changes; j++) {
-				plugin_name = g_ptr_array_index (deps, j);
-				dep = gs_plugin_loader_find_plugin (plugin_loader,
-								    plugin_name);
-				if (dep == NULL) {
-					g_debug ("cannot find plugin '%s' "
-						 "requested by '%s'",
-						 plugin_name,
-						 gs_plugin_get_name (plugin));
-					continue;
-				}
-				if (!gs_plugin_get_enabled (dep))
-					continue;
-				if (gs_plugin_get_order (plugin) <= gs_plugin_get_order (dep)) {
-					g_debug ("%s [%u] to be ordered after %s [%u] "
-						 "so promoting to [%u]",
-						 gs_plugin_get_name (plugin),
-						 gs_plugin_get_order (plugin),
-						 gs_plugin_get_name (dep),
-						 gs_plugin_get_order (dep),
-						 gs_plugin_get_order (dep) + 1);
-					gs_plugin_set_order (plugin, gs_plugin_get_order (dep) + 1);
-					changes = TRUE;
-				}
-			}
-		}
-		for (i = 0; i < priv->plugins->len; i++) {
-			plugin = g_ptr_array_index (priv->plugins, i);
-			deps = gs_plugin_get_rules (plugin, GS_PLUGIN_RULE_RUN_BEFORE);
-			for (j = 0; j < deps->len && !changes; j++) {
-				plugin_name = g_ptr_array_index (deps, j);
-				dep = gs_plugin_loader_find_plugin (plugin_loader,
-								    plugin_name);
-				if (dep == NULL) {
-					g_debug ("cannot find plugin '%s' "
-						 "requested by '%s'",
-						 plugin_name,
-						 gs_plugin_get_name (plugin));
-					continue;
-				}
-				if (!gs_plugin_get_enabled (dep))
-					continue;
-				if (gs_plugin_get_order (plugin) >= gs_plugin_get_order (dep)) {
-					g_debug ("%s [%u] to be ordered before %s [%u] "
-						 "so promoting to [%u]",
-						 gs_plugin_get_name (plugin),
-						 gs_plugin_get_order (plugin),
-						 gs_plugin_get_name (dep),
-						 gs_plugin_get_order (dep),
-						 gs_plugin_get_order (dep) + 1);
-					gs_plugin_set_order (dep, gs_plugin_get_order (plugin) + 1);
-					changes = TRUE;
-				}
-			}
-		}
-
-		/* check we're not stuck */
-		if (dep_loop_check++ > 100) {
-			g_set_error (error,
-				     GS_PLUGIN_ERROR,
-				     GS_PLUGIN_ERROR_PLUGIN_DEPSOLVE_FAILED,
-				     "got stuck in dep loop");
-			return FALSE;
-		}
-	} while (changes);
+	if (!gs_plugin_rank_by_rules (priv->plugins,
+				      GS_PLUGIN_RULE_RUN_AFTER,
+				      GS_PLUGIN_RULE_RUN_BEFORE,
+				      FALSE, error))
+		return FALSE;
 
 	/* check for conflicts */
 	for (i = 0; i < priv->plugins->len; i++) {
@@ -2482,7 +4090,7 @@ gs_plugin_loader_setup (GsPluginLoader *plugin_loader,
 		if (!gs_plugin_get_enabled (plugin))
 			continue;
 		deps = gs_plugin_get_rules (plugin, GS_PLUGIN_RULE_CONFLICTS);
-		for (j = 0; j < deps->len && !changes; j++) {
+		for (j = 0; j < deps->len; j++) {
 			plugin_name = g_ptr_array_index (deps, j);
 			dep = gs_plugin_loader_find_plugin (plugin_loader,
 							    plugin_name);
@@ -2500,70 +4108,58 @@ gs_plugin_loader_setup (GsPluginLoader *plugin_loader,
 	/* sort by order */
 	g_ptr_array_sort (priv->plugins,
 			  gs_plugin_loader_plugin_sort_fn);
+	gs_plugin_loader_rebuild_dispatch (plugin_loader);
 
 	/* assign priority values */
-	do {
-		changes = FALSE;
-		for (i = 0; i < priv->plugins->len; i++) {
-			plugin = g_ptr_array_index (priv->plugins, i);
-			deps = gs_plugin_get_rules (plugin, GS_PLUGIN_RULE_BETTER_THAN);
-			for (j = 0; j < deps->len && !changes; j++) {
-				plugin_name = g_ptr_array_index (deps, j);
-				dep = gs_plugin_loader_find_plugin (plugin_loader,
-								    plugin_name);
-				if (dep == NULL) {
-					g_debug ("cannot find plugin '%s' "
-						 "requested by '%s'",
-						 plugin_name,
-						 gs_plugin_get_name (plugin));
-					continue;
-				}
-				if (!gs_plugin_get_enabled (dep))
-					continue;
-				if (gs_plugin_get_priority (plugin) <= gs_plugin_get_priority (dep)) {
-					g_debug ("%s [%u] is better than %s [%u] "
-						 "so promoting to [%u]",
-						 gs_plugin_get_name (plugin),
-						 gs_plugin_get_priority (plugin),
-						 gs_plugin_get_name (dep),
-						 gs_plugin_get_priority (dep),
-						 gs_plugin_get_priority (dep) + 1);
-					gs_plugin_set_priority (plugin, gs_plugin_get_priority (dep) + 1);
-					changes = TRUE;
-				}
-			}
-		}
+	if (!gs_plugin_rank_by_rules (priv->plugins,
+				      GS_PLUGIN_RULE_BETTER_THAN,
+				      GS_PLUGIN_RULE_LAST,
+				      TRUE, error))
+		return FALSE;
 
-		/* check we're not stuck */
-		if (dep_loop_check++ > 100) {
-			g_set_error (error,
-				     GS_PLUGIN_ERROR,
-				     GS_PLUGIN_ERROR_PLUGIN_DEPSOLVE_FAILED,
-				     "got stuck in priority loop");
-			return FALSE;
-		}
-	} while (changes);
+	/* plugins creating apps in setup can use the ones from last time */
+	if (priv->snapshot_enabled)
+		gs_plugin_loader_snapshot_load (plugin_loader);
 
-	/* run setup */
+	/* run setup, with unrelated plugins at the same time */
 	gs_plugin_job_set_action (helper->plugin_job, GS_PLUGIN_ACTION_SETUP);
 	gs_plugin_job_set_failure_flags (helper->plugin_job,
-					 GS_PLUGIN_FAILURE_FLAGS_FATAL_ANY);
-	helper->function_name = "gs_plugin_setup";
-	for (i = 0; i < priv->plugins->len; i++) {
-		g_autoptr(GError) error_local = NULL;
-		plugin = g_ptr_array_index (priv->plugins, i);
-		if (!gs_plugin_loader_call_vfunc (helper, plugin, NULL, NULL,
-						  cancellable, &error_local)) {
-			g_debug ("disabling %s as setup failed: %s",
-				 gs_plugin_get_name (plugin),
-				 error_local->message);
-			gs_plugin_set_enabled (plugin, FALSE);
+					 GS_PLUGIN_FAILURE_FLAGS_FATAL_ANY);
+	helper->vfunc = GS_PLUGIN_VFUNC_SETUP;
+	gs_plugin_loader_build_dag (plugin_loader);
+	plugins_setup = g_ptr_array_new ();
+	for (i = 0; i < priv->plugins_for_action[GS_PLUGIN_ACTION_SETUP]->len; i++) {
+		plugin = g_ptr_array_index (priv->plugins_for_action[GS_PLUGIN_ACTION_SETUP], i);
+
+		/* deferred until a job uses the plugin */
+		if (gs_plugin_has_flags (plugin, GS_PLUGIN_FLAGS_LAZY_SETUP)) {
+			g_mutex_lock (&priv->lazy_setup_mutex);
+			if (!g_hash_table_contains (priv->lazy_setup, plugin)) {
+				g_hash_table_insert (priv->lazy_setup, plugin,
+						     GINT_TO_POINTER (GS_PLUGIN_LOADER_LAZY_SETUP_PENDING));
+				g_atomic_int_inc (&priv->lazy_setup_pending);
+			}
+			g_mutex_unlock (&priv->lazy_setup_mutex);
+			continue;
 		}
+		g_ptr_array_add (plugins_setup, plugin);
 	}
+	if (!gs_plugin_loader_run_dag (helper, plugins_setup,
+				       gs_plugin_loader_setup_plugin,
+				       NULL, FALSE, NULL, cancellable, error))
+		return FALSE;
+
+	/* drop any plugins disabled during setup */
+	gs_plugin_loader_rebuild_dispatch (plugin_loader);
+	gs_plugin_loader_build_dag (plugin_loader);
 
 	/* now we can load the install-queue */
 	if (!load_install_queue (plugin_loader, error))
 		return FALSE;
+
+	/* the snapshot apps are usable now, but might be out of date */
+	if (priv->snapshot_enabled)
+		gs_plugin_loader_snapshot_revalidate (plugin_loader);
 	return TRUE;
 }
 
@@ -2571,6 +4167,9 @@ void
 gs_plugin_loader_dump_state (GsPluginLoader *plugin_loader)
 {
 	GsPluginLoaderPrivate *priv = gs_plugin_loader_get_instance_private (plugin_loader);
+	guint hits = 0;
+	guint misses = 0;
+	guint evicted = 0;
 	g_autoptr(GString) str_enabled = g_string_new (NULL);
 	g_autoptr(GString) str_disabled = g_string_new (NULL);
 
@@ -2579,17 +4178,52 @@ gs_plugin_loader_dump_state (GsPluginLoader *plugin_loader)
 		GsPlugin *plugin = g_ptr_array_index (priv->plugins, i);
 		GString *str = gs_plugin_get_enabled (plugin) ? str_enabled : str_disabled;
 		g_string_append_printf (str, "%s, ", gs_plugin_get_name (plugin));
-		g_debug ("[%s]\t%u\t->\t%s",
+		g_debug ("[%s]\t%u\t->\t%s (setup took %ums)",
 			 gs_plugin_get_enabled (plugin) ? "enabled" : "disabld",
 			 gs_plugin_get_order (plugin),
-			 gs_plugin_get_name (plugin));
+			 gs_plugin_get_name (plugin),
+			 gs_plugin_get_setup_time (plugin));
+	}
+
+	/* plugins that set up on first use */
+	g_mutex_lock (&priv->lazy_setup_mutex);
+	for (guint i = 0; i < priv->plugins->len; i++) {
+		GsPlugin *plugin = g_ptr_array_index (priv->plugins, i);
+		gpointer value;
+		if (!g_hash_table_lookup_extended (priv->lazy_setup, plugin, NULL, &value))
+			continue;
+		switch (GPOINTER_TO_INT (value)) {
+		case GS_PLUGIN_LOADER_LAZY_SETUP_PENDING:
+			g_info ("lazy plugin %s: not yet used", gs_plugin_get_name (plugin));
+			break;
+		case GS_PLUGIN_LOADER_LAZY_SETUP_RUNNING:
+			g_info ("lazy plugin %s: setting up", gs_plugin_get_name (plugin));
+			break;
+		case GS_PLUGIN_LOADER_LAZY_SETUP_DONE:
+			g_info ("lazy plugin %s: set up on first use in %ums",
+				gs_plugin_get_name (plugin),
+				gs_plugin_get_setup_time (plugin));
+			break;
+		default:
+			g_info ("lazy plugin %s: setup failed", gs_plugin_get_name (plugin));
+			break;
+		}
 	}
+	g_mutex_unlock (&priv->lazy_setup_mutex);
 	if (str_enabled->len > 2)
 		g_string_truncate (str_enabled, str_enabled->len - 2);
 	if (str_disabled->len > 2)
 		g_string_truncate (str_disabled, str_disabled->len - 2);
 	g_info ("enabled plugins: %s", str_enabled->str);
 	g_info ("disabled plugins: %s", str_disabled->str);
+
+	/* how well the global cache is working */
+	gs_app_list_get_cache_stats (priv->global_cache, &hits, &misses, &evicted);
+	g_info ("global cache: %u apps, %u hits, %u misses, %u evicted",
+		gs_app_list_length (priv->global_cache), hits, misses, evicted);
+
+	/* anything recorded rather than printed */
+	gs_debug_dump ();
 }
 
 static void
@@ -2626,24 +4260,69 @@ gs_plugin_loader_set_property (GObject *object, guint prop_id,
 	}
 }
 
+static gboolean
+gs_plugin_loader_global_cache_expire_cb (gpointer user_data)
+{
+	GsPluginLoader *plugin_loader = GS_PLUGIN_LOADER (user_data);
+	GsPluginLoaderPrivate *priv = gs_plugin_loader_get_instance_private (plugin_loader);
+	guint n_evicted = gs_app_list_expire (priv->global_cache);
+	if (n_evicted > 0) {
+		g_debug ("expired %u apps from the global cache, %u left",
+			 n_evicted, gs_app_list_length (priv->global_cache));
+	}
+	return G_SOURCE_CONTINUE;
+}
+
 static void
 gs_plugin_loader_dispose (GObject *object)
 {
 	GsPluginLoader *plugin_loader = GS_PLUGIN_LOADER (object);
 	GsPluginLoaderPrivate *priv = gs_plugin_loader_get_instance_private (plugin_loader);
 
+	/* cancel any queued jobs and wait for the running ones, as the
+	 * plugins are about to be destroyed */
+	if (priv->job_pool != NULL) {
+		g_autoptr(GPtrArray) jobs_deferred = NULL;
+		g_mutex_lock (&priv->job_mutex);
+		priv->jobs_shutdown = TRUE;
+		jobs_deferred = priv->jobs_deferred;
+		priv->jobs_deferred = g_ptr_array_new_with_free_func ((GDestroyNotify) gs_plugin_loader_job_item_cancel);
+		g_mutex_unlock (&priv->job_mutex);
+		g_thread_pool_free (priv->job_pool, FALSE, TRUE);
+		priv->job_pool = NULL;
+	}
+
+	/* nothing can queue more apps now the jobs have finished */
+	if (priv->refine_pool != NULL) {
+		g_thread_pool_free (priv->refine_pool, FALSE, TRUE);
+		priv->refine_pool = NULL;
+	}
+	if (priv->plugins != NULL && priv->snapshot_enabled) {
+		g_autoptr(GError) error = NULL;
+		if (!gs_plugin_loader_snapshot_save (plugin_loader, &error))
+			g_warning ("failed to save snapshot: %s", error->message);
+		priv->snapshot_enabled = FALSE;
+	}
 	if (priv->plugins != NULL) {
 		g_autoptr(GsPluginLoaderHelper) helper = NULL;
 		g_autoptr(GsPluginJob) plugin_job = NULL;
 		plugin_job = gs_plugin_job_newv (GS_PLUGIN_ACTION_DESTROY, NULL);
 		helper = gs_plugin_loader_helper_new (plugin_loader, plugin_job);
 		gs_plugin_loader_run_results (helper, NULL, NULL);
+		for (guint i = 0; i < GS_PLUGIN_ACTION_LAST; i++)
+			g_ptr_array_set_size (priv->plugins_for_action[i], 0);
+		g_ptr_array_set_size (priv->plugins_for_adopt, 0);
+		g_hash_table_remove_all (priv->plugin_preds);
 		g_clear_pointer (&priv->plugins, g_ptr_array_unref);
 	}
 	if (priv->updates_changed_id != 0) {
 		g_source_remove (priv->updates_changed_id);
 		priv->updates_changed_id = 0;
 	}
+	if (priv->global_cache_expire_id != 0) {
+		g_source_remove (priv->global_cache_expire_id);
+		priv->global_cache_expire_id = 0;
+	}
 	if (priv->network_changed_handler != 0) {
 		g_signal_handler_disconnect (priv->network_monitor,
 					     priv->network_changed_handler);
@@ -2655,6 +4334,7 @@ gs_plugin_loader_dispose (GObject *object)
 	g_clear_object (&priv->settings);
 	g_clear_pointer (&priv->auth_array, g_ptr_array_unref);
 	g_clear_pointer (&priv->pending_apps, g_ptr_array_unref);
+	g_clear_object (&priv->snapshot);
 
 	G_OBJECT_CLASS (gs_plugin_loader_parent_class)->dispose (object);
 }
@@ -2673,8 +4353,22 @@ gs_plugin_loader_finalize (GObject *object)
 	g_ptr_array_unref (priv->file_monitors);
 	g_hash_table_unref (priv->events_by_id);
 	g_hash_table_unref (priv->disallow_updates);
+	for (guint i = 0; i < GS_PLUGIN_ACTION_LAST; i++)
+		g_ptr_array_unref (priv->plugins_for_action[i]);
+	g_ptr_array_unref (priv->plugins_for_adopt);
+	g_hash_table_unref (priv->plugin_preds);
+	g_ptr_array_unref (priv->jobs_deferred);
+	g_hash_table_unref (priv->flights);
+	g_hash_table_unref (priv->lazy_setup);
+	g_hash_table_unref (priv->stats);
 
 	g_mutex_clear (&priv->pending_apps_mutex);
+	g_mutex_clear (&priv->job_mutex);
+	g_mutex_clear (&priv->plugins_running_mutex);
+	g_mutex_clear (&priv->flights_mutex);
+	g_mutex_clear (&priv->lazy_setup_mutex);
+	g_cond_clear (&priv->lazy_setup_cond);
+	g_mutex_clear (&priv->stats_mutex);
 	g_mutex_clear (&priv->events_by_id_mutex);
 
 	G_OBJECT_CLASS (gs_plugin_loader_parent_class)->finalize (object);
@@ -2765,7 +4459,37 @@ gs_plugin_loader_init (GsPluginLoader *plugin_loader)
 
 	priv->scale = 1;
 	priv->global_cache = gs_app_list_new ();
+	gs_app_list_set_cache_limits (priv->global_cache,
+				      GS_PLUGIN_LOADER_GLOBAL_CACHE_MAX,
+				      GS_PLUGIN_LOADER_GLOBAL_CACHE_AGE);
+	priv->global_cache_expire_id =
+		g_timeout_add_seconds (GS_PLUGIN_LOADER_GLOBAL_CACHE_EXPIRE,
+				       gs_plugin_loader_global_cache_expire_cb,
+				       plugin_loader);
 	priv->plugins = g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
+	for (i = 0; i < GS_PLUGIN_ACTION_LAST; i++)
+		priv->plugins_for_action[i] = g_ptr_array_new ();
+	priv->plugins_for_adopt = g_ptr_array_new ();
+	priv->plugin_preds = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+						    NULL, (GDestroyNotify) g_ptr_array_unref);
+	priv->job_pool = g_thread_pool_new (gs_plugin_loader_job_pool_cb,
+					    plugin_loader,
+					    GS_PLUGIN_LOADER_JOBS_MAX,
+					    FALSE, NULL);
+	g_thread_pool_set_sort_function (priv->job_pool,
+					 gs_plugin_loader_job_item_sort_cb,
+					 NULL);
+	priv->jobs_deferred = g_ptr_array_new_with_free_func ((GDestroyNotify) gs_plugin_loader_job_item_cancel);
+	priv->refine_pool = g_thread_pool_new (gs_plugin_loader_refine_app_thread_cb,
+					       plugin_loader,
+					       (gint) g_get_num_processors (),
+					       FALSE, NULL);
+	priv->flights = g_hash_table_new (g_str_hash, g_str_equal);
+	priv->lazy_setup = g_hash_table_new (g_direct_hash, g_direct_equal);
+	priv->stats = g_hash_table_new_full (gs_plugin_loader_stats_hash,
+					     gs_plugin_loader_stats_equal,
+					     (GDestroyNotify) gs_plugin_loader_stats_free,
+					     NULL);
 	priv->pending_apps = g_ptr_array_new_with_free_func ((GFreeFunc) g_object_unref);
 	priv->auth_array = g_ptr_array_new_with_free_func ((GFreeFunc) g_object_unref);
 	priv->file_monitors = g_ptr_array_new_with_free_func ((GFreeFunc) g_object_unref);
@@ -2812,6 +4536,12 @@ gs_plugin_loader_init (GsPluginLoader *plugin_loader)
 		*match = '\0';
 
 	g_mutex_init (&priv->pending_apps_mutex);
+	g_mutex_init (&priv->job_mutex);
+	g_mutex_init (&priv->plugins_running_mutex);
+	g_mutex_init (&priv->flights_mutex);
+	g_mutex_init (&priv->lazy_setup_mutex);
+	g_cond_init (&priv->lazy_setup_cond);
+	g_mutex_init (&priv->stats_mutex);
 	g_mutex_init (&priv->events_by_id_mutex);
 
 	/* monitor the network as the many UI operations need the network */
@@ -2914,6 +4644,7 @@ gs_plugin_loader_network_changed_cb (GNetworkMonitor *monitor,
 			plugin_job = gs_plugin_job_newv (GS_PLUGIN_ACTION_INSTALL,
 							 "app", app,
 							 "failure-flags", GS_PLUGIN_FAILURE_FLAGS_USE_EVENTS,
+							 "priority", GS_PLUGIN_JOB_PRIORITY_BACKGROUND,
 							 NULL);
 			gs_plugin_loader_job_process_async (plugin_loader, plugin_job,
 							    NULL,
@@ -2965,21 +4696,30 @@ gs_plugin_loader_generic_update (GsPluginLoader *plugin_loader,
 				 GError **error)
 {
 	GsPluginLoaderPrivate *priv = gs_plugin_loader_get_instance_private (plugin_loader);
+	GPtrArray *plugins;
 	GsAppList *list;
 
 	/* run each plugin, per-app version */
 	list = gs_plugin_job_get_list (helper->plugin_job);
-	for (guint i = 0; i < priv->plugins->len; i++) {
+	plugins = priv->plugins_for_action[GS_PLUGIN_ACTION_UPDATE];
+	for (guint i = 0; i < plugins->len; i++) {
 		GsPluginActionFunc plugin_app_func = NULL;
-		GsPlugin *plugin = g_ptr_array_index (priv->plugins, i);
+		GsPlugin *plugin = g_ptr_array_index (plugins, i);
 		if (g_cancellable_set_error_if_cancelled (cancellable, error)) {
 			gs_utils_error_convert_gio (error);
 			return FALSE;
 		}
-		plugin_app_func = gs_plugin_get_symbol (plugin, helper->function_name);
+		plugin_app_func = gs_plugin_get_vfunc (plugin, helper->vfunc);
 		if (plugin_app_func == NULL)
 			continue;
 
+		/* set up on first use, holding the plugin like any vfunc */
+		gs_plugin_loader_action_start (plugin_loader, plugin, FALSE);
+		if (!gs_plugin_loader_ensure_setup (plugin_loader, plugin)) {
+			gs_plugin_loader_action_stop (plugin_loader, plugin);
+			continue;
+		}
+
 		/* for each app */
 		for (guint j = 0; j < gs_app_list_length (list); j++) {
 			GsApp *app = gs_app_list_index (list, j);
@@ -2991,27 +4731,127 @@ gs_plugin_loader_generic_update (GsPluginLoader *plugin_loader,
 			ptask = as_profile_start (priv->profile,
 						  "GsPlugin::%s(%s){%s}",
 						  gs_plugin_get_name (plugin),
-						  helper->function_name,
+						  gs_plugin_vfunc_to_string (helper->vfunc),
 						  gs_app_get_id (app));
 			g_assert (ptask != NULL);
-			gs_plugin_loader_action_start (plugin_loader, plugin, FALSE);
 			ret = plugin_app_func (plugin, app, cancellable, &error_local);
-			gs_plugin_loader_action_stop (plugin_loader, plugin);
 			if (!ret) {
 				if (!gs_plugin_error_handle_failure (helper,
 								     plugin,
 								     error_local,
 								     error)) {
+					gs_plugin_loader_action_stop (plugin_loader, plugin);
 					return FALSE;
 				}
 			}
 		}
-		helper->anything_ran = TRUE;
+		gs_plugin_loader_action_stop (plugin_loader, plugin);
+		g_atomic_int_set (&helper->anything_ran, TRUE);
 		gs_plugin_status_update (plugin, NULL, GS_PLUGIN_STATUS_FINISHED);
 	}
 	return TRUE;
 }
 
+static void
+gs_plugin_loader_job_filter_results (GsPluginLoaderHelper *helper, GsAppList *list)
+{
+	GsPluginLoader *plugin_loader = helper->plugin_loader;
+	GsPluginAction action = gs_plugin_job_get_action (helper->plugin_job);
+
+	switch (action) {
+	case GS_PLUGIN_ACTION_URL_TO_APP:
+		gs_app_list_filter (list, gs_plugin_loader_app_is_valid, helper);
+		break;
+	case GS_PLUGIN_ACTION_SEARCH:
+	case GS_PLUGIN_ACTION_SEARCH_FILES:
+	case GS_PLUGIN_ACTION_SEARCH_PROVIDES:
+		gs_app_list_filter (list, gs_plugin_loader_app_is_valid, helper);
+		gs_app_list_filter (list, gs_plugin_loader_filter_qt_for_gtk, NULL);
+		gs_app_list_filter (list, gs_plugin_loader_get_app_is_compatible, plugin_loader);
+		break;
+	case GS_PLUGIN_ACTION_GET_CATEGORY_APPS:
+		gs_app_list_filter (list, gs_plugin_loader_app_is_non_compulsory, NULL);
+		gs_app_list_filter (list, gs_plugin_loader_app_is_valid, helper);
+		gs_app_list_filter (list, gs_plugin_loader_filter_qt_for_gtk, NULL);
+		gs_app_list_filter (list, gs_plugin_loader_get_app_is_compatible, plugin_loader);
+		break;
+	case GS_PLUGIN_ACTION_GET_INSTALLED:
+		gs_app_list_filter (list, gs_plugin_loader_app_is_valid, helper);
+		gs_app_list_filter (list, gs_plugin_loader_app_is_valid_installed, helper);
+		break;
+	case GS_PLUGIN_ACTION_GET_FEATURED:
+		if (g_getenv ("GNOME_SOFTWARE_FEATURED") != NULL) {
+			gs_app_list_filter (list, gs_plugin_loader_featured_debug, NULL);
+		} else {
+			gs_app_list_filter (list, gs_plugin_loader_app_is_valid, helper);
+			gs_app_list_filter (list, gs_plugin_loader_get_app_is_compatible, plugin_loader);
+		}
+		break;
+	case GS_PLUGIN_ACTION_GET_UPDATES:
+		gs_app_list_filter (list, gs_plugin_loader_app_is_valid_updatable, helper);
+		break;
+	case GS_PLUGIN_ACTION_GET_RECENT:
+		gs_app_list_filter (list, gs_plugin_loader_app_is_non_compulsory, NULL);
+		gs_app_list_filter (list, gs_plugin_loader_app_is_valid, helper);
+		gs_app_list_filter (list, gs_plugin_loader_filter_qt_for_gtk, NULL);
+		gs_app_list_filter (list, gs_plugin_loader_get_app_is_compatible, plugin_loader);
+		break;
+	case GS_PLUGIN_ACTION_GET_POPULAR:
+		gs_app_list_filter (list, gs_plugin_loader_app_is_valid, helper);
+		gs_app_list_filter (list, gs_plugin_loader_filter_qt_for_gtk, NULL);
+		gs_app_list_filter (list, gs_plugin_loader_get_app_is_compatible, plugin_loader);
+		break;
+	default:
+		break;
+	}
+}
+
+/* tops up a truncated list with the next best candidates that survive the
+ * same refine and filtering as the original results */
+static gboolean
+gs_plugin_loader_job_backfill (GsPluginLoaderHelper *helper,
+			       GsAppList *list,
+			       GCancellable *cancellable,
+			       GError **error)
+{
+	GsPluginAction action = gs_plugin_job_get_action (helper->plugin_job);
+	GsAppListSortFunc sort_func = gs_plugin_job_get_sort_func (helper->plugin_job);
+	guint max_results = gs_plugin_job_get_max_results (helper->plugin_job);
+
+	while (helper->list_backfill != NULL &&
+	       gs_app_list_length (helper->list_backfill) > 0 &&
+	       gs_app_list_length (list) < max_results) {
+		g_autoptr(GsAppList) list_batch = helper->list_backfill;
+		guint needed = max_results - gs_app_list_length (list);
+
+		g_debug ("backfilling %u results from %u candidates",
+			 needed, gs_app_list_length (list_batch));
+		helper->list_backfill = gs_app_list_truncate_sorted (list_batch, needed, sort_func,
+								     gs_plugin_job_get_sort_func_data (helper->plugin_job));
+		if (gs_plugin_job_get_refine_flags (helper->plugin_job) != 0) {
+			if (!gs_plugin_loader_run_refine (helper, list_batch, cancellable, error))
+				return FALSE;
+		}
+		switch (action) {
+		case GS_PLUGIN_ACTION_SEARCH:
+		case GS_PLUGIN_ACTION_SEARCH_FILES:
+		case GS_PLUGIN_ACTION_SEARCH_PROVIDES:
+			gs_plugin_loader_convert_unavailable (list_batch, gs_plugin_job_get_search (helper->plugin_job));
+			break;
+		default:
+			break;
+		}
+		gs_plugin_loader_job_filter_results (helper, list_batch);
+		gs_app_list_filter (list_batch, gs_plugin_loader_app_set_prio, helper->plugin_loader);
+		gs_app_list_add_list (list, list_batch);
+		gs_app_list_filter_duplicates (list,
+					       GS_APP_LIST_FILTER_FLAG_KEY_ID |
+					       GS_APP_LIST_FILTER_FLAG_KEY_SOURCE |
+					       GS_APP_LIST_FILTER_FLAG_KEY_VERSION);
+	}
+	return TRUE;
+}
+
 static void
 gs_plugin_loader_process_thread_cb (GTask *task,
 				    gpointer object,
@@ -3055,7 +4895,7 @@ gs_plugin_loader_process_thread_cb (GTask *task,
 
 	/* run per-app version */
 	if (action == GS_PLUGIN_ACTION_UPDATE) {
-		helper->function_name = "gs_plugin_update_app";
+		helper->vfunc = GS_PLUGIN_VFUNC_UPDATE_APP;
 		if (!gs_plugin_loader_generic_update (plugin_loader, helper,
 						      cancellable, &error)) {
 			gs_utils_error_convert_gio (&error);
@@ -3071,7 +4911,7 @@ gs_plugin_loader_process_thread_cb (GTask *task,
 	/* append extra things when we want the list of pending updates */
 	if (action == GS_PLUGIN_ACTION_GET_UPDATES &&
 	    !g_settings_get_boolean (priv->settings, "download-updates")) {
-		helper->function_name = "gs_plugin_add_updates_pending";
+		helper->vfunc = GS_PLUGIN_VFUNC_ADD_UPDATES_PENDING;
 		if (!gs_plugin_loader_run_results (helper, cancellable, &error)) {
 			gs_utils_error_convert_gio (&error);
 			g_task_return_error (task, error);
@@ -3092,7 +4932,7 @@ gs_plugin_loader_process_thread_cb (GTask *task,
 	case GS_PLUGIN_ACTION_SEARCH:
 	case GS_PLUGIN_ACTION_SETUP:
 	case GS_PLUGIN_ACTION_UPDATE:
-		if (!helper->anything_ran) {
+		if (!g_atomic_int_get (&helper->anything_ran)) {
 			g_set_error (&error,
 				     GS_PLUGIN_ERROR,
 				     GS_PLUGIN_ERROR_NOT_SUPPORTED,
@@ -3105,7 +4945,7 @@ gs_plugin_loader_process_thread_cb (GTask *task,
 	case GS_PLUGIN_ACTION_REFINE:
 		break;
 	default:
-		if (!helper->anything_ran) {
+		if (!g_atomic_int_get (&helper->anything_ran)) {
 			g_debug ("no plugin could handle %s",
 				 gs_plugin_action_to_string (action));
 		}
@@ -3211,52 +5051,7 @@ gs_plugin_loader_process_thread_cb (GTask *task,
 	}
 
 	/* filter package list */
-	switch (action) {
-	case GS_PLUGIN_ACTION_URL_TO_APP:
-		gs_app_list_filter (list, gs_plugin_loader_app_is_valid, helper);
-		break;
-	case GS_PLUGIN_ACTION_SEARCH:
-	case GS_PLUGIN_ACTION_SEARCH_FILES:
-	case GS_PLUGIN_ACTION_SEARCH_PROVIDES:
-		gs_app_list_filter (list, gs_plugin_loader_app_is_valid, helper);
-		gs_app_list_filter (list, gs_plugin_loader_filter_qt_for_gtk, NULL);
-		gs_app_list_filter (list, gs_plugin_loader_get_app_is_compatible, plugin_loader);
-		break;
-	case GS_PLUGIN_ACTION_GET_CATEGORY_APPS:
-		gs_app_list_filter (list, gs_plugin_loader_app_is_non_compulsory, NULL);
-		gs_app_list_filter (list, gs_plugin_loader_app_is_valid, helper);
-		gs_app_list_filter (list, gs_plugin_loader_filter_qt_for_gtk, NULL);
-		gs_app_list_filter (list, gs_plugin_loader_get_app_is_compatible, plugin_loader);
-		break;
-	case GS_PLUGIN_ACTION_GET_INSTALLED:
-		gs_app_list_filter (list, gs_plugin_loader_app_is_valid, helper);
-		gs_app_list_filter (list, gs_plugin_loader_app_is_valid_installed, helper);
-		break;
-	case GS_PLUGIN_ACTION_GET_FEATURED:
-		if (g_getenv ("GNOME_SOFTWARE_FEATURED") != NULL) {
-			gs_app_list_filter (list, gs_plugin_loader_featured_debug, NULL);
-		} else {
-			gs_app_list_filter (list, gs_plugin_loader_app_is_valid, helper);
-			gs_app_list_filter (list, gs_plugin_loader_get_app_is_compatible, plugin_loader);
-		}
-		break;
-	case GS_PLUGIN_ACTION_GET_UPDATES:
-		gs_app_list_filter (list, gs_plugin_loader_app_is_valid_updatable, helper);
-		break;
-	case GS_PLUGIN_ACTION_GET_RECENT:
-		gs_app_list_filter (list, gs_plugin_loader_app_is_non_compulsory, NULL);
-		gs_app_list_filter (list, gs_plugin_loader_app_is_valid, helper);
-		gs_app_list_filter (list, gs_plugin_loader_filter_qt_for_gtk, NULL);
-		gs_app_list_filter (list, gs_plugin_loader_get_app_is_compatible, plugin_loader);
-		break;
-	case GS_PLUGIN_ACTION_GET_POPULAR:
-		gs_app_list_filter (list, gs_plugin_loader_app_is_valid, helper);
-		gs_app_list_filter (list, gs_plugin_loader_filter_qt_for_gtk, NULL);
-		gs_app_list_filter (list, gs_plugin_loader_get_app_is_compatible, plugin_loader);
-		break;
-	default:
-		break;
-	}
+	gs_plugin_loader_job_filter_results (helper, list);
 
 	/* only allow one result */
 	if (action == GS_PLUGIN_ACTION_URL_TO_APP ||
@@ -3298,6 +5093,13 @@ gs_plugin_loader_process_thread_cb (GTask *task,
 				       GS_APP_LIST_FILTER_FLAG_KEY_SOURCE |
 				       GS_APP_LIST_FILTER_FLAG_KEY_VERSION);
 
+	/* replace any of the top results that were filtered out */
+	if (!gs_plugin_loader_job_backfill (helper, list, cancellable, &error)) {
+		gs_utils_error_convert_gio (&error);
+		g_task_return_error (task, error);
+		return;
+	}
+
 	/* sort these again as the refine may have added useful metadata */
 	gs_plugin_loader_job_sorted_truncation_again (helper);
 
@@ -3319,7 +5121,7 @@ gs_plugin_loader_job_timeout_cb (gpointer user_data)
 		g_cancellable_cancel (helper->cancellable);
 
 	/* failed */
-	helper->timeout_triggered = TRUE;
+	g_atomic_int_set (&helper->timeout_triggered, TRUE);
 	helper->timeout_id = 0;
 	return G_SOURCE_REMOVE;
 }
@@ -3331,6 +5133,178 @@ gs_plugin_loader_cancelled_cb (GCancellable *cancellable, GsPluginLoaderHelper *
 	g_cancellable_cancel (helper->cancellable);
 }
 
+typedef struct {
+	GsPluginLoader		*plugin_loader;
+	gchar			*key;
+	GCancellable		*cancellable;	/* for the shared job */
+	GPtrArray		*waiters;	/* of GsPluginLoaderFlightWaiter */
+} GsPluginLoaderFlight;
+
+typedef struct {
+	GsPluginLoaderFlight	*flight;
+	GTask			*task;
+	GCancellable		*cancellable;
+	gulong			 cancellable_id;
+} GsPluginLoaderFlightWaiter;
+
+static void
+gs_plugin_loader_flight_waiter_free (GsPluginLoaderFlightWaiter *waiter)
+{
+	if (waiter->cancellable_id != 0) {
+		g_cancellable_disconnect (waiter->cancellable,
+					  waiter->cancellable_id);
+	}
+	if (waiter->cancellable != NULL)
+		g_object_unref (waiter->cancellable);
+	g_object_unref (waiter->task);
+	g_slice_free (GsPluginLoaderFlightWaiter, waiter);
+}
+
+static void
+gs_plugin_loader_flight_free (GsPluginLoaderFlight *flight)
+{
+	g_ptr_array_unref (flight->waiters);
+	g_object_unref (flight->cancellable);
+	g_object_unref (flight->plugin_loader);
+	g_free (flight->key);
+	g_slice_free (GsPluginLoaderFlight, flight);
+}
+
+static gboolean
+gs_plugin_loader_flight_waiter_free_cb (gpointer user_data)
+{
+	gs_plugin_loader_flight_waiter_free ((GsPluginLoaderFlightWaiter *) user_data);
+	return G_SOURCE_REMOVE;
+}
+
+static void
+gs_plugin_loader_flight_cancelled_cb (GCancellable *cancellable,
+				      GsPluginLoaderFlightWaiter *waiter)
+{
+	GsPluginLoaderFlight *flight = waiter->flight;
+	GsPluginLoaderPrivate *priv = gs_plugin_loader_get_instance_private (flight->plugin_loader);
+	g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&priv->flights_mutex);
+
+	/* already being completed by the shared job */
+	if (!g_ptr_array_remove (flight->waiters, waiter))
+		return;
+
+	/* the caller does not have to wait for the shared job to finish */
+	g_task_return_new_error (waiter->task,
+				 GS_PLUGIN_ERROR,
+				 GS_PLUGIN_ERROR_CANCELLED,
+				 "cancelled");
+
+	/* disconnecting from inside the handler would deadlock */
+	g_idle_add (gs_plugin_loader_flight_waiter_free_cb, waiter);
+
+	/* only stop the shared job when nobody wants the results */
+	if (flight->waiters->len > 0)
+		return;
+	g_debug ("cancelling shared job %s as it has no waiters", flight->key);
+	if (g_hash_table_lookup (priv->flights, flight->key) == flight)
+		g_hash_table_remove (priv->flights, flight->key);
+	g_cancellable_cancel (flight->cancellable);
+}
+
+static void
+gs_plugin_loader_flight_finished_cb (GObject *source,
+				     GAsyncResult *res,
+				     gpointer user_data)
+{
+	GsPluginLoader *plugin_loader = GS_PLUGIN_LOADER (source);
+	GsPluginLoaderPrivate *priv = gs_plugin_loader_get_instance_private (plugin_loader);
+	GsPluginLoaderFlight *flight = (GsPluginLoaderFlight *) user_data;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GPtrArray) waiters = NULL;
+	g_autoptr(GsAppList) list = NULL;
+
+	/* new jobs with the same key now have to run again, and waiters that
+	 * get cancelled from now on are completed here instead */
+	g_mutex_lock (&priv->flights_mutex);
+	if (g_hash_table_lookup (priv->flights, flight->key) == flight)
+		g_hash_table_remove (priv->flights, flight->key);
+	waiters = flight->waiters;
+	flight->waiters = g_ptr_array_new ();
+	g_mutex_unlock (&priv->flights_mutex);
+
+	/* everyone gets their own list, sharing the same apps */
+	list = gs_plugin_loader_job_process_finish (plugin_loader, res, &error);
+	for (guint i = 0; i < waiters->len; i++) {
+		GsPluginLoaderFlightWaiter *waiter = g_ptr_array_index (waiters, i);
+		if (waiter->cancellable != NULL &&
+		    g_cancellable_is_cancelled (waiter->cancellable)) {
+			g_task_return_new_error (waiter->task,
+						 GS_PLUGIN_ERROR,
+						 GS_PLUGIN_ERROR_CANCELLED,
+						 "cancelled");
+		} else if (list == NULL) {
+			g_task_return_error (waiter->task, g_error_copy (error));
+		} else {
+			g_task_return_pointer (waiter->task,
+					       gs_app_list_copy (list),
+					       (GDestroyNotify) g_object_unref);
+		}
+		gs_plugin_loader_flight_waiter_free (waiter);
+	}
+	gs_plugin_loader_flight_free (flight);
+}
+
+/* returns %TRUE if the job was attached to an identical job already running */
+static gboolean
+gs_plugin_loader_flight_join (GsPluginLoader *plugin_loader,
+			      const gchar *key,
+			      GCancellable *cancellable,
+			      GAsyncReadyCallback callback,
+			      gpointer user_data,
+			      GsPluginLoaderFlight **flight_new)
+{
+	GsPluginLoaderPrivate *priv = gs_plugin_loader_get_instance_private (plugin_loader);
+	GsPluginLoaderFlight *flight;
+	GsPluginLoaderFlightWaiter *waiter;
+	gboolean joined = TRUE;
+	g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&priv->flights_mutex);
+
+	/* a job that is being cancelled cannot be shared */
+	flight = g_hash_table_lookup (priv->flights, key);
+	if (flight == NULL || g_cancellable_is_cancelled (flight->cancellable)) {
+		flight = g_slice_new0 (GsPluginLoaderFlight);
+		flight->plugin_loader = g_object_ref (plugin_loader);
+		flight->key = g_strdup (key);
+		flight->cancellable = g_cancellable_new ();
+		flight->waiters = g_ptr_array_new ();
+		g_hash_table_replace (priv->flights, flight->key, flight);
+		*flight_new = flight;
+		joined = FALSE;
+	} else {
+		g_debug ("sharing results of running job %s", key);
+	}
+
+	waiter = g_slice_new0 (GsPluginLoaderFlightWaiter);
+	waiter->flight = flight;
+	waiter->task = g_task_new (plugin_loader, cancellable, callback, user_data);
+	g_task_set_check_cancellable (waiter->task, FALSE);
+	g_ptr_array_add (flight->waiters, waiter);
+	if (cancellable != NULL) {
+		waiter->cancellable = g_object_ref (cancellable);
+		g_mutex_unlock (&priv->flights_mutex);
+		waiter->cancellable_id =
+			g_cancellable_connect (cancellable,
+					       G_CALLBACK (gs_plugin_loader_flight_cancelled_cb),
+					       waiter, NULL);
+		g_mutex_lock (&priv->flights_mutex);
+	}
+	return joined;
+}
+
+static void
+gs_plugin_loader_job_trace_completed_cb (GTask *task, GParamSpec *pspec, gpointer user_data)
+{
+	GsPluginLoaderHelper *helper = g_task_get_task_data (task);
+	GsPluginAction action = gs_plugin_job_get_action (helper->plugin_job);
+	gs_trace_async_end ("job", gs_plugin_action_to_string (action), task);
+}
+
 /**
  * gs_plugin_loader_job_process_async:
  *
@@ -3346,6 +5320,8 @@ gs_plugin_loader_job_process_async (GsPluginLoader *plugin_loader,
 	GsPluginAction action;
 	GsPluginLoaderHelper *helper;
 	GsPluginLoaderPrivate *priv = gs_plugin_loader_get_instance_private (plugin_loader);
+	GsPluginLoaderFlight *flight = NULL;
+	g_autofree gchar *key = NULL;
 	g_autoptr(GTask) task = NULL;
 	g_autoptr(GCancellable) cancellable_job = g_cancellable_new ();
 
@@ -3383,6 +5359,18 @@ gs_plugin_loader_job_process_async (GsPluginLoader *plugin_loader,
 		return;
 	}
 
+	/* share the results of an identical job that is already running */
+	key = gs_plugin_job_get_key (plugin_job);
+	if (key != NULL) {
+		if (gs_plugin_loader_flight_join (plugin_loader, key,
+						  cancellable, callback, user_data,
+						  &flight))
+			return;
+		cancellable = flight->cancellable;
+		callback = gs_plugin_loader_flight_finished_cb;
+		user_data = flight;
+	}
+
 	/* hardcoded, so resolve a set list */
 	if (action == GS_PLUGIN_ACTION_GET_POPULAR) {
 		g_auto(GStrv) apps = NULL;
@@ -3490,12 +5478,27 @@ gs_plugin_loader_job_process_async (GsPluginLoader *plugin_loader,
 
 	/* save helper */
 	helper = gs_plugin_loader_helper_new (plugin_loader, plugin_job);
-	g_task_set_task_data (task, helper, (GDestroyNotify) gs_plugin_loader_helper_free);
+	g_task_set_task_data (task, helper, (GDestroyNotify) gs_plugin_loader_helper_unref);
+
+	/* the job ends when the result has been returned to the caller */
+	if (gs_trace_is_enabled ()) {
+		gs_trace_async_begin ("job",
+				      gs_plugin_action_to_string (gs_plugin_job_get_action (plugin_job)),
+				      task);
+		g_signal_connect (task, "notify::completed",
+				  G_CALLBACK (gs_plugin_loader_job_trace_completed_cb),
+				  NULL);
+	}
 
 	/* let the task cancel itself */
 	g_task_set_check_cancellable (task, FALSE);
 	g_task_set_return_on_cancel (task, FALSE);
 
+	/* results are streamed back to the calling thread */
+	if (gs_plugin_job_get_partial_func (plugin_job) != NULL &&
+	    gs_plugin_loader_action_is_concurrent (action))
+		helper->context = g_main_context_ref_thread_default ();
+
 	/* pre-tokenize search */
 	if (action == GS_PLUGIN_ACTION_SEARCH) {
 		const gchar *search = gs_plugin_job_get_search (plugin_job);
@@ -3539,8 +5542,9 @@ gs_plugin_loader_job_process_async (GsPluginLoader *plugin_loader,
 		break;
 	}
 
-	/* run in a thread */
-	g_task_run_in_thread (task, gs_plugin_loader_process_thread_cb);
+	/* run in a thread, ordered by priority */
+	gs_plugin_loader_job_run_in_thread (plugin_loader, task,
+					    gs_plugin_loader_process_thread_cb);
 }
 
 /******************************************************************************/
@@ -3611,4 +5615,137 @@ gs_plugin_loader_get_profile (GsPluginLoader *plugin_loader)
 	return priv->profile;
 }
 
+/**
+ * gs_plugin_loader_set_profile_mode:
+ * @plugin_loader: a #GsPluginLoader
+ * @profile_mode: %TRUE to record how much memory each job uses
+ *
+ * Enables recording the memory statistics shown by
+ * gs_plugin_loader_dump_memory(). They are also recorded when debugging
+ * or tracing is enabled.
+ *
+ * Since: 3.26
+ **/
+void
+gs_plugin_loader_set_profile_mode (GsPluginLoader *plugin_loader,
+				   gboolean profile_mode)
+{
+	GsPluginLoaderPrivate *priv = gs_plugin_loader_get_instance_private (plugin_loader);
+	g_atomic_int_set (&priv->profile_mode, profile_mode);
+}
+
+/**
+ * gs_plugin_loader_dump_memory:
+ * @plugin_loader: a #GsPluginLoader
+ *
+ * Prints how much memory the jobs run so far have used for each action,
+ * and how many applications each plugin created for them. This is meant to
+ * be shown along with the #AsProfile output.
+ *
+ * Since: 3.26
+ **/
+void
+gs_plugin_loader_dump_memory (GsPluginLoader *plugin_loader)
+{
+	GsPluginLoaderPrivate *priv = gs_plugin_loader_get_instance_private (plugin_loader);
+	g_autoptr(GHashTable) created = g_hash_table_new_full (g_str_hash, g_str_equal,
+							       g_free, g_free);
+	g_autoptr(GList) keys = NULL;
+	g_autoptr(GList) values = NULL;
+	g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&priv->stats_mutex);
+
+	g_print ("%-24s %6s %10s %10s %14s %14s\n",
+		 "action", "jobs", "apps", "apps-max", "held-max/kB", "rss-peak/kB");
+	for (guint i = 0; i < GS_PLUGIN_ACTION_LAST; i++) {
+		GsPluginLoaderMemory *memory = &priv->memory[i];
+		if (memory->jobs == 0)
+			continue;
+		g_print ("%-24s %6u %10" G_GUINT64_FORMAT " %10" G_GUINT64_FORMAT
+			 " %14" G_GUINT64_FORMAT " %14" G_GUINT64_FORMAT "\n",
+			 gs_plugin_action_to_string (i),
+			 memory->jobs,
+			 memory->apps_created,
+			 memory->apps_created_max,
+			 memory->bytes_held_max / 1024,
+			 memory->rss_peak_delta_max);
+	}
+
+	/* combine all the vfuncs of each plugin for each action */
+	values = g_hash_table_get_values (priv->stats);
+	for (GList *l = values; l != NULL; l = l->next) {
+		GsPluginLoaderStats *stats = l->data;
+		gchar *key;
+		guint64 *total;
+		if (stats->apps_created == 0)
+			continue;
+		key = g_strdup_printf ("%s:%s",
+				       gs_plugin_get_name (stats->plugin),
+				       gs_plugin_action_to_string (stats->action));
+		total = g_hash_table_lookup (created, key);
+		if (total == NULL) {
+			total = g_new0 (guint64, 1);
+			g_hash_table_insert (created, key, total);
+		} else {
+			g_free (key);
+		}
+		*total += stats->apps_created;
+	}
+	keys = g_hash_table_get_keys (created);
+	keys = g_list_sort (keys, (GCompareFunc) g_strcmp0);
+	for (GList *l = keys; l != NULL; l = l->next) {
+		guint64 *total = g_hash_table_lookup (created, l->data);
+		g_print ("%-45s %10" G_GUINT64_FORMAT " apps created\n",
+			 (const gchar *) l->data, *total);
+	}
+}
+
+/**
+ * gs_plugin_loader_get_stats:
+ * @plugin_loader: a #GsPluginLoader
+ *
+ * Gets the latency of each plugin vfunc that has been called, split by the
+ * action it was called for. The counts cover the lifetime of the loader and
+ * the percentiles cover only the most recent calls.
+ *
+ * The value has the type `a(sssuutttt)`, where each item is the plugin name,
+ * the vfunc, the action, the number of calls, the number of calls that
+ * failed, then the 50th, 95th and 99th percentile and maximum latency in
+ * microseconds.
+ *
+ * Returns: (transfer full): a #GVariant
+ *
+ * Since: 3.26
+ **/
+GVariant *
+gs_plugin_loader_get_stats (GsPluginLoader *plugin_loader)
+{
+	GsPluginLoaderPrivate *priv = gs_plugin_loader_get_instance_private (plugin_loader);
+	GVariantBuilder builder;
+	g_autoptr(GList) values = NULL;
+	g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&priv->stats_mutex);
+
+	g_variant_builder_init (&builder, G_VARIANT_TYPE ("a(sssuutttt)"));
+	values = g_hash_table_get_values (priv->stats);
+	for (GList *l = values; l != NULL; l = l->next) {
+		GsPluginLoaderStats *stats = l->data;
+		guint64 samples[GS_PLUGIN_LOADER_STATS_SAMPLES];
+		guint n = MIN (stats->count, GS_PLUGIN_LOADER_STATS_SAMPLES);
+
+		memcpy (samples, stats->samples, n * sizeof(guint64));
+		g_qsort_with_data (samples, n, sizeof(guint64),
+				   gs_plugin_loader_stats_sample_sort_cb, NULL);
+		g_variant_builder_add (&builder, "(sssuutttt)",
+				       gs_plugin_get_name (stats->plugin),
+				       gs_plugin_vfunc_to_string (stats->vfunc),
+				       gs_plugin_action_to_string (stats->action),
+				       stats->count,
+				       stats->errors,
+				       samples[(n - 1) * 50 / 100],
+				       samples[(n - 1) * 95 / 100],
+				       samples[(n - 1) * 99 / 100],
+				       stats->max);
+	}
+	return g_variant_ref_sink (g_variant_builder_end (&builder));
+}
+
 /* vim: set noexpandtab: */
@@ -74,6 +74,8 @@ gboolean	 gs_plugin_loader_setup			(GsPluginLoader	*plugin_loader,
 							 GsPluginFailureFlags failure_flags,
 							 GCancellable	*cancellable,
 							 GError		**error);
+void		 gs_plugin_loader_set_snapshot_enabled	(GsPluginLoader	*plugin_loader,
+							 gboolean	 snapshot_enabled);
 void		 gs_plugin_loader_dump_state		(GsPluginLoader	*plugin_loader);
 gboolean	 gs_plugin_loader_get_enabled		(GsPluginLoader	*plugin_loader,
 							 const gchar	*plugin_name);
@@ -100,6 +102,10 @@ GsPluginEvent	*gs_plugin_loader_get_event_default	(GsPluginLoader	*plugin_loader
 void		 gs_plugin_loader_remove_events		(GsPluginLoader	*plugin_loader);
 
 AsProfile	*gs_plugin_loader_get_profile		(GsPluginLoader	*plugin_loader);
+GVariant	*gs_plugin_loader_get_stats		(GsPluginLoader	*plugin_loader);
+void		 gs_plugin_loader_set_profile_mode	(GsPluginLoader	*plugin_loader,
+							 gboolean	 profile_mode);
+void		 gs_plugin_loader_dump_memory		(GsPluginLoader	*plugin_loader);
 GsApp		*gs_plugin_loader_app_create		(GsPluginLoader	*plugin_loader,
 							 const gchar	*unique_id);
 GsApp		*gs_plugin_loader_get_system_app	(GsPluginLoader	*plugin_loader);
@@ -31,6 +31,58 @@
 
 G_BEGIN_DECLS
 
+typedef enum {
+	GS_PLUGIN_VFUNC_INITIALIZE,
+	GS_PLUGIN_VFUNC_DESTROY,
+	GS_PLUGIN_VFUNC_SETUP,
+	GS_PLUGIN_VFUNC_ADOPT_APP,
+	GS_PLUGIN_VFUNC_REFINE,
+	GS_PLUGIN_VFUNC_REFINE_APP,
+	GS_PLUGIN_VFUNC_REFINE_WILDCARD,
+	GS_PLUGIN_VFUNC_REFRESH,
+	GS_PLUGIN_VFUNC_REVIEW_SUBMIT,
+	GS_PLUGIN_VFUNC_REVIEW_UPVOTE,
+	GS_PLUGIN_VFUNC_REVIEW_DOWNVOTE,
+	GS_PLUGIN_VFUNC_REVIEW_REPORT,
+	GS_PLUGIN_VFUNC_REVIEW_REMOVE,
+	GS_PLUGIN_VFUNC_REVIEW_DISMISS,
+	GS_PLUGIN_VFUNC_APP_INSTALL,
+	GS_PLUGIN_VFUNC_APP_REMOVE,
+	GS_PLUGIN_VFUNC_APP_SET_RATING,
+	GS_PLUGIN_VFUNC_APP_UPGRADE_DOWNLOAD,
+	GS_PLUGIN_VFUNC_APP_UPGRADE_TRIGGER,
+	GS_PLUGIN_VFUNC_APP_PURCHASE,
+	GS_PLUGIN_VFUNC_LAUNCH,
+	GS_PLUGIN_VFUNC_UPDATE_CANCEL,
+	GS_PLUGIN_VFUNC_ADD_SHORTCUT,
+	GS_PLUGIN_VFUNC_REMOVE_SHORTCUT,
+	GS_PLUGIN_VFUNC_UPDATE,
+	GS_PLUGIN_VFUNC_UPDATE_APP,
+	GS_PLUGIN_VFUNC_FILE_TO_APP,
+	GS_PLUGIN_VFUNC_URL_TO_APP,
+	GS_PLUGIN_VFUNC_ADD_DISTRO_UPGRADES,
+	GS_PLUGIN_VFUNC_ADD_SOURCES,
+	GS_PLUGIN_VFUNC_ADD_UNVOTED_REVIEWS,
+	GS_PLUGIN_VFUNC_ADD_INSTALLED,
+	GS_PLUGIN_VFUNC_ADD_FEATURED,
+	GS_PLUGIN_VFUNC_ADD_UPDATES_HISTORICAL,
+	GS_PLUGIN_VFUNC_ADD_UPDATES,
+	GS_PLUGIN_VFUNC_ADD_UPDATES_PENDING,
+	GS_PLUGIN_VFUNC_ADD_POPULAR,
+	GS_PLUGIN_VFUNC_ADD_RECENT,
+	GS_PLUGIN_VFUNC_ADD_SEARCH,
+	GS_PLUGIN_VFUNC_ADD_SEARCH_FILES,
+	GS_PLUGIN_VFUNC_ADD_SEARCH_WHAT_PROVIDES,
+	GS_PLUGIN_VFUNC_AUTH_LOGIN,
+	GS_PLUGIN_VFUNC_AUTH_LOGOUT,
+	GS_PLUGIN_VFUNC_AUTH_REGISTER,
+	GS_PLUGIN_VFUNC_AUTH_LOST_PASSWORD,
+	GS_PLUGIN_VFUNC_ADD_CATEGORY_APPS,
+	GS_PLUGIN_VFUNC_ADD_CATEGORIES,
+	/*< private >*/
+	GS_PLUGIN_VFUNC_LAST
+} GsPluginVfunc;
+
 GsPlugin	*gs_plugin_new				(void);
 GsPlugin	*gs_plugin_create			(const gchar	*filename,
 							 GError		**error);
@@ -38,6 +90,9 @@ const gchar	*gs_plugin_error_to_string		(GsPluginError	 error);
 const gchar	*gs_plugin_action_to_string		(GsPluginAction	 action);
 GsPluginAction	 gs_plugin_action_from_string		(const gchar	*action);
 const gchar	*gs_plugin_action_to_function_name	(GsPluginAction	 action);
+GsPluginVfunc	 gs_plugin_action_to_vfunc		(GsPluginAction	 action);
+const gchar	*gs_plugin_vfunc_to_string		(GsPluginVfunc	 vfunc);
+GsPluginVfunc	 gs_plugin_vfunc_from_string		(const gchar	*function_name);
 
 void		 gs_plugin_clear_data			(GsPlugin	*plugin);
 void		 gs_plugin_action_start			(GsPlugin	*plugin,
@@ -53,6 +108,11 @@ void		 gs_plugin_set_priority			(GsPlugin	*plugin,
 							 guint		 priority);
 void		 gs_plugin_set_name			(GsPlugin	*plugin,
 							 const gchar	*name);
+gboolean	 gs_plugin_rank_by_rules		(GPtrArray	*plugins,
+							 GsPluginRule	 rule_after,
+							 GsPluginRule	 rule_before,
+							 gboolean	 use_priority,
+							 GError		**error);
 void		 gs_plugin_set_locale			(GsPlugin	*plugin,
 							 const gchar	*locale);
 void		 gs_plugin_set_language			(GsPlugin	*plugin,
@@ -71,7 +131,15 @@ GPtrArray	*gs_plugin_get_rules			(GsPlugin	*plugin,
 							 GsPluginRule	 rule);
 gpointer	 gs_plugin_get_symbol			(GsPlugin	*plugin,
 							 const gchar	*function_name);
+gpointer	 gs_plugin_get_vfunc			(GsPlugin	*plugin,
+							 GsPluginVfunc	 vfunc);
 GType		 gs_plugin_get_app_gtype		(GsPlugin	*plugin);
+GsPluginRefineFlags gs_plugin_get_refine_flags		(GsPlugin	*plugin);
+guint		 gs_plugin_get_budget			(GsPlugin	*plugin,
+							 GsPluginAction	 action);
+void		 gs_plugin_set_setup_time		(GsPlugin	*plugin,
+							 guint		 setup_time);
+guint		 gs_plugin_get_setup_time		(GsPlugin	*plugin);
 gchar		*gs_plugin_failure_flags_to_string	(GsPluginFailureFlags failure_flags);
 gchar		*gs_plugin_refine_flags_to_string	(GsPluginRefineFlags refine_flags);
 
@@ -60,6 +60,8 @@ typedef enum {
  * @GS_PLUGIN_FLAGS_EXCLUSIVE:		An exclusive action is running
  * @GS_PLUGIN_FLAGS_RECENT:		This plugin recently ran
  * @GS_PLUGIN_FLAGS_GLOBAL_CACHE:	Use the global app cache
+ * @GS_PLUGIN_FLAGS_PARALLEL_REFINE:	gs_plugin_refine_app() is thread-safe
+ * @GS_PLUGIN_FLAGS_LAZY_SETUP:		Run gs_plugin_setup() on first use
  *
  * The flags for the plugin at this point in time.
  **/
@@ -69,6 +71,8 @@ typedef enum {
 #define GS_PLUGIN_FLAGS_EXCLUSIVE	(1u << 2)
 #define GS_PLUGIN_FLAGS_RECENT		(1u << 3)
 #define GS_PLUGIN_FLAGS_GLOBAL_CACHE	(1u << 4)
+#define GS_PLUGIN_FLAGS_PARALLEL_REFINE	(1u << 5)
+#define GS_PLUGIN_FLAGS_LAZY_SETUP	(1u << 6)
 typedef guint64 GsPluginFlags;
 
 /**
@@ -345,6 +349,23 @@ typedef enum {
 	GS_PLUGIN_FAILURE_FLAGS_LAST
 } GsPluginFailureFlags;
 
+/**
+ * GsPluginJobPriority:
+ * @GS_PLUGIN_JOB_PRIORITY_BACKGROUND:		Nobody is waiting for the results
+ * @GS_PLUGIN_JOB_PRIORITY_DEFAULT:		The default priority
+ * @GS_PLUGIN_JOB_PRIORITY_INTERACTIVE:		The user is waiting for the results
+ *
+ * The priority class of the job. Queued jobs with a higher priority are
+ * always started before queued jobs with a lower priority.
+ **/
+typedef enum {
+	GS_PLUGIN_JOB_PRIORITY_BACKGROUND,
+	GS_PLUGIN_JOB_PRIORITY_DEFAULT,
+	GS_PLUGIN_JOB_PRIORITY_INTERACTIVE,
+	/*< private >*/
+	GS_PLUGIN_JOB_PRIORITY_LAST
+} GsPluginJobPriority;
+
 G_END_DECLS
 
 #endif /* __GS_PLUGIN_TYPES_H */
@@ -52,10 +52,12 @@
 #include <valgrind.h>
 #endif
 
+#include "gs-app-private.h"
 #include "gs-app-list-private.h"
 #include "gs-os-release.h"
 #include "gs-plugin-private.h"
 #include "gs-plugin.h"
+#include "gs-trace.h"
 #include "gs-utils.h"
 
 typedef struct
@@ -67,12 +69,11 @@ typedef struct
 	GModule			*module;
 	GRWLock			 rwlock;
 	GsPluginData		*data;			/* for gs-plugin-{name}.c */
-	GsPluginFlags		 flags;
+	GsPluginFlags		 flags;			/* atomic */
 	SoupSession		*soup_session;
 	GsAppList		*global_cache;
 	GPtrArray		*rules[GS_PLUGIN_RULE_LAST];
-	GHashTable		*vfuncs;		/* string:pointer */
-	GMutex			 vfuncs_mutex;
+	gpointer		 vfuncs[GS_PLUGIN_VFUNC_LAST];
 	gboolean		 enabled;
 	GType			 app_gtype;
 	gchar			*locale;		/* allow-none */
@@ -82,10 +83,56 @@ typedef struct
 	guint			 scale;
 	guint			 order;
 	guint			 priority;
-	guint			 timer_id;
-	GMutex			 timer_mutex;
+	gint			 last_active;		/* monotonic, in seconds */
+	GsPluginRefineFlags	 refine_flags;		/* handled, or 0 for all */
+	guint			 budgets[GS_PLUGIN_ACTION_LAST];	/* ms */
+	guint			 setup_time;		/* ms */
 } GsPluginPrivate;
 
+/* the flags are changed by plugins running concurrently on the loader */
+#ifdef __ATOMIC_RELAXED
+#define gs_plugin_flags_get(ptr)	__atomic_load_n ((ptr), __ATOMIC_RELAXED)
+#define gs_plugin_flags_set(ptr, val)	__atomic_store_n ((ptr), (val), __ATOMIC_RELAXED)
+#define gs_plugin_flags_or(ptr, val)	__atomic_fetch_or ((ptr), (val), __ATOMIC_RELAXED)
+#define gs_plugin_flags_and(ptr, val)	__atomic_fetch_and ((ptr), (val), __ATOMIC_RELAXED)
+#else
+static GMutex gs_plugin_flags_mutex;
+
+static GsPluginFlags
+gs_plugin_flags_get (GsPluginFlags *ptr)
+{
+	GsPluginFlags val;
+	g_mutex_lock (&gs_plugin_flags_mutex);
+	val = *ptr;
+	g_mutex_unlock (&gs_plugin_flags_mutex);
+	return val;
+}
+
+static void
+gs_plugin_flags_set (GsPluginFlags *ptr, GsPluginFlags val)
+{
+	g_mutex_lock (&gs_plugin_flags_mutex);
+	*ptr = val;
+	g_mutex_unlock (&gs_plugin_flags_mutex);
+}
+
+static void
+gs_plugin_flags_or (GsPluginFlags *ptr, GsPluginFlags val)
+{
+	g_mutex_lock (&gs_plugin_flags_mutex);
+	*ptr |= val;
+	g_mutex_unlock (&gs_plugin_flags_mutex);
+}
+
+static void
+gs_plugin_flags_and (GsPluginFlags *ptr, GsPluginFlags val)
+{
+	g_mutex_lock (&gs_plugin_flags_mutex);
+	*ptr &= val;
+	g_mutex_unlock (&gs_plugin_flags_mutex);
+}
+#endif
+
 G_DEFINE_TYPE_WITH_PRIVATE (GsPlugin, gs_plugin, G_TYPE_OBJECT)
 
 G_DEFINE_QUARK (gs-plugin-error-quark, gs_plugin_error)
@@ -203,6 +250,13 @@ gs_plugin_create (const gchar *filename, GError **error)
 		return NULL;
 	}
 	gs_plugin_set_name (plugin, basename + 13);
+
+	/* resolve all the vfuncs once so dispatch never touches the module */
+	for (guint i = 0; i < GS_PLUGIN_VFUNC_LAST; i++) {
+		g_module_symbol (priv->module,
+				 gs_plugin_vfunc_to_string (i),
+				 &priv->vfuncs[i]);
+	}
 	return plugin;
 }
 
@@ -216,8 +270,6 @@ gs_plugin_finalize (GObject *object)
 	for (i = 0; i < GS_PLUGIN_RULE_LAST; i++)
 		g_ptr_array_unref (priv->rules[i]);
 
-	if (priv->timer_id > 0)
-		g_source_remove (priv->timer_id);
 	g_free (priv->name);
 	g_free (priv->appstream_id);
 	g_free (priv->data);
@@ -232,10 +284,7 @@ gs_plugin_finalize (GObject *object)
 	if (priv->global_cache != NULL)
 		g_object_unref (priv->global_cache);
 	g_hash_table_unref (priv->cache);
-	g_hash_table_unref (priv->vfuncs);
 	g_mutex_clear (&priv->cache_mutex);
-	g_mutex_clear (&priv->timer_mutex);
-	g_mutex_clear (&priv->vfuncs_mutex);
 #ifndef RUNNING_ON_VALGRIND
 	if (priv->module != NULL)
 		g_module_close (priv->module);
@@ -312,6 +361,7 @@ void
 gs_plugin_action_start (GsPlugin *plugin, gboolean exclusive)
 {
 	GsPluginPrivate *priv = gs_plugin_get_instance_private (plugin);
+	gint64 ts_trace = gs_trace_begin ();
 
 	/* lock plugin */
 	if (exclusive) {
@@ -320,24 +370,15 @@ gs_plugin_action_start (GsPlugin *plugin, gboolean exclusive)
 	} else {
 		g_rw_lock_reader_lock (&priv->rwlock);
 	}
+	gs_trace_end (ts_trace, "lock", "gs_plugin_action_start",
+		      "plugin", priv->name,
+		      "exclusive", exclusive ? "true" : "false",
+		      NULL);
 
 	/* set plugin as SELF */
 	gs_plugin_add_flags (plugin, GS_PLUGIN_FLAGS_RUNNING_SELF);
 }
 
-static gboolean
-gs_plugin_action_delay_cb (gpointer user_data)
-{
-	GsPlugin *plugin = GS_PLUGIN (user_data);
-	GsPluginPrivate *priv = gs_plugin_get_instance_private (plugin);
-	g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&priv->timer_mutex);
-
-	g_debug ("plugin no longer recently active: %s", priv->name);
-	gs_plugin_remove_flags (plugin, GS_PLUGIN_FLAGS_RECENT);
-	priv->timer_id = 0;
-	return FALSE;
-}
-
 /**
  * gs_plugin_action_stop:
  * @plugin: a #GsPlugin
@@ -350,26 +391,55 @@ void
 gs_plugin_action_stop (GsPlugin *plugin)
 {
 	GsPluginPrivate *priv = gs_plugin_get_instance_private (plugin);
-	g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&priv->timer_mutex);
 
 	/* clear plugin as SELF */
 	gs_plugin_remove_flags (plugin, GS_PLUGIN_FLAGS_RUNNING_SELF);
 
 	/* unlock plugin */
-	if (priv->flags & GS_PLUGIN_FLAGS_EXCLUSIVE) {
+	if (gs_plugin_flags_get (&priv->flags) & GS_PLUGIN_FLAGS_EXCLUSIVE) {
 		g_rw_lock_writer_unlock (&priv->rwlock);
 		gs_plugin_remove_flags (plugin, GS_PLUGIN_FLAGS_EXCLUSIVE);
 	} else {
 		g_rw_lock_reader_unlock (&priv->rwlock);
 	}
 
-	/* unset this flag after 5 seconds */
-	gs_plugin_add_flags (plugin, GS_PLUGIN_FLAGS_RECENT);
-	if (priv->timer_id > 0)
-		g_source_remove (priv->timer_id);
-	priv->timer_id = g_timeout_add (5000,
-					gs_plugin_action_delay_cb,
-					plugin);
+	/* GS_PLUGIN_FLAGS_RECENT is derived from this */
+	g_atomic_int_set (&priv->last_active,
+			  (gint) (g_get_monotonic_time () / G_USEC_PER_SEC));
+}
+
+/* the plugin was active in the last 5 seconds */
+static gboolean
+gs_plugin_is_recently_active (GsPlugin *plugin)
+{
+	GsPluginPrivate *priv = gs_plugin_get_instance_private (plugin);
+	gint last_active = g_atomic_int_get (&priv->last_active);
+	if (last_active == 0)
+		return FALSE;
+	return (g_get_monotonic_time () / G_USEC_PER_SEC) - last_active < 5;
+}
+
+/**
+ * gs_plugin_get_vfunc (skip):
+ * @plugin: a #GsPlugin
+ * @vfunc: a #GsPluginVfunc, e.g. %GS_PLUGIN_VFUNC_REFINE_APP
+ *
+ * Gets the vfunc resolved from the module when the plugin was created.
+ * If the plugin is not enabled then no function is returned.
+ *
+ * Returns: the pointer to the function, or %NULL
+ **/
+gpointer
+gs_plugin_get_vfunc (GsPlugin *plugin, GsPluginVfunc vfunc)
+{
+	GsPluginPrivate *priv = gs_plugin_get_instance_private (plugin);
+
+	g_return_val_if_fail (vfunc < GS_PLUGIN_VFUNC_LAST, NULL);
+
+	/* disabled plugins shouldn't be checked */
+	if (!priv->enabled)
+		return NULL;
+	return priv->vfuncs[vfunc];
 }
 
 /**
@@ -387,8 +457,8 @@ gpointer
 gs_plugin_get_symbol (GsPlugin *plugin, const gchar *function_name)
 {
 	GsPluginPrivate *priv = gs_plugin_get_instance_private (plugin);
+	GsPluginVfunc vfunc;
 	gpointer func = NULL;
-	g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&priv->vfuncs_mutex);
 
 	g_return_val_if_fail (function_name != NULL, NULL);
 
@@ -396,14 +466,14 @@ gs_plugin_get_symbol (GsPlugin *plugin, const gchar *function_name)
 	if (!priv->enabled)
 		return NULL;
 
-	/* look up the symbol from the cache */
-	if (g_hash_table_lookup_extended (priv->vfuncs, function_name, NULL, &func))
-		return func;
+	/* already resolved */
+	vfunc = gs_plugin_vfunc_from_string (function_name);
+	if (vfunc != GS_PLUGIN_VFUNC_LAST)
+		return priv->vfuncs[vfunc];
 
 	/* look up the symbol using the elf headers */
-	g_module_symbol (priv->module, function_name, &func);
-	g_hash_table_insert (priv->vfuncs, g_strdup (function_name), func);
-
+	if (priv->module != NULL)
+		g_module_symbol (priv->module, function_name, &func);
 	return func;
 }
 
@@ -545,6 +615,113 @@ gs_plugin_set_appstream_id (GsPlugin *plugin, const gchar *appstream_id)
 	priv->appstream_id = g_strdup (appstream_id);
 }
 
+/**
+ * gs_plugin_add_refine_flags:
+ * @plugin: a #GsPlugin
+ * @refine_flags: a #GsPluginRefineFlags, e.g. %GS_PLUGIN_REFINE_FLAGS_REQUIRE_ICON
+ *
+ * Declares the refine flags the plugin handles. If any flags are declared
+ * then the refine vfuncs are only called when the refine request includes
+ * at least one of them.
+ *
+ * This should be called from gs_plugin_initialize() and only by plugins
+ * that do nothing when none of the declared flags are requested.
+ *
+ * Since: 3.26
+ **/
+void
+gs_plugin_add_refine_flags (GsPlugin *plugin, GsPluginRefineFlags refine_flags)
+{
+	GsPluginPrivate *priv = gs_plugin_get_instance_private (plugin);
+	priv->refine_flags |= refine_flags;
+}
+
+/**
+ * gs_plugin_get_refine_flags:
+ * @plugin: a #GsPlugin
+ *
+ * Gets the refine flags the plugin handles.
+ *
+ * Returns: a #GsPluginRefineFlags, or 0 if the plugin handles all requests
+ **/
+GsPluginRefineFlags
+gs_plugin_get_refine_flags (GsPlugin *plugin)
+{
+	GsPluginPrivate *priv = gs_plugin_get_instance_private (plugin);
+	return priv->refine_flags;
+}
+
+/**
+ * gs_plugin_set_budget:
+ * @plugin: a #GsPlugin
+ * @action: a #GsPluginAction, e.g. %GS_PLUGIN_ACTION_SEARCH
+ * @budget_ms: the time budget in milliseconds, or 0 for none
+ *
+ * Sets how long interactive jobs should wait for the plugin to complete
+ * @action. When the plugin takes longer, and nothing else is left to do,
+ * the job completes without it and the plugin is left to finish in the
+ * background. Any results returned late are discarded, although any data
+ * added to existing applications is kept.
+ *
+ * This should be called from gs_plugin_initialize() and only by plugins
+ * that depend on slow or unreliable services.
+ *
+ * Since: 3.26
+ **/
+void
+gs_plugin_set_budget (GsPlugin *plugin, GsPluginAction action, guint budget_ms)
+{
+	GsPluginPrivate *priv = gs_plugin_get_instance_private (plugin);
+	g_return_if_fail (action < GS_PLUGIN_ACTION_LAST);
+	priv->budgets[action] = budget_ms;
+}
+
+/**
+ * gs_plugin_get_budget:
+ * @plugin: a #GsPlugin
+ * @action: a #GsPluginAction, e.g. %GS_PLUGIN_ACTION_SEARCH
+ *
+ * Gets the time budget for the action.
+ *
+ * Returns: the time budget in milliseconds, or 0 for none
+ **/
+guint
+gs_plugin_get_budget (GsPlugin *plugin, GsPluginAction action)
+{
+	GsPluginPrivate *priv = gs_plugin_get_instance_private (plugin);
+	g_return_val_if_fail (action < GS_PLUGIN_ACTION_LAST, 0);
+	return priv->budgets[action];
+}
+
+/**
+ * gs_plugin_set_setup_time:
+ * @plugin: a #GsPlugin
+ * @setup_time: the time in milliseconds
+ *
+ * Sets how long gs_plugin_setup() took to run.
+ **/
+void
+gs_plugin_set_setup_time (GsPlugin *plugin, guint setup_time)
+{
+	GsPluginPrivate *priv = gs_plugin_get_instance_private (plugin);
+	priv->setup_time = setup_time;
+}
+
+/**
+ * gs_plugin_get_setup_time:
+ * @plugin: a #GsPlugin
+ *
+ * Gets how long gs_plugin_setup() took to run.
+ *
+ * Returns: the time in milliseconds, or 0 if not run
+ **/
+guint
+gs_plugin_get_setup_time (GsPlugin *plugin)
+{
+	GsPluginPrivate *priv = gs_plugin_get_instance_private (plugin);
+	return priv->setup_time;
+}
+
 /**
  * gs_plugin_get_scale:
  * @plugin: a #GsPlugin
@@ -873,7 +1050,11 @@ gboolean
 gs_plugin_has_flags (GsPlugin *plugin, GsPluginFlags flags)
 {
 	GsPluginPrivate *priv = gs_plugin_get_instance_private (plugin);
-	return (priv->flags & flags) > 0;
+	if ((gs_plugin_flags_get (&priv->flags) & flags) > 0)
+		return TRUE;
+	if (flags & GS_PLUGIN_FLAGS_RECENT)
+		return gs_plugin_is_recently_active (plugin);
+	return FALSE;
 }
 
 /**
@@ -889,7 +1070,7 @@ void
 gs_plugin_add_flags (GsPlugin *plugin, GsPluginFlags flags)
 {
 	GsPluginPrivate *priv = gs_plugin_get_instance_private (plugin);
-	priv->flags |= flags;
+	gs_plugin_flags_or (&priv->flags, flags);
 }
 
 /**
@@ -905,7 +1086,7 @@ void
 gs_plugin_remove_flags (GsPlugin *plugin, GsPluginFlags flags)
 {
 	GsPluginPrivate *priv = gs_plugin_get_instance_private (plugin);
-	priv->flags &= ~flags;
+	gs_plugin_flags_and (&priv->flags, ~flags);
 }
 
 /**
@@ -966,6 +1147,160 @@ gs_plugin_get_rules (GsPlugin *plugin, GsPluginRule rule)
 	return priv->rules[rule];
 }
 
+/**
+ * gs_plugin_rank_by_rules:
+ * @plugins: (element-type GsPlugin): the plugins to rank
+ * @rule_after: a #GsPluginRule naming the plugins to run before
+ * @rule_before: a #GsPluginRule naming the plugins to run after, or
+ *  %GS_PLUGIN_RULE_LAST
+ * @use_priority: %TRUE to set the priority rather than the order
+ * @error: A #GError, or %NULL
+ *
+ * Ranks the enabled plugins so that each one is strictly after the ones it
+ * depends on through @rule_after, and strictly before the ones it names in
+ * @rule_before, keeping any existing value that is already higher.
+ *
+ * Returns: %TRUE for success, or %FALSE if the rules form a loop
+ *
+ * Since: 3.26
+ **/
+gboolean
+gs_plugin_rank_by_rules (GPtrArray *plugins,
+			 GsPluginRule rule_after,
+			 GsPluginRule rule_before,
+			 gboolean use_priority,
+			 GError **error)
+{
+	GsPluginRule rules[] = { rule_after, rule_before };
+	guint n = plugins->len;
+	guint done = 0;
+	g_autofree guint *rank = g_new0 (guint, n);
+	g_autofree guint *npreds = g_new0 (guint, n);
+	g_autofree guint *queue = g_new0 (guint, n);
+	g_autoptr(GHashTable) idx_by_name = g_hash_table_new (g_str_hash, g_str_equal);
+	g_autoptr(GPtrArray) succs = g_ptr_array_new_with_free_func ((GDestroyNotify) g_array_unref);
+	g_autoptr(GPtrArray) preds = g_ptr_array_new_with_free_func ((GDestroyNotify) g_array_unref);
+
+	for (guint i = 0; i < n; i++) {
+		GsPlugin *plugin = g_ptr_array_index (plugins, i);
+		g_hash_table_insert (idx_by_name,
+				     (gpointer) gs_plugin_get_name (plugin),
+				     GUINT_TO_POINTER (i));
+		rank[i] = use_priority ? gs_plugin_get_priority (plugin) :
+					 gs_plugin_get_order (plugin);
+		g_ptr_array_add (succs, g_array_new (FALSE, FALSE, sizeof(guint)));
+		g_ptr_array_add (preds, g_array_new (FALSE, FALSE, sizeof(guint)));
+	}
+
+	/* add an edge for each rule where the other plugin can be used */
+	for (guint i = 0; i < n; i++) {
+		GsPlugin *plugin = g_ptr_array_index (plugins, i);
+		for (guint k = 0; k < G_N_ELEMENTS (rules); k++) {
+			GPtrArray *deps;
+			if (rules[k] == GS_PLUGIN_RULE_LAST)
+				continue;
+			deps = gs_plugin_get_rules (plugin, rules[k]);
+			for (guint j = 0; j < deps->len; j++) {
+				const gchar *plugin_name = g_ptr_array_index (deps, j);
+				gpointer value;
+				guint from, to;
+				if (!g_hash_table_lookup_extended (idx_by_name, plugin_name,
+								   NULL, &value)) {
+					g_debug ("cannot find plugin '%s' "
+						 "requested by '%s'",
+						 plugin_name,
+						 gs_plugin_get_name (plugin));
+					continue;
+				}
+				if (!gs_plugin_get_enabled (g_ptr_array_index (plugins,
+									       GPOINTER_TO_UINT (value))))
+					continue;
+				from = k == 0 ? GPOINTER_TO_UINT (value) : i;
+				to = k == 0 ? i : GPOINTER_TO_UINT (value);
+				g_array_append_val (g_ptr_array_index (succs, from), to);
+				g_array_append_val (g_ptr_array_index (preds, to), from);
+				npreds[to]++;
+			}
+		}
+	}
+
+	/* Kahn's algorithm, which visits in plugin order for repeatability */
+	for (guint i = 0; i < n; i++) {
+		if (npreds[i] == 0)
+			queue[done++] = i;
+	}
+	for (guint head = 0; head < done; head++) {
+		guint from = queue[head];
+		GArray *edges = g_ptr_array_index (succs, from);
+		for (guint j = 0; j < edges->len; j++) {
+			guint to = g_array_index (edges, guint, j);
+			rank[to] = MAX (rank[to], rank[from] + 1);
+			if (--npreds[to] == 0)
+				queue[done++] = to;
+		}
+	}
+
+	/* anything left over is in or after a cycle, so walk back through the
+	 * unvisited plugins until one repeats to find the loop itself */
+	if (done < n) {
+		guint cur = G_MAXUINT;
+		g_autofree guint *seen = g_new0 (guint, n);
+		g_autoptr(GArray) path = g_array_new (FALSE, FALSE, sizeof(guint));
+		g_autoptr(GString) str = g_string_new (NULL);
+
+		for (guint i = 0; i < n && cur == G_MAXUINT; i++) {
+			if (npreds[i] > 0)
+				cur = i;
+		}
+		while (seen[cur] == 0) {
+			GArray *edges = g_ptr_array_index (preds, cur);
+			g_array_append_val (path, cur);
+			seen[cur] = path->len;
+			for (guint j = 0; j < edges->len; j++) {
+				guint from = g_array_index (edges, guint, j);
+				if (npreds[from] > 0) {
+					cur = from;
+					break;
+				}
+			}
+		}
+
+		/* the walk went backwards, so print it the other way round */
+		g_string_append (str, gs_plugin_get_name (g_ptr_array_index (plugins, cur)));
+		for (guint i = path->len; i >= seen[cur]; i--) {
+			guint idx = g_array_index (path, guint, i - 1);
+			g_string_append_printf (str, " -> %s",
+						gs_plugin_get_name (g_ptr_array_index (plugins, idx)));
+		}
+		g_set_error (error,
+			     GS_PLUGIN_ERROR,
+			     GS_PLUGIN_ERROR_PLUGIN_DEPSOLVE_FAILED,
+			     "plugin %s rules form a loop: %s",
+			     use_priority ? "priority" : "order",
+			     str->str);
+		return FALSE;
+	}
+
+	/* save the new values */
+	for (guint i = 0; i < n; i++) {
+		GsPlugin *plugin = g_ptr_array_index (plugins, i);
+		if (use_priority) {
+			if (rank[i] != gs_plugin_get_priority (plugin)) {
+				g_debug ("promoting %s to priority [%u]",
+					 gs_plugin_get_name (plugin), rank[i]);
+				gs_plugin_set_priority (plugin, rank[i]);
+			}
+		} else {
+			if (rank[i] != gs_plugin_get_order (plugin)) {
+				g_debug ("promoting %s to order [%u]",
+					 gs_plugin_get_name (plugin), rank[i]);
+				gs_plugin_set_order (plugin, rank[i]);
+			}
+		}
+	}
+	return TRUE;
+}
+
 /**
  * gs_plugin_check_distro_id:
  * @plugin: a #GsPlugin
@@ -1226,6 +1561,7 @@ gs_plugin_download_data (GsPlugin *plugin,
 {
 	GsPluginPrivate *priv = gs_plugin_get_instance_private (plugin);
 	GsPluginDownloadHelper helper;
+	gint64 ts_trace;
 	guint status_code;
 	g_autoptr(SoupMessage) msg = NULL;
 
@@ -1261,7 +1597,12 @@ gs_plugin_download_data (GsPlugin *plugin,
 				  G_CALLBACK (gs_plugin_download_chunk_cb),
 				  &helper);
 	}
+	ts_trace = gs_trace_begin ();
 	status_code = soup_session_send_message (priv->soup_session, msg);
+	gs_trace_end (ts_trace, "download", G_STRFUNC,
+		      "plugin", priv->name,
+		      "uri", uri,
+		      NULL);
 	if (status_code != SOUP_STATUS_OK) {
 		g_autoptr(GString) str = g_string_new (NULL);
 		g_string_append (str, soup_status_get_phrase (status_code));
@@ -1305,6 +1646,7 @@ gs_plugin_download_file (GsPlugin *plugin,
 {
 	GsPluginPrivate *priv = gs_plugin_get_instance_private (plugin);
 	GsPluginDownloadHelper helper;
+	gint64 ts_trace;
 	guint status_code;
 	g_autoptr(GError) error_local = NULL;
 	g_autoptr(SoupMessage) msg = NULL;
@@ -1356,7 +1698,12 @@ gs_plugin_download_file (GsPlugin *plugin,
 				  G_CALLBACK (gs_plugin_download_chunk_cb),
 				  &helper);
 	}
+	ts_trace = gs_trace_begin ();
 	status_code = soup_session_send_message (priv->soup_session, msg);
+	gs_trace_end (ts_trace, "download", G_STRFUNC,
+		      "plugin", priv->name,
+		      "uri", uri,
+		      NULL);
 	if (status_code != SOUP_STATUS_OK) {
 		g_autoptr(GString) str = g_string_new (NULL);
 		g_string_append (str, soup_status_get_phrase (status_code));
@@ -1626,10 +1973,16 @@ void
 gs_plugin_cache_invalidate (GsPlugin *plugin)
 {
 	GsPluginPrivate *priv = gs_plugin_get_instance_private (plugin);
+	GHashTableIter iter;
+	gpointer value;
 	g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&priv->cache_mutex);
 
 	g_return_if_fail (GS_IS_PLUGIN (plugin));
 
+	/* any cached data the apps were refined with is now stale */
+	g_hash_table_iter_init (&iter, priv->cache);
+	while (g_hash_table_iter_next (&iter, NULL, &value))
+		gs_app_clear_refined_flags (GS_APP (value));
 	g_hash_table_remove_all (priv->cache);
 }
 
@@ -1725,6 +2078,192 @@ gs_plugin_error_to_string (GsPluginError error)
 	return NULL;
 }
 
+static const gchar *vfunc_names[GS_PLUGIN_VFUNC_LAST] = {
+	"gs_plugin_initialize",				/* initialize */
+	"gs_plugin_destroy",				/* destroy */
+	"gs_plugin_setup",				/* setup */
+	"gs_plugin_adopt_app",				/* adopt-app */
+	"gs_plugin_refine",				/* refine */
+	"gs_plugin_refine_app",				/* refine-app */
+	"gs_plugin_refine_wildcard",			/* refine-wildcard */
+	"gs_plugin_refresh",				/* refresh */
+	"gs_plugin_review_submit",			/* review-submit */
+	"gs_plugin_review_upvote",			/* review-upvote */
+	"gs_plugin_review_downvote",			/* review-downvote */
+	"gs_plugin_review_report",			/* review-report */
+	"gs_plugin_review_remove",			/* review-remove */
+	"gs_plugin_review_dismiss",			/* review-dismiss */
+	"gs_plugin_app_install",			/* app-install */
+	"gs_plugin_app_remove",				/* app-remove */
+	"gs_plugin_app_set_rating",			/* app-set-rating */
+	"gs_plugin_app_upgrade_download",		/* app-upgrade-download */
+	"gs_plugin_app_upgrade_trigger",		/* app-upgrade-trigger */
+	"gs_plugin_app_purchase",			/* app-purchase */
+	"gs_plugin_launch",				/* launch */
+	"gs_plugin_update_cancel",			/* update-cancel */
+	"gs_plugin_add_shortcut",			/* add-shortcut */
+	"gs_plugin_remove_shortcut",			/* remove-shortcut */
+	"gs_plugin_update",				/* update */
+	"gs_plugin_update_app",				/* update-app */
+	"gs_plugin_file_to_app",			/* file-to-app */
+	"gs_plugin_url_to_app",				/* url-to-app */
+	"gs_plugin_add_distro_upgrades",		/* add-distro-upgrades */
+	"gs_plugin_add_sources",			/* add-sources */
+	"gs_plugin_add_unvoted_reviews",		/* add-unvoted-reviews */
+	"gs_plugin_add_installed",			/* add-installed */
+	"gs_plugin_add_featured",			/* add-featured */
+	"gs_plugin_add_updates_historical",		/* add-updates-historical */
+	"gs_plugin_add_updates",			/* add-updates */
+	"gs_plugin_add_updates_pending",		/* add-updates-pending */
+	"gs_plugin_add_popular",			/* add-popular */
+	"gs_plugin_add_recent",				/* add-recent */
+	"gs_plugin_add_search",				/* add-search */
+	"gs_plugin_add_search_files",			/* add-search-files */
+	"gs_plugin_add_search_what_provides",		/* add-search-what-provides */
+	"gs_plugin_auth_login",				/* auth-login */
+	"gs_plugin_auth_logout",			/* auth-logout */
+	"gs_plugin_auth_register",			/* auth-register */
+	"gs_plugin_auth_lost_password",			/* auth-lost-password */
+	"gs_plugin_add_category_apps",			/* add-category-apps */
+	"gs_plugin_add_categories",			/* add-categories */
+};
+
+/**
+ * gs_plugin_vfunc_to_string:
+ * @vfunc: a #GsPluginVfunc, e.g. %GS_PLUGIN_VFUNC_REFINE_APP
+ *
+ * Converts the vfunc to the symbol name exported by the plugin.
+ *
+ * Returns: a string, or %NULL for invalid
+ **/
+const gchar *
+gs_plugin_vfunc_to_string (GsPluginVfunc vfunc)
+{
+	if (vfunc >= GS_PLUGIN_VFUNC_LAST)
+		return NULL;
+	return vfunc_names[vfunc];
+}
+
+/**
+ * gs_plugin_vfunc_from_string:
+ * @function_name: a symbol name, e.g. "gs_plugin_refine_app"
+ *
+ * Converts the symbol name to the enumerated vfunc.
+ *
+ * Returns: a #GsPluginVfunc, or %GS_PLUGIN_VFUNC_LAST for unknown
+ **/
+GsPluginVfunc
+gs_plugin_vfunc_from_string (const gchar *function_name)
+{
+	for (guint i = 0; i < GS_PLUGIN_VFUNC_LAST; i++) {
+		if (g_strcmp0 (function_name, vfunc_names[i]) == 0)
+			return i;
+	}
+	return GS_PLUGIN_VFUNC_LAST;
+}
+
+/**
+ * gs_plugin_action_to_vfunc:
+ * @action: a #GsPluginAction, e.g. %GS_PLUGIN_ACTION_REFINE
+ *
+ * Converts the action to the primary vfunc that implements it.
+ *
+ * Returns: a #GsPluginVfunc, or %GS_PLUGIN_VFUNC_LAST for invalid
+ **/
+GsPluginVfunc
+gs_plugin_action_to_vfunc (GsPluginAction action)
+{
+	switch (action) {
+	case GS_PLUGIN_ACTION_REFRESH:
+		return GS_PLUGIN_VFUNC_REFRESH;
+	case GS_PLUGIN_ACTION_REVIEW_SUBMIT:
+		return GS_PLUGIN_VFUNC_REVIEW_SUBMIT;
+	case GS_PLUGIN_ACTION_REVIEW_UPVOTE:
+		return GS_PLUGIN_VFUNC_REVIEW_UPVOTE;
+	case GS_PLUGIN_ACTION_REVIEW_DOWNVOTE:
+		return GS_PLUGIN_VFUNC_REVIEW_DOWNVOTE;
+	case GS_PLUGIN_ACTION_REVIEW_REPORT:
+		return GS_PLUGIN_VFUNC_REVIEW_REPORT;
+	case GS_PLUGIN_ACTION_REVIEW_REMOVE:
+		return GS_PLUGIN_VFUNC_REVIEW_REMOVE;
+	case GS_PLUGIN_ACTION_REVIEW_DISMISS:
+		return GS_PLUGIN_VFUNC_REVIEW_DISMISS;
+	case GS_PLUGIN_ACTION_INSTALL:
+		return GS_PLUGIN_VFUNC_APP_INSTALL;
+	case GS_PLUGIN_ACTION_REMOVE:
+		return GS_PLUGIN_VFUNC_APP_REMOVE;
+	case GS_PLUGIN_ACTION_SET_RATING:
+		return GS_PLUGIN_VFUNC_APP_SET_RATING;
+	case GS_PLUGIN_ACTION_UPGRADE_DOWNLOAD:
+		return GS_PLUGIN_VFUNC_APP_UPGRADE_DOWNLOAD;
+	case GS_PLUGIN_ACTION_UPGRADE_TRIGGER:
+		return GS_PLUGIN_VFUNC_APP_UPGRADE_TRIGGER;
+	case GS_PLUGIN_ACTION_LAUNCH:
+		return GS_PLUGIN_VFUNC_LAUNCH;
+	case GS_PLUGIN_ACTION_UPDATE_CANCEL:
+		return GS_PLUGIN_VFUNC_UPDATE_CANCEL;
+	case GS_PLUGIN_ACTION_ADD_SHORTCUT:
+		return GS_PLUGIN_VFUNC_ADD_SHORTCUT;
+	case GS_PLUGIN_ACTION_REMOVE_SHORTCUT:
+		return GS_PLUGIN_VFUNC_REMOVE_SHORTCUT;
+	case GS_PLUGIN_ACTION_REFINE:
+		return GS_PLUGIN_VFUNC_REFINE;
+	case GS_PLUGIN_ACTION_UPDATE:
+		return GS_PLUGIN_VFUNC_UPDATE;
+	case GS_PLUGIN_ACTION_FILE_TO_APP:
+		return GS_PLUGIN_VFUNC_FILE_TO_APP;
+	case GS_PLUGIN_ACTION_URL_TO_APP:
+		return GS_PLUGIN_VFUNC_URL_TO_APP;
+	case GS_PLUGIN_ACTION_GET_DISTRO_UPDATES:
+		return GS_PLUGIN_VFUNC_ADD_DISTRO_UPGRADES;
+	case GS_PLUGIN_ACTION_GET_SOURCES:
+		return GS_PLUGIN_VFUNC_ADD_SOURCES;
+	case GS_PLUGIN_ACTION_GET_UNVOTED_REVIEWS:
+		return GS_PLUGIN_VFUNC_ADD_UNVOTED_REVIEWS;
+	case GS_PLUGIN_ACTION_GET_INSTALLED:
+		return GS_PLUGIN_VFUNC_ADD_INSTALLED;
+	case GS_PLUGIN_ACTION_GET_FEATURED:
+		return GS_PLUGIN_VFUNC_ADD_FEATURED;
+	case GS_PLUGIN_ACTION_GET_UPDATES_HISTORICAL:
+		return GS_PLUGIN_VFUNC_ADD_UPDATES_HISTORICAL;
+	case GS_PLUGIN_ACTION_GET_UPDATES:
+		return GS_PLUGIN_VFUNC_ADD_UPDATES;
+	case GS_PLUGIN_ACTION_GET_POPULAR:
+		return GS_PLUGIN_VFUNC_ADD_POPULAR;
+	case GS_PLUGIN_ACTION_GET_RECENT:
+		return GS_PLUGIN_VFUNC_ADD_RECENT;
+	case GS_PLUGIN_ACTION_SEARCH:
+		return GS_PLUGIN_VFUNC_ADD_SEARCH;
+	case GS_PLUGIN_ACTION_SEARCH_FILES:
+		return GS_PLUGIN_VFUNC_ADD_SEARCH_FILES;
+	case GS_PLUGIN_ACTION_SEARCH_PROVIDES:
+		return GS_PLUGIN_VFUNC_ADD_SEARCH_WHAT_PROVIDES;
+	case GS_PLUGIN_ACTION_AUTH_LOGIN:
+		return GS_PLUGIN_VFUNC_AUTH_LOGIN;
+	case GS_PLUGIN_ACTION_AUTH_LOGOUT:
+		return GS_PLUGIN_VFUNC_AUTH_LOGOUT;
+	case GS_PLUGIN_ACTION_AUTH_REGISTER:
+		return GS_PLUGIN_VFUNC_AUTH_REGISTER;
+	case GS_PLUGIN_ACTION_AUTH_LOST_PASSWORD:
+		return GS_PLUGIN_VFUNC_AUTH_LOST_PASSWORD;
+	case GS_PLUGIN_ACTION_GET_CATEGORY_APPS:
+		return GS_PLUGIN_VFUNC_ADD_CATEGORY_APPS;
+	case GS_PLUGIN_ACTION_GET_CATEGORIES:
+		return GS_PLUGIN_VFUNC_ADD_CATEGORIES;
+	case GS_PLUGIN_ACTION_SETUP:
+		return GS_PLUGIN_VFUNC_SETUP;
+	case GS_PLUGIN_ACTION_INITIALIZE:
+		return GS_PLUGIN_VFUNC_INITIALIZE;
+	case GS_PLUGIN_ACTION_DESTROY:
+		return GS_PLUGIN_VFUNC_DESTROY;
+	case GS_PLUGIN_ACTION_PURCHASE:
+		return GS_PLUGIN_VFUNC_APP_PURCHASE;
+	default:
+		break;
+	}
+	return GS_PLUGIN_VFUNC_LAST;
+}
+
 /**
  * gs_plugin_action_to_function_name: (skip)
  * @action: a #GsPluginAction, e.g. %GS_PLUGIN_ERROR_NO_NETWORK
@@ -2128,7 +2667,7 @@ gs_plugin_set_property (GObject *object, guint prop_id, const GValue *value, GPa
 	GsPluginPrivate *priv = gs_plugin_get_instance_private (plugin);
 	switch (prop_id) {
 	case PROP_FLAGS:
-		priv->flags = g_value_get_uint64 (value);
+		gs_plugin_flags_set (&priv->flags, g_value_get_uint64 (value));
 		break;
 	default:
 		G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
@@ -2143,7 +2682,7 @@ gs_plugin_get_property (GObject *object, guint prop_id, GValue *value, GParamSpe
 	GsPluginPrivate *priv = gs_plugin_get_instance_private (plugin);
 	switch (prop_id) {
 	case PROP_FLAGS:
-		g_value_set_uint64 (value, priv->flags);
+		g_value_set_uint64 (value, gs_plugin_flags_get (&priv->flags));
 		break;
 	default:
 		G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
@@ -2218,11 +2757,7 @@ gs_plugin_init (GsPlugin *plugin)
 					     (GEqualFunc) as_utils_unique_id_equal,
 					     g_free,
 					     (GDestroyNotify) g_object_unref);
-	priv->vfuncs = g_hash_table_new_full (g_str_hash, g_str_equal,
-					      g_free, NULL);
 	g_mutex_init (&priv->cache_mutex);
-	g_mutex_init (&priv->timer_mutex);
-	g_mutex_init (&priv->vfuncs_mutex);
 	g_rw_lock_init (&priv->rwlock);
 }
 
@@ -82,6 +82,11 @@ gboolean	 gs_plugin_has_flags			(GsPlugin	*plugin,
 							 GsPluginFlags	 flags);
 void		 gs_plugin_add_flags			(GsPlugin	*plugin,
 							 GsPluginFlags	 flags);
+void		 gs_plugin_add_refine_flags		(GsPlugin	*plugin,
+							 GsPluginRefineFlags refine_flags);
+void		 gs_plugin_set_budget			(GsPlugin	*plugin,
+							 GsPluginAction	 action,
+							 guint		 budget_ms);
 void		 gs_plugin_remove_flags			(GsPlugin	*plugin,
 							 GsPluginFlags	 flags);
 guint		 gs_plugin_get_scale			(GsPlugin	*plugin);
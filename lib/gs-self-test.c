@@ -22,6 +22,7 @@
 #include "config.h"
 
 #include "gnome-software-private.h"
+#include "gs-plugin-job-private.h"
 
 #include "gs-test.h"
 
@@ -113,6 +114,42 @@ gs_utils_append_kv_func (void)
 	g_assert_cmpstr (str->str, ==, "key: val\n");
 }
 
+static gpointer
+gs_utils_intern_thread_cb (gpointer user_data)
+{
+	for (guint i = 0; i < 10000; i++) {
+		g_autofree gchar *tmp = g_strdup_printf ("origin%u", i % 64);
+		gs_utils_intern_unref (gs_utils_intern_ref (tmp));
+	}
+	return NULL;
+}
+
+static void
+gs_utils_intern_func (void)
+{
+	g_autoptr(GThread) thread1 = NULL;
+	g_autoptr(GThread) thread2 = NULL;
+	g_autofree gchar *tmp = g_strdup ("gnome");
+	const gchar *str1 = gs_utils_intern_ref ("gnome");
+	const gchar *str2 = gs_utils_intern_ref (tmp);
+
+	g_assert (str1 == str2);
+	g_assert (str1 != tmp);
+	g_assert_cmpstr (str1, ==, "gnome");
+	g_assert (gs_utils_intern_ref (NULL) == NULL);
+
+	/* the string must survive other threads using the same shard */
+	thread1 = g_thread_new ("thread1", gs_utils_intern_thread_cb, NULL);
+	thread2 = g_thread_new ("thread2", gs_utils_intern_thread_cb, NULL);
+	g_thread_join (g_steal_pointer (&thread1));
+	g_thread_join (g_steal_pointer (&thread2));
+	g_assert (gs_utils_intern_ref ("gnome") == str1);
+	gs_utils_intern_unref (str1);
+
+	gs_utils_intern_unref (str1);
+	gs_utils_intern_unref (str2);
+}
+
 static void
 gs_utils_cache_func (void)
 {
@@ -162,6 +199,109 @@ gs_utils_error_func (void)
 	g_assert_cmpstr (error->message, ==, "failed");
 }
 
+static gboolean
+gs_plugin_job_key_sort_cb (GsApp *app1, GsApp *app2, gpointer user_data)
+{
+	return g_strcmp0 (gs_app_get_id (app1), gs_app_get_id (app2));
+}
+
+static void
+gs_plugin_job_key_func (void)
+{
+	g_autofree gchar *key1 = NULL;
+	g_autofree gchar *key2 = NULL;
+	g_autofree gchar *key3 = NULL;
+	g_autofree gchar *key4 = NULL;
+	g_autofree gchar *key5 = NULL;
+	g_autofree gchar *key6 = NULL;
+	g_autofree gchar *key7 = NULL;
+	g_autofree gchar *key8 = NULL;
+	g_autoptr(GsApp) app = gs_app_new ("a");
+	g_autoptr(GsPluginJob) job1 = NULL;
+	g_autoptr(GsPluginJob) job2 = NULL;
+	g_autoptr(GsPluginJob) job3 = NULL;
+	g_autoptr(GsPluginJob) job4 = NULL;
+	g_autoptr(GsPluginJob) job5 = NULL;
+	g_autoptr(GsPluginJob) job6 = NULL;
+	g_autoptr(GsPluginJob) job7 = NULL;
+	g_autoptr(GsPluginJob) job8 = NULL;
+
+	/* identical searches share a key */
+	job1 = gs_plugin_job_newv (GS_PLUGIN_ACTION_SEARCH,
+				   "search", "gimp",
+				   "refine-flags", GS_PLUGIN_REFINE_FLAGS_REQUIRE_ICON,
+				   "max-results", 20,
+				   NULL);
+	job2 = gs_plugin_job_newv (GS_PLUGIN_ACTION_SEARCH,
+				   "search", "gimp",
+				   "refine-flags", GS_PLUGIN_REFINE_FLAGS_REQUIRE_ICON,
+				   "max-results", 20,
+				   NULL);
+	gs_plugin_job_set_sort_func (job1, gs_plugin_job_key_sort_cb);
+	gs_plugin_job_set_sort_func (job2, gs_plugin_job_key_sort_cb);
+	key1 = gs_plugin_job_get_key (job1);
+	key2 = gs_plugin_job_get_key (job2);
+	g_assert (key1 != NULL);
+	g_assert_cmpstr (key1, ==, key2);
+
+	/* different terms do not */
+	job3 = gs_plugin_job_newv (GS_PLUGIN_ACTION_SEARCH,
+				   "search", "inkscape",
+				   "refine-flags", GS_PLUGIN_REFINE_FLAGS_REQUIRE_ICON,
+				   "max-results", 20,
+				   NULL);
+	gs_plugin_job_set_sort_func (job3, gs_plugin_job_key_sort_cb);
+	key3 = gs_plugin_job_get_key (job3);
+	g_assert_cmpstr (key1, !=, key3);
+
+	/* nor does a different priority, timeout or way of failing */
+	job4 = gs_plugin_job_newv (GS_PLUGIN_ACTION_SEARCH,
+				   "search", "gimp",
+				   "refine-flags", GS_PLUGIN_REFINE_FLAGS_REQUIRE_ICON,
+				   "max-results", 20,
+				   "priority", GS_PLUGIN_JOB_PRIORITY_BACKGROUND,
+				   NULL);
+	gs_plugin_job_set_sort_func (job4, gs_plugin_job_key_sort_cb);
+	key4 = gs_plugin_job_get_key (job4);
+	g_assert_cmpstr (key1, !=, key4);
+	gs_plugin_job_set_priority (job4, gs_plugin_job_get_priority (job1));
+	gs_plugin_job_set_timeout (job4, 5);
+	key5 = gs_plugin_job_get_key (job4);
+	g_assert_cmpstr (key1, !=, key5);
+	job5 = gs_plugin_job_newv (GS_PLUGIN_ACTION_SEARCH,
+				   "search", "gimp",
+				   "refine-flags", GS_PLUGIN_REFINE_FLAGS_REQUIRE_ICON,
+				   "max-results", 20,
+				   "failure-flags", GS_PLUGIN_FAILURE_FLAGS_USE_EVENTS,
+				   NULL);
+	gs_plugin_job_set_sort_func (job5, gs_plugin_job_key_sort_cb);
+	key6 = gs_plugin_job_get_key (job5);
+	g_assert_cmpstr (key1, !=, key6);
+
+	/* nor a different number of results or sort order */
+	job6 = gs_plugin_job_newv (GS_PLUGIN_ACTION_SEARCH,
+				   "search", "gimp",
+				   "refine-flags", GS_PLUGIN_REFINE_FLAGS_REQUIRE_ICON,
+				   "max-results", 10,
+				   NULL);
+	gs_plugin_job_set_sort_func (job6, gs_plugin_job_key_sort_cb);
+	key7 = gs_plugin_job_get_key (job6);
+	g_assert_cmpstr (key1, !=, key7);
+	job7 = gs_plugin_job_newv (GS_PLUGIN_ACTION_SEARCH,
+				   "search", "gimp",
+				   "refine-flags", GS_PLUGIN_REFINE_FLAGS_REQUIRE_ICON,
+				   "max-results", 20,
+				   NULL);
+	key8 = gs_plugin_job_get_key (job7);
+	g_assert_cmpstr (key1, !=, key8);
+
+	/* jobs acting on an app are never shared */
+	job8 = gs_plugin_job_newv (GS_PLUGIN_ACTION_INSTALL,
+				   "app", app,
+				   NULL);
+	g_assert (gs_plugin_job_get_key (job8) == NULL);
+}
+
 static void
 gs_plugin_download_rewrite_func (void)
 {
@@ -191,6 +331,47 @@ gs_plugin_download_rewrite_func (void)
 	g_assert (css != NULL);
 }
 
+static void
+gs_plugin_rank_func (void)
+{
+	GsPlugin *plugin_a;
+	GsPlugin *plugin_b;
+	GsPlugin *plugin_c;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GPtrArray) plugins = g_ptr_array_new_with_free_func ((GDestroyNotify) g_object_unref);
+
+	plugin_a = gs_plugin_new ();
+	gs_plugin_set_name (plugin_a, "a");
+	g_ptr_array_add (plugins, plugin_a);
+	plugin_b = gs_plugin_new ();
+	gs_plugin_set_name (plugin_b, "b");
+	g_ptr_array_add (plugins, plugin_b);
+	plugin_c = gs_plugin_new ();
+	gs_plugin_set_name (plugin_c, "c");
+	g_ptr_array_add (plugins, plugin_c);
+
+	/* c runs after b, which runs after a */
+	gs_plugin_add_rule (plugin_b, GS_PLUGIN_RULE_RUN_AFTER, "a");
+	gs_plugin_add_rule (plugin_c, GS_PLUGIN_RULE_RUN_AFTER, "b");
+	g_assert (gs_plugin_rank_by_rules (plugins,
+					   GS_PLUGIN_RULE_RUN_AFTER,
+					   GS_PLUGIN_RULE_RUN_BEFORE,
+					   FALSE, &error));
+	g_assert_no_error (error);
+	g_assert_cmpint (gs_plugin_get_order (plugin_a), <, gs_plugin_get_order (plugin_b));
+	g_assert_cmpint (gs_plugin_get_order (plugin_b), <, gs_plugin_get_order (plugin_c));
+
+	/* a loop is reported rather than looping forever */
+	gs_plugin_add_rule (plugin_a, GS_PLUGIN_RULE_RUN_AFTER, "c");
+	g_assert (!gs_plugin_rank_by_rules (plugins,
+					    GS_PLUGIN_RULE_RUN_AFTER,
+					    GS_PLUGIN_RULE_RUN_BEFORE,
+					    FALSE, &error));
+	g_assert_error (error, GS_PLUGIN_ERROR, GS_PLUGIN_ERROR_PLUGIN_DEPSOLVE_FAILED);
+	g_assert (g_strstr_len (error->message, -1, "a -> ") != NULL ||
+		  g_strstr_len (error->message, -1, "b -> ") != NULL);
+}
+
 static void
 gs_plugin_global_cache_func (void)
 {
@@ -227,6 +408,16 @@ gs_plugin_global_cache_func (void)
 	g_assert (app2 != NULL);
 }
 
+static gint
+gs_plugin_list_sort_match_value_cb (GsApp *app1, GsApp *app2, gpointer user_data)
+{
+	if (gs_app_get_match_value (app1) < gs_app_get_match_value (app2))
+		return 1;
+	if (gs_app_get_match_value (app1) > gs_app_get_match_value (app2))
+		return -1;
+	return 0;
+}
+
 static void
 gs_plugin_func (void)
 {
@@ -247,6 +438,16 @@ gs_plugin_func (void)
 		if (tmp == NULL)
 			g_critical ("failed to convert %u", i);
 	}
+	for (guint i = 0; i < GS_PLUGIN_VFUNC_LAST; i++) {
+		const gchar *tmp = gs_plugin_vfunc_to_string (i);
+		g_assert (tmp != NULL);
+		g_assert_cmpint (gs_plugin_vfunc_from_string (tmp), ==, i);
+	}
+	for (guint i = 1; i < GS_PLUGIN_ACTION_LAST; i++) {
+		GsPluginVfunc vfunc = gs_plugin_action_to_vfunc (i);
+		g_assert_cmpstr (gs_plugin_vfunc_to_string (vfunc), ==,
+				 gs_plugin_action_to_function_name (i));
+	}
 
 	/* add a couple of duplicate IDs */
 	app = gs_app_new ("a");
@@ -474,6 +675,29 @@ gs_plugin_func (void)
 	g_assert_cmpint (gs_app_list_length (list), ==, 0);
 	g_assert_cmpint (gs_app_list_get_size_peak (list), ==, 3);
 	g_object_unref (list);
+
+	/* truncate to the best matches */
+	list = gs_app_list_new ();
+	for (guint i = 0; i < 6; i++) {
+		const guint match_values[] = { 3, 5, 1, 5, 2, 4 };
+		g_autofree gchar *id = g_strdup_printf ("%c", 'a' + i);
+		app = gs_app_new (id);
+		gs_app_set_match_value (app, match_values[i]);
+		gs_app_list_add (list, app);
+		g_object_unref (app);
+	}
+	list_remove = gs_app_list_truncate_sorted (list, 3, gs_plugin_list_sort_match_value_cb, NULL);
+	g_assert (gs_app_list_has_flag (list, GS_APP_LIST_FLAG_IS_TRUNCATED));
+	g_assert_cmpint (gs_app_list_length (list), ==, 3);
+	g_assert_cmpstr (gs_app_get_id (gs_app_list_index (list, 0)), ==, "b");
+	g_assert_cmpstr (gs_app_get_id (gs_app_list_index (list, 1)), ==, "d");
+	g_assert_cmpstr (gs_app_get_id (gs_app_list_index (list, 2)), ==, "f");
+	g_assert_cmpint (gs_app_list_length (list_remove), ==, 3);
+	g_assert_cmpstr (gs_app_get_id (gs_app_list_index (list_remove, 0)), ==, "a");
+	g_assert_cmpstr (gs_app_get_id (gs_app_list_index (list_remove, 1)), ==, "c");
+	g_assert_cmpstr (gs_app_get_id (gs_app_list_index (list_remove, 2)), ==, "e");
+	g_object_unref (list_remove);
+	g_object_unref (list);
 }
 
 static gpointer
@@ -509,6 +733,7 @@ static void
 gs_app_unique_id_func (void)
 {
 	g_autoptr(GsApp) app = gs_app_new (NULL);
+	g_autoptr(GsApp) app2 = NULL;
 	const gchar *unique_id;
 
 	unique_id = "system/flatpak/gnome/desktop/org.gnome.Software.desktop/master";
@@ -520,6 +745,10 @@ gs_app_unique_id_func (void)
 	g_assert_cmpint (gs_app_get_kind (app), ==, AS_APP_KIND_DESKTOP);
 	g_assert_cmpstr (gs_app_get_id (app), ==, "org.gnome.Software.desktop");
 	g_assert_cmpstr (gs_app_get_branch (app), ==, "master");
+
+	/* identifiers are shared between apps */
+	app2 = gs_app_new ("org.gnome.Software.desktop");
+	g_assert (gs_app_get_id (app2) == gs_app_get_id (app));
 }
 
 static void
@@ -536,14 +765,136 @@ gs_app_addons_func (void)
 	gs_app_remove_addon (app, addon);
 }
 
+static void
+gs_app_snapshot_func (void)
+{
+	g_autoptr(GsApp) app = gs_app_new ("gimp.desktop");
+	g_autoptr(GsApp) app2 = NULL;
+	g_autoptr(GVariant) snapshot = NULL;
+
+	/* not enough details to show */
+	g_assert (gs_app_to_snapshot (app) == NULL);
+
+	/* a package that can only be refined again using its sources */
+	gs_app_set_kind (app, AS_APP_KIND_DESKTOP);
+	gs_app_set_bundle_kind (app, AS_BUNDLE_KIND_PACKAGE);
+	gs_app_set_scope (app, AS_APP_SCOPE_SYSTEM);
+	gs_app_set_state (app, AS_APP_STATE_INSTALLED);
+	gs_app_set_name (app, GS_APP_QUALITY_NORMAL, "GIMP");
+	gs_app_set_summary (app, GS_APP_QUALITY_NORMAL, "Edit images");
+	gs_app_set_management_plugin (app, "packagekit");
+	gs_app_set_origin (app, "fedora");
+	gs_app_add_source (app, "gimp");
+	gs_app_add_source (app, "gimp-libs");
+	gs_app_add_category (app, "Graphics");
+	snapshot = g_variant_ref_sink (gs_app_to_snapshot (app));
+	g_assert (snapshot != NULL);
+
+	app2 = gs_app_new_from_snapshot (snapshot);
+	g_assert (app2 != NULL);
+	g_assert_cmpstr (gs_app_get_unique_id (app2), ==, gs_app_get_unique_id (app));
+	g_assert_cmpint (gs_app_get_state (app2), ==, AS_APP_STATE_INSTALLED);
+	g_assert_cmpstr (gs_app_get_name (app2), ==, "GIMP");
+	g_assert_cmpstr (gs_app_get_management_plugin (app2), ==, "packagekit");
+	g_assert_cmpstr (gs_app_get_origin (app2), ==, "fedora");
+	g_assert_cmpint (gs_app_get_sources (app2)->len, ==, 2);
+	g_assert_cmpstr (gs_app_get_source_default (app2), ==, "gimp");
+	g_assert (gs_app_has_category (app2, "Graphics"));
+}
+
+static void
+gs_app_list_cache_func (void)
+{
+	guint evicted = 0;
+	guint hits = 0;
+	guint misses = 0;
+	g_autoptr(GsAppList) list = gs_app_list_new ();
+	g_autoptr(GsApp) app_pinned = NULL;
+	g_autoptr(GsApp) app_stale = NULL;
+
+	/* add more than fits */
+	for (guint i = 0; i < 4; i++) {
+		g_autofree gchar *id = g_strdup_printf ("app%u.desktop", i);
+		g_autoptr(GsApp) app = gs_app_new (id);
+		gs_app_list_add (list, app);
+	}
+	gs_app_list_set_cache_limits (list, 2, 0);
+	g_assert_cmpint (gs_app_list_length (list), ==, 4);
+
+	/* apps on screen or installed are kept */
+	app_pinned = g_object_ref (gs_app_list_index (list, 0));
+	gs_app_shown_inc (app_pinned);
+	gs_app_set_state (gs_app_list_index (list, 1), AS_APP_STATE_INSTALLED);
+
+	/* holding a reference does not pin the app */
+	app_stale = g_object_ref (gs_app_list_index (list, 2));
+	g_assert_cmpint (gs_app_list_expire (list), ==, 2);
+	g_assert_cmpint (gs_app_list_length (list), ==, 2);
+	g_assert (gs_app_list_index (list, 0) == app_pinned);
+	g_assert (gs_app_list_lookup (list, gs_app_get_unique_id (app_pinned)) != NULL);
+	g_assert (gs_app_list_lookup (list, gs_app_get_unique_id (app_stale)) == NULL);
+	g_assert (gs_app_list_lookup (list, "*/*/*/*/app3.desktop/*") == NULL);
+	gs_app_list_get_cache_stats (list, &hits, &misses, &evicted);
+	g_assert_cmpint (hits, ==, 1);
+	g_assert_cmpint (misses, ==, 2);
+	g_assert_cmpint (evicted, ==, 2);
+
+	/* once off screen it can be expired too */
+	gs_app_shown_dec (app_pinned);
+	gs_app_list_set_cache_limits (list, 1, 0);
+	g_assert_cmpint (gs_app_list_expire (list), ==, 1);
+	g_assert_cmpint (gs_app_list_length (list), ==, 1);
+	g_assert (gs_app_list_lookup (list, gs_app_get_unique_id (app_pinned)) == NULL);
+}
+
+static void
+gs_app_refined_flags_func (void)
+{
+	g_autoptr(GsApp) app = gs_app_new ("test.desktop");
+
+	/* flags accumulate for the same serial */
+	g_assert_cmpint (gs_app_get_refined_flags (app, 0), ==, 0);
+	gs_app_add_refined_flags (app, GS_PLUGIN_REFINE_FLAGS_REQUIRE_ICON, 0);
+	gs_app_add_refined_flags (app, GS_PLUGIN_REFINE_FLAGS_REQUIRE_SIZE, 0);
+	g_assert_cmpint (gs_app_get_refined_flags (app, 0), ==,
+			 GS_PLUGIN_REFINE_FLAGS_REQUIRE_ICON |
+			 GS_PLUGIN_REFINE_FLAGS_REQUIRE_SIZE);
+
+	/* a new serial invalidates the old flags */
+	g_assert_cmpint (gs_app_get_refined_flags (app, 1), ==, 0);
+	gs_app_add_refined_flags (app, GS_PLUGIN_REFINE_FLAGS_REQUIRE_ICON, 1);
+	g_assert_cmpint (gs_app_get_refined_flags (app, 1), ==,
+			 GS_PLUGIN_REFINE_FLAGS_REQUIRE_ICON);
+
+	/* so does a state change */
+	gs_app_set_state (app, AS_APP_STATE_AVAILABLE);
+	g_assert_cmpint (gs_app_get_refined_flags (app, 1), ==, 0);
+}
+
 static void
 gs_app_func (void)
 {
 	g_autoptr(GsApp) app = NULL;
+	guint created = gs_app_get_created_count ();
+	gsize size;
 
 	app = gs_app_new ("gnome-software.desktop");
 	g_assert (GS_IS_APP (app));
 	g_assert_cmpstr (gs_app_get_id (app), ==, "gnome-software.desktop");
+	g_assert_cmpint (gs_app_get_created_count () - created, ==, 1);
+
+	/* check the strings are counted */
+	size = gs_app_get_memory_size (app);
+	gs_app_set_summary (app, GS_APP_QUALITY_NORMAL, "0123456789");
+	g_assert_cmpint (gs_app_get_memory_size (app), ==, size + 11);
+
+	/* rarely used lists are shared until something is added */
+	g_assert (gs_app_get_screenshots (app) != NULL);
+	g_assert (gs_app_get_screenshots (app) == gs_app_get_reviews (app));
+	g_assert (gs_app_get_metadata_item (app, "GnomeSoftware::test") == NULL);
+	gs_app_set_metadata (app, "GnomeSoftware::test", "value");
+	g_assert_cmpstr (gs_app_get_metadata_item (app, "GnomeSoftware::test"), ==, "value");
+	g_assert_cmpint (gs_app_get_reviews (app)->len, ==, 0);
 
 	/* check we clean up the version, but not at the expense of having
 	 * the same string as the update version */
@@ -643,12 +994,18 @@ main (int argc, char **argv)
 	g_test_add_func ("/gnome-software/lib/utils{error}", gs_utils_error_func);
 	g_test_add_func ("/gnome-software/lib/utils{cache}", gs_utils_cache_func);
 	g_test_add_func ("/gnome-software/lib/utils{append-kv}", gs_utils_append_kv_func);
+	g_test_add_func ("/gnome-software/lib/utils{intern}", gs_utils_intern_func);
 	g_test_add_func ("/gnome-software/lib/os-release", gs_os_release_func);
 	g_test_add_func ("/gnome-software/lib/app", gs_app_func);
 	g_test_add_func ("/gnome-software/lib/app{addons}", gs_app_addons_func);
+	g_test_add_func ("/gnome-software/lib/app{refined-flags}", gs_app_refined_flags_func);
+	g_test_add_func ("/gnome-software/lib/app{snapshot}", gs_app_snapshot_func);
+	g_test_add_func ("/gnome-software/lib/app-list{cache}", gs_app_list_cache_func);
 	g_test_add_func ("/gnome-software/lib/app{unique-id}", gs_app_unique_id_func);
 	g_test_add_func ("/gnome-software/lib/app{thread}", gs_app_thread_func);
 	g_test_add_func ("/gnome-software/lib/plugin", gs_plugin_func);
+	g_test_add_func ("/gnome-software/lib/plugin{rank}", gs_plugin_rank_func);
+	g_test_add_func ("/gnome-software/lib/plugin{job-key}", gs_plugin_job_key_func);
 	g_test_add_func ("/gnome-software/lib/plugin{download-rewrite}", gs_plugin_download_rewrite_func);
 	g_test_add_func ("/gnome-software/lib/plugin{global-cache}", gs_plugin_global_cache_func);
 	g_test_add_func ("/gnome-software/lib/auth{secret}", gs_auth_secret_func);
@@ -0,0 +1,322 @@
+/* -*- Mode: C; tab-width: 8; indent-tabs-mode: t; c-basic-offset: 8 -*-
+ *
+ * Copyright (C) 2017 Richard Hughes <richard@hughsie.com>
+ *
+ * Licensed under the GNU General Public License Version 2
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <glib/gstdio.h>
+
+#include "gs-trace.h"
+
+/* writes events in the Trace Event Format, which can be loaded into
+ * chrome://tracing or https://ui.perfetto.dev/ */
+
+typedef enum {
+	GS_TRACE_STATE_UNKNOWN,
+	GS_TRACE_STATE_DISABLED,
+	GS_TRACE_STATE_ENABLED
+} GsTraceState;
+
+static gint gs_trace_state = GS_TRACE_STATE_UNKNOWN;
+static gint gs_trace_tid_next = 1;
+static GMutex gs_trace_mutex;
+static FILE *gs_trace_file = NULL;
+static gboolean gs_trace_first = TRUE;
+static GPrivate gs_trace_tid;
+
+static void
+gs_trace_close_atexit (void)
+{
+	gs_trace_close ();
+}
+
+/* must be called with the mutex held */
+static void
+gs_trace_close_locked (void)
+{
+	if (gs_trace_file == NULL)
+		return;
+	fputs ("\n]\n", gs_trace_file);
+	fclose (gs_trace_file);
+	gs_trace_file = NULL;
+}
+
+/* must be called with the mutex held */
+static gboolean
+gs_trace_open_locked (const gchar *filename)
+{
+	static gboolean atexit_done = FALSE;
+
+	gs_trace_close_locked ();
+	gs_trace_file = g_fopen (filename, "w");
+	if (gs_trace_file == NULL) {
+		g_warning ("failed to open trace file %s", filename);
+		return FALSE;
+	}
+	fputs ("[", gs_trace_file);
+	gs_trace_first = TRUE;
+	if (!atexit_done) {
+		atexit (gs_trace_close_atexit);
+		atexit_done = TRUE;
+	}
+	return TRUE;
+}
+
+/**
+ * gs_trace_set_filename:
+ * @filename: a filename, or %NULL to stop tracing
+ *
+ * Starts writing trace events to @filename, overriding the `GS_TRACE`
+ * environment variable.
+ **/
+void
+gs_trace_set_filename (const gchar *filename)
+{
+	gboolean ret = FALSE;
+
+	if (filename == NULL) {
+		gs_trace_close ();
+		return;
+	}
+	g_mutex_lock (&gs_trace_mutex);
+	ret = gs_trace_open_locked (filename);
+	g_mutex_unlock (&gs_trace_mutex);
+	g_atomic_int_set (&gs_trace_state, ret ? GS_TRACE_STATE_ENABLED :
+						 GS_TRACE_STATE_DISABLED);
+}
+
+/**
+ * gs_trace_is_enabled:
+ *
+ * Gets if trace events are being written, without taking any locks.
+ *
+ * Returns: %TRUE if tracing is enabled
+ **/
+gboolean
+gs_trace_is_enabled (void)
+{
+	gint state = g_atomic_int_get (&gs_trace_state);
+
+	/* the first caller checks the environment */
+	if (G_UNLIKELY (state == GS_TRACE_STATE_UNKNOWN)) {
+		const gchar *filename = g_getenv ("GS_TRACE");
+		state = GS_TRACE_STATE_DISABLED;
+		g_mutex_lock (&gs_trace_mutex);
+		if (gs_trace_file != NULL) {
+			state = GS_TRACE_STATE_ENABLED;
+		} else if (filename != NULL && filename[0] != '\0') {
+			if (gs_trace_open_locked (filename))
+				state = GS_TRACE_STATE_ENABLED;
+		}
+		g_mutex_unlock (&gs_trace_mutex);
+		g_atomic_int_set (&gs_trace_state, state);
+	}
+	return state == GS_TRACE_STATE_ENABLED;
+}
+
+/* a small number for each thread, as the viewers sort by it */
+static gint
+gs_trace_get_tid (gboolean *is_new)
+{
+	gint tid = GPOINTER_TO_INT (g_private_get (&gs_trace_tid));
+	*is_new = tid == 0;
+	if (tid == 0) {
+		tid = g_atomic_int_add (&gs_trace_tid_next, 1);
+		g_private_set (&gs_trace_tid, GINT_TO_POINTER (tid));
+	}
+	return tid;
+}
+
+static void
+gs_trace_append_escaped (GString *str, const gchar *value)
+{
+	g_string_append_c (str, '"');
+	for (const gchar *p = value; *p != '\0'; p++) {
+		if (*p == '"' || *p == '\\')
+			g_string_append_printf (str, "\\%c", *p);
+		else if ((guchar) *p < 0x20)
+			g_string_append_printf (str, "\\u%04x", (guint) *p);
+		else
+			g_string_append_c (str, *p);
+	}
+	g_string_append_c (str, '"');
+}
+
+static void
+gs_trace_write (GString *str)
+{
+	g_mutex_lock (&gs_trace_mutex);
+	if (gs_trace_file != NULL) {
+		fputs (gs_trace_first ? "\n" : ",\n", gs_trace_file);
+		fputs (str->str, gs_trace_file);
+		gs_trace_first = FALSE;
+	}
+	g_mutex_unlock (&gs_trace_mutex);
+}
+
+static GString *
+gs_trace_event_new (const gchar *phase,
+		    const gchar *category,
+		    const gchar *name,
+		    gint64 ts)
+{
+	GString *str = g_string_new (NULL);
+	gboolean is_new;
+	gint tid = gs_trace_get_tid (&is_new);
+
+	/* name the thread the first time it is seen */
+	if (is_new) {
+		g_string_append_printf (str,
+					"{\"ph\":\"M\",\"name\":\"thread_name\","
+					"\"pid\":%i,\"tid\":%i,"
+					"\"args\":{\"name\":\"%s%i\"}}",
+					(gint) getpid (), tid,
+					g_main_context_is_owner (g_main_context_default ()) ?
+					"main-" : "thread-", tid);
+		gs_trace_write (str);
+		g_string_truncate (str, 0);
+	}
+
+	g_string_append_printf (str, "{\"ph\":\"%s\",\"cat\":", phase);
+	gs_trace_append_escaped (str, category);
+	g_string_append (str, ",\"name\":");
+	gs_trace_append_escaped (str, name);
+	g_string_append_printf (str, ",\"pid\":%i,\"tid\":%i,"
+				"\"ts\":%" G_GINT64_FORMAT,
+				(gint) getpid (), tid, ts);
+	return str;
+}
+
+/**
+ * gs_trace_begin:
+ *
+ * Gets the start time for a later call to gs_trace_end().
+ *
+ * Returns: a timestamp, or 0 if tracing is disabled
+ **/
+gint64
+gs_trace_begin (void)
+{
+	if (!gs_trace_is_enabled ())
+		return 0;
+	return g_get_monotonic_time ();
+}
+
+/**
+ * gs_trace_end:
+ * @ts_begin: the value from gs_trace_begin()
+ * @category: a category, e.g. "vfunc"
+ * @name: the event name
+ * @...: pairs of argument names and string values, terminated by %NULL
+ *
+ * Writes an event covering the time since gs_trace_begin() on this thread.
+ * Nothing is written if tracing was not enabled when it started.
+ **/
+void
+gs_trace_end (gint64 ts_begin, const gchar *category, const gchar *name, ...)
+{
+	GString *str;
+	const gchar *key;
+	va_list args;
+
+	if (ts_begin == 0)
+		return;
+	str = gs_trace_event_new ("X", category, name, ts_begin);
+	g_string_append_printf (str, ",\"dur\":%" G_GINT64_FORMAT ",\"args\":{",
+				g_get_monotonic_time () - ts_begin);
+	va_start (args, name);
+	for (key = va_arg (args, const gchar *); key != NULL;
+	     key = va_arg (args, const gchar *)) {
+		const gchar *value = va_arg (args, const gchar *);
+		if (str->str[str->len - 1] != '{')
+			g_string_append_c (str, ',');
+		gs_trace_append_escaped (str, key);
+		g_string_append_c (str, ':');
+		gs_trace_append_escaped (str, value != NULL ? value : "");
+	}
+	va_end (args);
+	g_string_append (str, "}}");
+	gs_trace_write (str);
+	g_string_free (str, TRUE);
+}
+
+static void
+gs_trace_async (const gchar *phase,
+		const gchar *category,
+		const gchar *name,
+		gconstpointer id)
+{
+	GString *str;
+
+	if (!gs_trace_is_enabled ())
+		return;
+	str = gs_trace_event_new (phase, category, name, g_get_monotonic_time ());
+	g_string_append_printf (str, ",\"id\":\"%p\"}", id);
+	gs_trace_write (str);
+	g_string_free (str, TRUE);
+}
+
+/**
+ * gs_trace_async_begin:
+ * @category: a category, e.g. "job"
+ * @name: the event name
+ * @id: a pointer that identifies the operation
+ *
+ * Writes the start of an operation that may finish on a different thread.
+ **/
+void
+gs_trace_async_begin (const gchar *category, const gchar *name, gconstpointer id)
+{
+	gs_trace_async ("b", category, name, id);
+}
+
+/**
+ * gs_trace_async_end:
+ * @category: the category used in gs_trace_async_begin()
+ * @name: the name used in gs_trace_async_begin()
+ * @id: the pointer used in gs_trace_async_begin()
+ *
+ * Writes the end of an operation started with gs_trace_async_begin().
+ **/
+void
+gs_trace_async_end (const gchar *category, const gchar *name, gconstpointer id)
+{
+	gs_trace_async ("e", category, name, id);
+}
+
+/**
+ * gs_trace_close:
+ *
+ * Finishes writing the trace file. This is also done automatically when
+ * the process exits.
+ **/
+void
+gs_trace_close (void)
+{
+	g_mutex_lock (&gs_trace_mutex);
+	gs_trace_close_locked ();
+	g_mutex_unlock (&gs_trace_mutex);
+	g_atomic_int_set (&gs_trace_state, GS_TRACE_STATE_DISABLED);
+}
+
+/* vim: set noexpandtab: */
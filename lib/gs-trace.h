@@ -0,0 +1,48 @@
+/* -*- Mode: C; tab-width: 8; indent-tabs-mode: t; c-basic-offset: 8 -*-
+ *
+ * Copyright (C) 2017 Richard Hughes <richard@hughsie.com>
+ *
+ * Licensed under the GNU General Public License Version 2
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef __GS_TRACE_H
+#define __GS_TRACE_H
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+void		 gs_trace_set_filename	(const gchar	*filename);
+gboolean	 gs_trace_is_enabled	(void);
+gint64		 gs_trace_begin		(void);
+void		 gs_trace_end		(gint64		 ts_begin,
+					 const gchar	*category,
+					 const gchar	*name,
+					 ...) G_GNUC_NULL_TERMINATED;
+void		 gs_trace_async_begin	(const gchar	*category,
+					 const gchar	*name,
+					 gconstpointer	 id);
+void		 gs_trace_async_end	(const gchar	*category,
+					 const gchar	*name,
+					 gconstpointer	 id);
+void		 gs_trace_close		(void);
+
+G_END_DECLS
+
+#endif /* __GS_TRACE_H */
+
+/* vim: set noexpandtab: */
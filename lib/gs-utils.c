@@ -999,4 +999,118 @@ gs_utils_append_key_value (GString *str, gsize align_len,
 	g_string_append (str, "\n");
 }
 
+/* a refcounted pool of shared strings, of string : guint refcount, split by hash
+ * so that threads creating apps do not all wait on the same lock */
+#define GS_UTILS_INTERN_SHARDS		16
+
+typedef struct {
+	GMutex		 mutex;
+	GHashTable	*pool;
+} GsUtilsInternShard;
+
+static GsUtilsInternShard gs_utils_intern_shards[GS_UTILS_INTERN_SHARDS];
+
+static GsUtilsInternShard *
+gs_utils_intern_get_shard (const gchar *str)
+{
+	return &gs_utils_intern_shards[g_str_hash (str) % GS_UTILS_INTERN_SHARDS];
+}
+
+/**
+ * gs_utils_intern_ref:
+ * @str: (nullable): a string, e.g. "org.gnome.Software.desktop"
+ *
+ * Gets a shared copy of a string that is repeated across many objects, such
+ * as an application ID or origin. Two strings returned from this function are
+ * equal if and only if the pointers are equal.
+ *
+ * The returned string must be released with gs_utils_intern_unref().
+ *
+ * Returns: an interned string, or %NULL if @str was %NULL
+ *
+ * Since: 3.26
+ */
+const gchar *
+gs_utils_intern_ref (const gchar *str)
+{
+	GsUtilsInternShard *shard;
+	gpointer key;
+	gpointer value;
+	guint *refcount;
+	g_autoptr(GMutexLocker) locker = NULL;
+
+	if (str == NULL)
+		return NULL;
+
+	shard = gs_utils_intern_get_shard (str);
+	locker = g_mutex_locker_new (&shard->mutex);
+	if (shard->pool == NULL)
+		shard->pool = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+	if (g_hash_table_lookup_extended (shard->pool, str, &key, &value)) {
+		refcount = value;
+		(*refcount)++;
+		return key;
+	}
+	key = g_strdup (str);
+	refcount = g_new (guint, 1);
+	*refcount = 1;
+	g_hash_table_insert (shard->pool, key, refcount);
+	return key;
+}
+
+/**
+ * gs_utils_intern_unref:
+ * @str: (nullable): a string returned from gs_utils_intern_ref()
+ *
+ * Releases a shared string, freeing it when the last user has gone.
+ *
+ * Since: 3.26
+ */
+void
+gs_utils_intern_unref (const gchar *str)
+{
+	GsUtilsInternShard *shard;
+	gpointer key;
+	gpointer value;
+	guint *refcount;
+	g_autoptr(GMutexLocker) locker = NULL;
+
+	if (str == NULL)
+		return;
+
+	shard = gs_utils_intern_get_shard (str);
+	locker = g_mutex_locker_new (&shard->mutex);
+	if (shard->pool == NULL ||
+	    !g_hash_table_lookup_extended (shard->pool, str, &key, &value) ||
+	    key != str) {
+		g_critical ("%s was not interned", str);
+		return;
+	}
+	refcount = value;
+	if (--(*refcount) > 0)
+		return;
+	g_hash_table_remove (shard->pool, key);
+}
+
+/**
+ * gs_utils_unique_id_equal:
+ * @unique_id1: a unique ID
+ * @unique_id2: another unique ID
+ *
+ * Compares two unique IDs, allowing for wildcards. This is the same as
+ * as_utils_unique_id_equal() but returns early when both IDs are the same
+ * interned string.
+ *
+ * Returns: %TRUE if the unique IDs match
+ *
+ * Since: 3.26
+ */
+gboolean
+gs_utils_unique_id_equal (const gchar *unique_id1, const gchar *unique_id2)
+{
+	if (unique_id1 == unique_id2)
+		return TRUE;
+	return as_utils_unique_id_equal (unique_id1, unique_id2);
+}
+
 /* vim: set noexpandtab: */
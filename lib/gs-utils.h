@@ -89,6 +89,10 @@ void		 gs_utils_append_key_value	(GString	*str,
 						 gsize		 align_len,
 						 const gchar	*key,
 						 const gchar	*value);
+const gchar	*gs_utils_intern_ref		(const gchar	*str);
+void		 gs_utils_intern_unref		(const gchar	*str);
+gboolean	 gs_utils_unique_id_equal	(const gchar	*unique_id1,
+						 const gchar	*unique_id2);
 
 G_END_DECLS
 
@@ -34,6 +34,10 @@
 void
 gs_plugin_initialize (GsPlugin *plugin)
 {
+	/* the desktop data is static and only @app is modified */
+	gs_plugin_add_flags (plugin, GS_PLUGIN_FLAGS_PARALLEL_REFINE);
+	gs_plugin_add_refine_flags (plugin, GS_PLUGIN_REFINE_FLAGS_REQUIRE_MENU_PATH);
+
 	/* need categories */
 	gs_plugin_add_rule (plugin, GS_PLUGIN_RULE_RUN_AFTER, "appstream");
 }
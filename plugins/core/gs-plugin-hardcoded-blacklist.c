@@ -32,6 +32,9 @@
 void
 gs_plugin_initialize (GsPlugin *plugin)
 {
+	/* the globs are constant and only @app is modified */
+	gs_plugin_add_flags (plugin, GS_PLUGIN_FLAGS_PARALLEL_REFINE);
+
 	/* need ID */
 	gs_plugin_add_rule (plugin, GS_PLUGIN_RULE_RUN_AFTER, "appstream");
 }
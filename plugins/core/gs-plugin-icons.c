@@ -37,6 +37,7 @@
 struct GsPluginData {
 	GtkIconTheme		*icon_theme;
 	GMutex			 icon_theme_lock;
+	GMutex			 download_lock;
 	GHashTable		*icon_theme_paths;
 };
 
@@ -47,6 +48,12 @@ gs_plugin_initialize (GsPlugin *plugin)
 	priv->icon_theme = gtk_icon_theme_new ();
 	priv->icon_theme_paths = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
 	g_mutex_init (&priv->icon_theme_lock);
+	g_mutex_init (&priv->download_lock);
+
+	/* the shared icon theme is protected by icon_theme_lock and remote
+	 * icons by download_lock, as several apps may share a cache file */
+	gs_plugin_add_flags (plugin, GS_PLUGIN_FLAGS_PARALLEL_REFINE);
+	gs_plugin_add_refine_flags (plugin, GS_PLUGIN_REFINE_FLAGS_REQUIRE_ICON);
 
 	/* needs remote icons downloaded */
 	gs_plugin_add_rule (plugin, GS_PLUGIN_RULE_RUN_AFTER, "appstream");
@@ -60,6 +67,7 @@ gs_plugin_destroy (GsPlugin *plugin)
 	g_object_unref (priv->icon_theme);
 	g_hash_table_unref (priv->icon_theme_paths);
 	g_mutex_clear (&priv->icon_theme_lock);
+	g_mutex_clear (&priv->download_lock);
 }
 
 static gboolean
@@ -157,8 +165,10 @@ gs_plugin_icons_get_cache_fn (AsIcon *icon)
 static GdkPixbuf *
 gs_plugin_icons_load_remote (GsPlugin *plugin, AsIcon *icon, GError **error)
 {
+	GsPluginData *priv = gs_plugin_get_data (plugin);
 	const gchar *fn;
 	gchar *found;
+	g_autoptr(GMutexLocker) locker = NULL;
 
 	/* not applicable for remote */
 	if (as_icon_get_url (icon) == NULL) {
@@ -186,6 +196,7 @@ gs_plugin_icons_load_remote (GsPlugin *plugin, AsIcon *icon, GError **error)
 	}
 
 	/* already in cache */
+	locker = g_mutex_locker_new (&priv->download_lock);
 	if (g_file_test (as_icon_get_filename (icon), G_FILE_TEST_EXISTS))
 		return gs_plugin_icons_load_local (plugin, icon, error);
 
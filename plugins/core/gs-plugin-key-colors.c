@@ -26,6 +26,10 @@
 void
 gs_plugin_initialize (GsPlugin *plugin)
 {
+	/* only the pixbuf and key colors of @app are used */
+	gs_plugin_add_flags (plugin, GS_PLUGIN_FLAGS_PARALLEL_REFINE);
+	gs_plugin_add_refine_flags (plugin, GS_PLUGIN_REFINE_FLAGS_REQUIRE_KEY_COLORS);
+
 	/* need icon */
 	gs_plugin_add_rule (plugin, GS_PLUGIN_RULE_RUN_AFTER, "icons");
 }
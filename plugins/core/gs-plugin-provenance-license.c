@@ -97,6 +97,7 @@ gs_plugin_initialize (GsPlugin *plugin)
 
 	/* need this set */
 	gs_plugin_add_rule (plugin, GS_PLUGIN_RULE_RUN_AFTER, "provenance");
+	gs_plugin_add_refine_flags (plugin, GS_PLUGIN_REFINE_FLAGS_REQUIRE_LICENSE);
 }
 
 void
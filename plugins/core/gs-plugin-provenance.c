@@ -31,6 +31,7 @@
 
 struct GsPluginData {
 	GSettings		*settings;
+	GMutex			 sources_mutex;
 	gchar			**sources;
 };
 
@@ -54,6 +55,7 @@ gs_plugin_provenance_settings_changed_cb (GSettings *settings,
 {
 	GsPluginData *priv = gs_plugin_get_data (plugin);
 	if (g_strcmp0 (key, "official-sources") == 0) {
+		g_autoptr(GMutexLocker) locker = g_mutex_locker_new (&priv->sources_mutex);
 		g_strfreev (priv->sources);
 		priv->sources = gs_plugin_provenance_get_sources (plugin);
 	}
@@ -63,11 +65,17 @@ void
 gs_plugin_initialize (GsPlugin *plugin)
 {
 	GsPluginData *priv = gs_plugin_alloc_data (plugin, sizeof(GsPluginData));
+	g_mutex_init (&priv->sources_mutex);
 	priv->settings = g_settings_new ("org.gnome.software");
 	g_signal_connect (priv->settings, "changed",
 			  G_CALLBACK (gs_plugin_provenance_settings_changed_cb), plugin);
 	priv->sources = gs_plugin_provenance_get_sources (plugin);
 
+	/* the sources can change at runtime and are protected by
+	 * sources_mutex, otherwise only @app is modified */
+	gs_plugin_add_flags (plugin, GS_PLUGIN_FLAGS_PARALLEL_REFINE);
+	gs_plugin_add_refine_flags (plugin, GS_PLUGIN_REFINE_FLAGS_REQUIRE_PROVENANCE);
+
 	/* after the package source is set */
 	gs_plugin_add_rule (plugin, GS_PLUGIN_RULE_RUN_AFTER, "dummy");
 	gs_plugin_add_rule (plugin, GS_PLUGIN_RULE_RUN_AFTER, "packagekit-refine");
@@ -79,6 +87,7 @@ gs_plugin_destroy (GsPlugin *plugin)
 	GsPluginData *priv = gs_plugin_get_data (plugin);
 	g_strfreev (priv->sources);
 	g_object_unref (priv->settings);
+	g_mutex_clear (&priv->sources_mutex);
 }
 
 gboolean
@@ -91,6 +100,7 @@ gs_plugin_refine_app (GsPlugin *plugin,
 	GsPluginData *priv = gs_plugin_get_data (plugin);
 	const gchar *origin;
 	gchar **sources;
+	g_autoptr(GMutexLocker) locker = NULL;
 
 	/* not required */
 	if ((flags & GS_PLUGIN_REFINE_FLAGS_REQUIRE_PROVENANCE) == 0)
@@ -99,6 +109,7 @@ gs_plugin_refine_app (GsPlugin *plugin,
 		return TRUE;
 
 	/* nothing to search */
+	locker = g_mutex_locker_new (&priv->sources_mutex);
 	sources = priv->sources;
 	if (sources == NULL || sources[0] == NULL) {
 		gs_app_add_quirk (app, AS_APP_QUIRK_PROVENANCE);
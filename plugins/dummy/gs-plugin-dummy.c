@@ -64,6 +64,9 @@ gs_plugin_initialize (GsPlugin *plugin)
 	/* set plugin flags */
 	gs_plugin_add_flags (plugin, GS_PLUGIN_FLAGS_GLOBAL_CACHE);
 
+	/* exercise setting up on first use */
+	gs_plugin_add_flags (plugin, GS_PLUGIN_FLAGS_LAZY_SETUP);
+
 	/* toggle this */
 	if (g_getenv ("GS_SELF_TEST_TOGGLE_ALLOW_UPDATES") != NULL) {
 		priv->allow_updates_id = g_timeout_add_seconds (10,
@@ -92,18 +95,6 @@ gs_plugin_initialize (GsPlugin *plugin)
 	/* keep track of what apps are installed */
 	priv->installed_apps = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
 	priv->available_apps = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
-	g_hash_table_insert (priv->available_apps,
-			     g_strdup ("chiron.desktop"),
-			     GUINT_TO_POINTER (1));
-	g_hash_table_insert (priv->available_apps,
-			     g_strdup ("zeus.desktop"),
-			     GUINT_TO_POINTER (1));
-	g_hash_table_insert (priv->available_apps,
-			     g_strdup ("zeus-spell.addon"),
-			     GUINT_TO_POINTER (1));
-	g_hash_table_insert (priv->available_apps,
-			     g_strdup ("com.hughski.ColorHug2.driver"),
-			     GUINT_TO_POINTER (1));
 
 	/* need help from appstream */
 	gs_plugin_add_rule (plugin, GS_PLUGIN_RULE_RUN_AFTER, "appstream");
@@ -127,6 +118,27 @@ gs_plugin_destroy (GsPlugin *plugin)
 		g_object_unref (priv->cached_origin);
 }
 
+gboolean
+gs_plugin_setup (GsPlugin *plugin, GCancellable *cancellable, GError **error)
+{
+	GsPluginData *priv = gs_plugin_get_data (plugin);
+
+	/* lets assume this needs the network to find out */
+	g_hash_table_insert (priv->available_apps,
+			     g_strdup ("chiron.desktop"),
+			     GUINT_TO_POINTER (1));
+	g_hash_table_insert (priv->available_apps,
+			     g_strdup ("zeus.desktop"),
+			     GUINT_TO_POINTER (1));
+	g_hash_table_insert (priv->available_apps,
+			     g_strdup ("zeus-spell.addon"),
+			     GUINT_TO_POINTER (1));
+	g_hash_table_insert (priv->available_apps,
+			     g_strdup ("com.hughski.ColorHug2.driver"),
+			     GUINT_TO_POINTER (1));
+	return TRUE;
+}
+
 void
 gs_plugin_adopt_app (GsPlugin *plugin, GsApp *app)
 {
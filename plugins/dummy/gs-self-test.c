@@ -120,6 +120,30 @@ gs_plugins_dummy_error_func (GsPluginLoader *plugin_loader)
 			GS_PLUGIN_ERROR_DOWNLOAD_FAILED);
 }
 
+static void
+gs_plugins_dummy_lazy_setup_func (GsPluginLoader *plugin_loader)
+{
+	gboolean ret;
+	g_autoptr(GsApp) app = NULL;
+	g_autoptr(GError) error = NULL;
+	g_autoptr(GsPluginJob) plugin_job = NULL;
+
+	/* the dummy plugin has not been used yet, but that must not stop
+	 * other plugins refining apps that it does not manage */
+	app = gs_app_new ("lazy.desktop");
+	gs_app_set_management_plugin (app, "packagekit");
+	gs_app_set_origin (app, "london-west");
+	plugin_job = gs_plugin_job_newv (GS_PLUGIN_ACTION_REFINE,
+					 "app", app,
+					 "refine-flags", GS_PLUGIN_REFINE_FLAGS_REQUIRE_PROVENANCE,
+					 NULL);
+	ret = gs_plugin_loader_job_action (plugin_loader, plugin_job, NULL, &error);
+	gs_test_flush_main_context ();
+	g_assert_no_error (error);
+	g_assert (ret);
+	g_assert (gs_app_has_quirk (app, AS_APP_QUIRK_PROVENANCE));
+}
+
 static void
 gs_plugins_dummy_refine_func (GsPluginLoader *plugin_loader)
 {
@@ -718,7 +742,10 @@ main (int argc, char **argv)
 	g_assert (gs_plugin_loader_get_enabled (plugin_loader, "appstream"));
 	g_assert (gs_plugin_loader_get_enabled (plugin_loader, "dummy"));
 
-	/* plugin tests go here */
+	/* plugin tests go here, this first while the dummy plugin is unused */
+	g_test_add_data_func ("/gnome-software/plugins/dummy/lazy-setup",
+			      plugin_loader,
+			      (GTestDataFunc) gs_plugins_dummy_lazy_setup_func);
 	g_test_add_data_func ("/gnome-software/plugins/dummy/wildcard",
 			      plugin_loader,
 			      (GTestDataFunc) gs_plugins_dummy_wildcard_func);
@@ -78,6 +78,9 @@ gs_plugin_initialize (GsPlugin *plugin)
 
 	/* old name */
 	gs_plugin_add_rule (plugin, GS_PLUGIN_RULE_CONFLICTS, "fedora-distro-upgrades");
+
+	/* only load the collections when actually used */
+	gs_plugin_add_flags (plugin, GS_PLUGIN_FLAGS_LAZY_SETUP);
 }
 
 void
@@ -119,6 +119,9 @@ gs_plugin_initialize (GsPlugin *plugin)
 	/* unique to us */
 	gs_plugin_set_app_gtype (plugin, GS_TYPE_FWUPD_APP);
 
+	/* only connect to the daemon when actually used */
+	gs_plugin_add_flags (plugin, GS_PLUGIN_FLAGS_LAZY_SETUP);
+
 	/* set name of MetaInfo file */
 	gs_plugin_set_appstream_id (plugin, "org.gnome.Software.Plugin.Fwupd");
 }
@@ -40,6 +40,7 @@ struct GsPluginData {
 	gchar			*distro;
 	gchar			*user_hash;
 	gchar			*review_server;
+	GMutex			 ratings_mutex;
 	GHashTable		*ratings;
 	GsApp			*cached_origin;
 };
@@ -54,6 +55,7 @@ gs_plugin_initialize (GsPlugin *plugin)
 	priv->settings = g_settings_new ("org.gnome.software");
 	priv->review_server = g_settings_get_string (priv->settings,
 						     "review-server");
+	g_mutex_init (&priv->ratings_mutex);
 	priv->ratings = g_hash_table_new_full (g_str_hash, g_str_equal,
 					       g_free, (GDestroyNotify) g_array_unref);
 
@@ -88,6 +90,16 @@ gs_plugin_initialize (GsPlugin *plugin)
 			     gs_app_get_unique_id (priv->cached_origin),
 			     priv->cached_origin);
 
+	/* the ratings table is replaced on refresh under ratings_mutex and
+	 * the reviews are cached in a file named after each app ID */
+	gs_plugin_add_flags (plugin, GS_PLUGIN_FLAGS_PARALLEL_REFINE);
+	gs_plugin_add_refine_flags (plugin, GS_PLUGIN_REFINE_FLAGS_REQUIRE_RATING |
+					    GS_PLUGIN_REFINE_FLAGS_REQUIRE_REVIEW_RATINGS |
+					    GS_PLUGIN_REFINE_FLAGS_REQUIRE_REVIEWS);
+
+	/* do not hold up the details page on a slow review server */
+	gs_plugin_set_budget (plugin, GS_PLUGIN_ACTION_REFINE, 1000);
+
 	/* need application IDs and version */
 	gs_plugin_add_rule (plugin, GS_PLUGIN_RULE_RUN_AFTER, "appstream");
 	gs_plugin_add_rule (plugin, GS_PLUGIN_RULE_RUN_AFTER, "flatpak");
@@ -124,10 +136,13 @@ gs_plugin_odrs_load_ratings (GsPlugin *plugin, const gchar *fn, GError **error)
 	JsonNode *json_root;
 	JsonObject *json_item;
 	g_autoptr(GList) apps = NULL;
+	g_autoptr(GHashTable) ratings_new = NULL;
 	g_autoptr(JsonParser) json_parser = NULL;
+	g_autoptr(GMutexLocker) locker = NULL;
 
-	/* remove all existing */
-	g_hash_table_remove_all (priv->ratings);
+	/* built separately so refine_app() can keep using the old table */
+	ratings_new = g_hash_table_new_full (g_str_hash, g_str_equal,
+					     g_free, (GDestroyNotify) g_array_unref);
 
 	/* parse the data and find the success */
 	json_parser = json_parser_new ();
@@ -160,11 +175,16 @@ gs_plugin_odrs_load_ratings (GsPlugin *plugin, const gchar *fn, GError **error)
 		g_autoptr(GArray) ratings = NULL;;
 		ratings = gs_plugin_odrs_load_ratings_for_app (json_app);
 		if (ratings->len == 6) {
-			g_hash_table_insert (priv->ratings,
+			g_hash_table_insert (ratings_new,
 					     g_strdup (app_id),
 					     g_array_ref (ratings));
 		}
 	}
+
+	/* replace all existing */
+	locker = g_mutex_locker_new (&priv->ratings_mutex);
+	g_hash_table_unref (priv->ratings);
+	priv->ratings = g_steal_pointer (&ratings_new);
 	return TRUE;
 }
 
@@ -236,6 +256,7 @@ gs_plugin_destroy (GsPlugin *plugin)
 	g_free (priv->distro);
 	g_free (priv->review_server);
 	g_hash_table_unref (priv->ratings);
+	g_mutex_clear (&priv->ratings_mutex);
 	g_object_unref (priv->settings);
 	g_object_unref (priv->cached_origin);
 }
@@ -523,6 +544,7 @@ gs_plugin_odrs_refine_ratings (GsPlugin *plugin,
 
 	/* get ratings for each reviewable ID */
 	reviewable_ids = _gs_app_get_reviewable_ids (app);
+	g_mutex_lock (&priv->ratings_mutex);
 	for (guint i = 0; i < reviewable_ids->len; i++) {
 		const gchar *id = g_ptr_array_index (reviewable_ids, i);
 		GArray *ratings_tmp = g_hash_table_lookup (priv->ratings, id);
@@ -536,6 +558,7 @@ gs_plugin_odrs_refine_ratings (GsPlugin *plugin,
 			ratings_raw[j] += g_array_index (ratings_tmp, guint32, j);
 		cnt++;
 	}
+	g_mutex_unlock (&priv->ratings_mutex);
 	if (cnt == 0)
 		return TRUE;
 
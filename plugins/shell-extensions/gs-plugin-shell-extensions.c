@@ -73,6 +73,9 @@ gs_plugin_initialize (GsPlugin *plugin)
 	gs_app_set_kind (priv->cached_origin, AS_APP_KIND_SOURCE);
 	gs_app_set_origin_hostname (priv->cached_origin, SHELL_EXTENSIONS_API_URI);
 
+	/* only connect to the shell when actually used */
+	gs_plugin_add_flags (plugin, GS_PLUGIN_FLAGS_LAZY_SETUP);
+
 	/* add the source to the plugin cache which allows us to match the
 	 * unique ID to a GsApp when creating an event */
 	gs_plugin_cache_add (plugin,
@@ -65,6 +65,9 @@ gs_plugin_initialize (GsPlugin *plugin)
 	/* Override hardcoded popular apps */
 	gs_plugin_add_rule (plugin, GS_PLUGIN_RULE_RUN_BEFORE, "hardcoded-popular");
 
+	/* searching the store can be slow, so show local results first */
+	gs_plugin_set_budget (plugin, GS_PLUGIN_ACTION_SEARCH, 2000);
+
 	/* set name of MetaInfo file */
 	gs_plugin_set_appstream_id (plugin, "org.gnome.Software.Plugin.Snap");
 }
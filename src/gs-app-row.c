@@ -559,7 +559,7 @@ gs_app_row_set_app (GsAppRow *app_row, GsApp *app)
 {
 	GsAppRowPrivate *priv = gs_app_row_get_instance_private (app_row);
 
-	priv->app = g_object_ref (app);
+	gs_utils_set_shown_app (&priv->app, app);
 
 	g_signal_connect_object (priv->app, "notify::state",
 				 G_CALLBACK (gs_app_row_notify_props_changed_cb),
@@ -584,7 +584,7 @@ gs_app_row_destroy (GtkWidget *object)
 	if (priv->app)
 		g_signal_handlers_disconnect_by_func (priv->app, gs_app_row_notify_props_changed_cb, app_row);
 
-	g_clear_object (&priv->app);
+	gs_utils_set_shown_app (&priv->app, NULL);
 	if (priv->pending_refresh_id != 0) {
 		g_source_remove (priv->pending_refresh_id);
 		priv->pending_refresh_id = 0;
@@ -43,6 +43,7 @@
 #include "gs-dbus-helper.h"
 #endif
 
+#include "gs-debug.h"
 #include "gs-first-run-dialog.h"
 #include "gs-shell.h"
 #include "gs-update-monitor.h"
@@ -65,9 +66,19 @@ struct _GsApplication {
 	GsDbusHelper	*dbus_helper;
 #endif
 	GsShellSearchProvider *search_provider;
+	guint		 stats_registration_id;
 	GSettings       *settings;
 };
 
+static const gchar gs_application_stats_xml[] =
+	"<node>"
+	"  <interface name='org.gnome.Software.Stats'>"
+	"    <method name='GetPluginStats'>"
+	"      <arg type='a(sssuutttt)' name='stats' direction='out'/>"
+	"    </method>"
+	"  </interface>"
+	"</node>";
+
 G_DEFINE_TYPE (GsApplication, gs_application, GTK_TYPE_APPLICATION);
 
 GsPluginLoader *
@@ -151,6 +162,8 @@ gs_application_initialize_plugins (GsApplication *app)
 	app->plugin_loader = gs_plugin_loader_new ();
 	if (g_file_test (LOCALPLUGINDIR, G_FILE_TEST_EXISTS))
 		gs_plugin_loader_add_location (app->plugin_loader, LOCALPLUGINDIR);
+	gs_plugin_loader_set_snapshot_enabled (app->plugin_loader, TRUE);
+	gs_plugin_loader_set_profile_mode (app->plugin_loader, app->enable_profile_mode);
 	if (!gs_plugin_loader_setup (app->plugin_loader,
 				     plugin_whitelist,
 				     plugin_blacklist,
@@ -166,6 +179,37 @@ gs_application_initialize_plugins (GsApplication *app)
 
 }
 
+static void
+gs_application_stats_method_call (GDBusConnection *connection,
+				  const gchar *sender,
+				  const gchar *object_path,
+				  const gchar *interface_name,
+				  const gchar *method_name,
+				  GVariant *parameters,
+				  GDBusMethodInvocation *invocation,
+				  gpointer user_data)
+{
+	GsApplication *app = GS_APPLICATION (user_data);
+	g_autoptr(GVariant) stats = NULL;
+
+	if (app->plugin_loader == NULL) {
+		g_dbus_method_invocation_return_error_literal (invocation,
+							       G_DBUS_ERROR,
+							       G_DBUS_ERROR_FAILED,
+							       "plugins not loaded");
+		return;
+	}
+	stats = gs_plugin_loader_get_stats (app->plugin_loader);
+	g_dbus_method_invocation_return_value (invocation,
+					       g_variant_new_tuple (&stats, 1));
+}
+
+static const GDBusInterfaceVTable gs_application_stats_vtable = {
+	gs_application_stats_method_call,
+	NULL,
+	NULL
+};
+
 static gboolean
 gs_application_dbus_register (GApplication    *application,
                               GDBusConnection *connection,
@@ -173,6 +217,21 @@ gs_application_dbus_register (GApplication    *application,
                               GError         **error)
 {
 	GsApplication *app = GS_APPLICATION (application);
+	g_autoptr(GDBusNodeInfo) info = NULL;
+
+	/* plugin latency, for gnome-software-cmd stats */
+	info = g_dbus_node_info_new_for_xml (gs_application_stats_xml, error);
+	if (info == NULL)
+		return FALSE;
+	app->stats_registration_id =
+		g_dbus_connection_register_object (connection,
+						   object_path,
+						   info->interfaces[0],
+						   &gs_application_stats_vtable,
+						   app, NULL, error);
+	if (app->stats_registration_id == 0)
+		return FALSE;
+
 	app->search_provider = gs_shell_search_provider_new ();
 	return gs_shell_search_provider_register (app->search_provider, connection, error);
 }
@@ -184,6 +243,11 @@ gs_application_dbus_unregister (GApplication    *application,
 {
 	GsApplication *app = GS_APPLICATION (application);
 
+	if (app->stats_registration_id != 0) {
+		g_dbus_connection_unregister_object (connection,
+						     app->stats_registration_id);
+		app->stats_registration_id = 0;
+	}
 	if (app->search_provider != NULL) {
 		gs_shell_search_provider_unregister (app->search_provider);
 		g_clear_object (&app->search_provider);
@@ -334,8 +398,11 @@ profile_activated (GSimpleAction *action,
 
 	/* dump right now as well */
 	if (app->plugin_loader != NULL) {
-		AsProfile *profile = gs_plugin_loader_get_profile (app->plugin_loader);
+		AsProfile *profile;
+		gs_plugin_loader_set_profile_mode (app->plugin_loader, TRUE);
+		profile = gs_plugin_loader_get_profile (app->plugin_loader);
 		as_profile_dump (profile);
+		gs_plugin_loader_dump_memory (app->plugin_loader);
 	}
 }
 
@@ -865,8 +932,10 @@ gs_application_handle_local_options (GApplication *app, GVariantDict *options)
 	gint rc = -1;
 	g_autoptr(GError) error = NULL;
 
-	if (g_variant_dict_contains (options, "verbose"))
+	if (g_variant_dict_contains (options, "verbose")) {
 		g_setenv ("GS_DEBUG", "1", TRUE);
+		gs_debug_set_verbose (TRUE);
+	}
 
 	/* prefer local sources */
 	if (g_variant_dict_contains (options, "prefer-local"))
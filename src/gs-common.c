@@ -600,4 +600,27 @@ gs_utils_list_has_app_fuzzy (GsAppList *list, GsApp *app)
 	return FALSE;
 }
 
+/**
+ * gs_utils_set_shown_app:
+ * @app_ptr: a pointer to the #GsApp a widget is showing
+ * @app: (allow-none): the new #GsApp, or %NULL
+ *
+ * Replaces the application shown by a widget, like g_set_object(), while
+ * keeping count of how many widgets show each application so that caches
+ * do not expire applications that are on screen.
+ */
+void
+gs_utils_set_shown_app (GsApp **app_ptr, GsApp *app)
+{
+	if (*app_ptr == app)
+		return;
+	if (app != NULL)
+		gs_app_shown_inc (g_object_ref (app));
+	if (*app_ptr != NULL) {
+		gs_app_shown_dec (*app_ptr);
+		g_object_unref (*app_ptr);
+	}
+	*app_ptr = app;
+}
+
 /* vim: set noexpandtab: */
@@ -57,6 +57,8 @@ gchar		*gs_utils_build_unique_id_kind	(AsAppKind	 kind,
 						 const gchar	*id);
 gboolean	 gs_utils_list_has_app_fuzzy	(GsAppList	*list,
 						 GsApp		*app);
+void		 gs_utils_set_shown_app		(GsApp		**app_ptr,
+						 GsApp		*app);
 
 G_END_DECLS
 
@@ -521,6 +521,17 @@ gs_details_page_notify_state_changed_cb (GsApp *app,
 	g_idle_add (gs_details_page_switch_to_idle, g_object_ref (self));
 }
 
+static void gs_details_page_refresh_reviews (GsDetailsPage *self);
+
+static void
+gs_details_page_notify_rating_changed_cb (GsApp *app,
+                                          GParamSpec *pspec,
+                                          GsDetailsPage *self)
+{
+	/* reviews can arrive after the page has been shown */
+	gs_details_page_refresh_reviews (self);
+}
+
 static void
 gs_details_page_screenshot_selected_cb (GtkListBox *list,
                                         GtkListBoxRow *row,
@@ -1094,8 +1105,6 @@ gs_details_page_refresh_addons (GsDetailsPage *self)
 	}
 }
 
-static void gs_details_page_refresh_reviews (GsDetailsPage *self);
-
 typedef struct {
 	GsDetailsPage		*self;
 	AsReview		*review;
@@ -1209,8 +1218,8 @@ gs_details_page_review_button_clicked_cb (GsReviewRow *row,
 static void
 gs_details_page_refresh_reviews (GsDetailsPage *self)
 {
-	GArray *review_ratings = NULL;
-	GPtrArray *reviews;
+	g_autoptr(GArray) review_ratings = NULL;
+	g_autoptr(GPtrArray) reviews = NULL;
 	gboolean show_review_button = TRUE;
 	gboolean show_reviews = FALSE;
 	guint n_reviews = 0;
@@ -1258,7 +1267,9 @@ gs_details_page_refresh_reviews (GsDetailsPage *self)
 			gs_star_widget_set_rating (GS_STAR_WIDGET (self->star),
 						   gs_app_get_rating (self->app));
 		}
-		review_ratings = gs_app_get_review_ratings (self->app);
+		/* plugins that missed the job can still be adding these */
+		review_ratings = gs_app_dup_review_ratings (self->app);
+		reviews = gs_app_dup_reviews (self->app);
 		if (review_ratings != NULL) {
 			gs_review_histogram_set_ratings (GS_REVIEW_HISTOGRAM (self->histogram),
 						         review_ratings);
@@ -1266,8 +1277,8 @@ gs_details_page_refresh_reviews (GsDetailsPage *self)
 		if (review_ratings != NULL) {
 			for (i = 0; i < review_ratings->len; i++)
 				n_reviews += (guint) g_array_index (review_ratings, gint, i);
-		} else if (gs_app_get_reviews (self->app) != NULL) {
-			n_reviews = gs_app_get_reviews (self->app)->len;
+		} else {
+			n_reviews = reviews->len;
 		}
 	}
 
@@ -1299,7 +1310,6 @@ gs_details_page_refresh_reviews (GsDetailsPage *self)
 
 	/* add all the reviews */
 	gs_container_remove_all (GTK_CONTAINER (self->list_box_reviews));
-	reviews = gs_app_get_reviews (self->app);
 	for (i = 0; i < reviews->len; i++) {
 		AsReview *review = g_ptr_array_index (reviews, i);
 		GtkWidget *row = gs_review_row_new (review);
@@ -1363,6 +1373,7 @@ gs_details_page_app_refine2 (GsDetailsPage *self)
 	g_autoptr(GsPluginJob) plugin_job = NULL;
 	plugin_job = gs_plugin_job_newv (GS_PLUGIN_ACTION_REFINE,
 					 "app", self->app,
+					 "priority", GS_PLUGIN_JOB_PRIORITY_INTERACTIVE,
 					 "failure-flags", GS_PLUGIN_FAILURE_FLAGS_USE_EVENTS,
 					 "refine-flags", GS_PLUGIN_REFINE_FLAGS_REQUIRE_RATING |
 							 GS_PLUGIN_REFINE_FLAGS_REQUIRE_REVIEW_RATINGS |
@@ -1491,11 +1502,12 @@ set_app (GsDetailsPage *self, GsApp *app)
 	/* disconnect the old handlers */
 	if (self->app != NULL) {
 		g_signal_handlers_disconnect_by_func (self->app, gs_details_page_notify_state_changed_cb, self);
+		g_signal_handlers_disconnect_by_func (self->app, gs_details_page_notify_rating_changed_cb, self);
 		g_signal_handlers_disconnect_by_func (self->app, gs_details_page_progress_changed_cb, self);
 	}
 
 	/* save app */
-	g_set_object (&self->app, app);
+	gs_utils_set_shown_app (&self->app, app);
 	if (self->app == NULL) {
 		/* switch away from the details view that failed to load */
 		gs_shell_set_mode (self->shell, GS_SHELL_MODE_OVERVIEW);
@@ -1511,6 +1523,9 @@ set_app (GsDetailsPage *self, GsApp *app)
 	g_signal_connect_object (self->app, "notify::license",
 				 G_CALLBACK (gs_details_page_notify_state_changed_cb),
 				 self, 0);
+	g_signal_connect_object (self->app, "notify::rating",
+				 G_CALLBACK (gs_details_page_notify_rating_changed_cb),
+				 self, 0);
 	g_signal_connect_object (self->app, "notify::progress",
 				 G_CALLBACK (gs_details_page_progress_changed_cb),
 				 self, 0);
@@ -1642,6 +1657,7 @@ gs_details_page_load (GsDetailsPage *self)
 	g_autoptr(GsPluginJob) plugin_job = NULL;
 	plugin_job = gs_plugin_job_newv (GS_PLUGIN_ACTION_REFINE,
 					 "app", self->app,
+					 "priority", GS_PLUGIN_JOB_PRIORITY_INTERACTIVE,
 					 "failure-flags", GS_PLUGIN_FAILURE_FLAGS_USE_EVENTS,
 					 "refine-flags", GS_PLUGIN_REFINE_FLAGS_REQUIRE_ICON |
 							 GS_PLUGIN_REFINE_FLAGS_REQUIRE_PERMISSIONS |
@@ -1695,13 +1711,14 @@ gs_details_page_set_app (GsDetailsPage *self, GsApp *app)
 	/* disconnect the old handlers */
 	if (self->app != NULL) {
 		g_signal_handlers_disconnect_by_func (self->app, gs_details_page_notify_state_changed_cb, self);
+		g_signal_handlers_disconnect_by_func (self->app, gs_details_page_notify_rating_changed_cb, self);
 		g_signal_handlers_disconnect_by_func (self->app, gs_details_page_progress_changed_cb, self);
 		g_signal_handlers_disconnect_by_func (self->settings,
 						      settings_changed_cb,
 						      self);
 	}
 	/* save app */
-	g_set_object (&self->app, app);
+	gs_utils_set_shown_app (&self->app, app);
 
 	g_signal_connect_object (self->app, "notify::state",
 				 G_CALLBACK (gs_details_page_notify_state_changed_cb),
@@ -1715,6 +1732,9 @@ gs_details_page_set_app (GsDetailsPage *self, GsApp *app)
 	g_signal_connect_object (self->app, "notify::quirk",
 				 G_CALLBACK (gs_details_page_notify_state_changed_cb),
 				 self, 0);
+	g_signal_connect_object (self->app, "notify::rating",
+				 G_CALLBACK (gs_details_page_notify_rating_changed_cb),
+				 self, 0);
 	g_signal_connect_object (self->app, "notify::progress",
 				 G_CALLBACK (gs_details_page_progress_changed_cb),
 				 self, 0);
@@ -2226,8 +2246,9 @@ gs_details_page_dispose (GObject *object)
 
 	if (self->app != NULL) {
 		g_signal_handlers_disconnect_by_func (self->app, gs_details_page_notify_state_changed_cb, self);
+		g_signal_handlers_disconnect_by_func (self->app, gs_details_page_notify_rating_changed_cb, self);
 		g_signal_handlers_disconnect_by_func (self->app, gs_details_page_progress_changed_cb, self);
-		g_clear_object (&self->app);
+		gs_utils_set_shown_app (&self->app, NULL);
 	}
 	g_clear_object (&self->builder);
 	g_clear_object (&self->plugin_loader);
@@ -132,7 +132,7 @@ gs_moderate_page_selection_changed_cb (GtkListBox *listbox,
 static void
 gs_moderate_page_add_app (GsModeratePage *self, GsApp *app)
 {
-	GPtrArray *reviews;
+	g_autoptr(GPtrArray) reviews = NULL;
 	GtkWidget *app_row;
 	guint i;
 
@@ -150,7 +150,7 @@ gs_moderate_page_add_app (GsModeratePage *self, GsApp *app)
 				    self->sizegroup_button);
 
 	/* add reviews */
-	reviews = gs_app_get_reviews (app);
+	reviews = gs_app_dup_reviews (app);
 	for (i = 0; i < reviews->len; i++) {
 		AsReview *review = g_ptr_array_index (reviews, i);
 		GtkWidget *row = gs_review_row_new (review);
@@ -47,6 +47,8 @@ struct _GsSearchPage
 	gchar			*value;
 	guint			 waiting_id;
 	guint			 max_results;
+	gboolean		 showing_partial;
+	GsAppList		*list_partial;
 
 	GtkWidget		*list_box_search;
 	GtkWidget		*scrolledwindow_search;
@@ -87,6 +89,129 @@ gs_search_page_waiting_cancel (GsSearchPage *self)
 	self->waiting_id = 0;
 }
 
+static gboolean
+gs_search_page_has_app_row (GsSearchPage *self, GsApp *app)
+{
+	g_autoptr(GList) children = NULL;
+
+	children = gtk_container_get_children (GTK_CONTAINER (self->list_box_search));
+	for (GList *l = children; l != NULL; l = l->next) {
+		GsApp *app_tmp;
+		if (!GS_IS_APP_ROW (l->data))
+			continue;
+		app_tmp = gs_app_row_get_app (GS_APP_ROW (l->data));
+		if (g_strcmp0 (gs_app_get_unique_id (app_tmp),
+			       gs_app_get_unique_id (app)) == 0)
+			return TRUE;
+	}
+	return FALSE;
+}
+
+static void
+gs_search_page_add_app_row (GsSearchPage *self, GsAppList *list, GsApp *app)
+{
+	GtkWidget *app_row;
+
+	/* the same app may be returned by more than one plugin */
+	if (gs_search_page_has_app_row (self, app))
+		return;
+
+	app_row = gs_app_row_new (app);
+	if (!gs_app_has_quirk (app, AS_APP_QUIRK_PROVENANCE) ||
+	    gs_utils_list_has_app_fuzzy (list, app))
+		gs_app_row_set_show_source (GS_APP_ROW (app_row), TRUE);
+	g_signal_connect (app_row, "button-clicked",
+			  G_CALLBACK (gs_search_page_app_row_clicked_cb),
+			  self);
+	gtk_container_add (GTK_CONTAINER (self->list_box_search), app_row);
+	gs_app_row_set_size_groups (GS_APP_ROW (app_row),
+				    self->sizegroup_image,
+				    self->sizegroup_name,
+				    self->sizegroup_button);
+	gtk_widget_show (app_row);
+}
+
+static gchar *
+gs_search_page_get_app_sort_key (GsApp *app)
+{
+	GString *key = g_string_sized_new (64);
+
+	/* sort apps before runtimes and extensions */
+	switch (gs_app_get_kind (app)) {
+	case AS_APP_KIND_DESKTOP:
+	case AS_APP_KIND_SHELL_EXTENSION:
+		g_string_append (key, "9:");
+		break;
+	default:
+		g_string_append (key, "1:");
+		break;
+	}
+
+	/* sort missing codecs before applications */
+	switch (gs_app_get_state (app)) {
+	case AS_APP_STATE_UNAVAILABLE:
+		g_string_append (key, "9:");
+		break;
+	default:
+		g_string_append (key, "1:");
+		break;
+	}
+
+	/* sort by the search key */
+	g_string_append_printf (key, "%05x:", gs_app_get_match_value (app));
+
+	/* sort by rating */
+	g_string_append_printf (key, "%03i:", gs_app_get_rating (app));
+
+	/* sort by kudos */
+	g_string_append_printf (key, "%03u:", gs_app_get_kudos_percentage (app));
+
+	/* tie-break with id */
+	g_string_append (key, gs_app_get_unique_id (app));
+
+	return g_string_free (key, FALSE);
+}
+
+static gboolean
+gs_search_page_sort_cb (GsApp *app1, GsApp *app2, gpointer user_data)
+{
+	g_autofree gchar *key1 = NULL;
+	g_autofree gchar *key2 = NULL;
+	key1 = gs_search_page_get_app_sort_key (app1);
+	key2 = gs_search_page_get_app_sort_key (app2);
+	return g_strcmp0 (key2, key1);
+}
+
+static void
+gs_search_page_get_search_partial_cb (GsPluginJob *plugin_job,
+				      GsAppList *list,
+				      gpointer user_data)
+{
+	GsSearchPage *self = GS_SEARCH_PAGE (user_data);
+	g_autoptr(GsAppList) list_shown = NULL;
+
+	/* show the first results while slower plugins are still searching */
+	if (!self->showing_partial) {
+		gs_search_page_waiting_cancel (self);
+		gs_stop_spinner (GTK_SPINNER (self->spinner_search));
+		gtk_stack_set_visible_child_name (GTK_STACK (self->stack_search), "results");
+		self->showing_partial = TRUE;
+	}
+
+	/* each plugin sends its own results, so merge them and show the
+	 * same ordering and limit as the final list will have */
+	gs_app_list_add_list (self->list_partial, list);
+	list_shown = gs_app_list_copy (self->list_partial);
+	gs_app_list_sort (list_shown, gs_search_page_sort_cb, self);
+	if (gs_app_list_length (list_shown) > self->max_results)
+		gs_app_list_truncate (list_shown, self->max_results);
+
+	/* replace the rows rather than appending to them */
+	gs_container_remove_all (GTK_CONTAINER (self->list_box_search));
+	for (guint i = 0; i < gs_app_list_length (list_shown); i++)
+		gs_search_page_add_app_row (self, list_shown, gs_app_list_index (list_shown, i));
+}
+
 static void
 gs_search_page_get_search_cb (GObject *source_object,
                               GAsyncResult *res,
@@ -96,7 +221,6 @@ gs_search_page_get_search_cb (GObject *source_object,
 	GsApp *app;
 	GsSearchPage *self = GS_SEARCH_PAGE (user_data);
 	GsPluginLoader *plugin_loader = GS_PLUGIN_LOADER (source_object);
-	GtkWidget *app_row;
 	g_autoptr(GError) error = NULL;
 	g_autoptr(GsAppList) list = NULL;
 
@@ -129,19 +253,7 @@ gs_search_page_get_search_cb (GObject *source_object,
 	gtk_stack_set_visible_child_name (GTK_STACK (self->stack_search), "results");
 	for (i = 0; i < gs_app_list_length (list); i++) {
 		app = gs_app_list_index (list, i);
-		app_row = gs_app_row_new (app);
-		if (!gs_app_has_quirk (app, AS_APP_QUIRK_PROVENANCE) ||
-		    gs_utils_list_has_app_fuzzy (list, app))
-			gs_app_row_set_show_source (GS_APP_ROW (app_row), TRUE);
-		g_signal_connect (app_row, "button-clicked",
-				  G_CALLBACK (gs_search_page_app_row_clicked_cb),
-				  self);
-		gtk_container_add (GTK_CONTAINER (self->list_box_search), app_row);
-		gs_app_row_set_size_groups (GS_APP_ROW (app_row),
-					    self->sizegroup_image,
-					    self->sizegroup_name,
-					    self->sizegroup_button);
-		gtk_widget_show (app_row);
+		gs_search_page_add_app_row (self, list, app);
 	}
 
 	/* too many results */
@@ -196,57 +308,6 @@ gs_search_page_waiting_show_cb (gpointer user_data)
 	return FALSE;
 }
 
-static gchar *
-gs_search_page_get_app_sort_key (GsApp *app)
-{
-	GString *key = g_string_sized_new (64);
-
-	/* sort apps before runtimes and extensions */
-	switch (gs_app_get_kind (app)) {
-	case AS_APP_KIND_DESKTOP:
-	case AS_APP_KIND_SHELL_EXTENSION:
-		g_string_append (key, "9:");
-		break;
-	default:
-		g_string_append (key, "1:");
-		break;
-	}
-
-	/* sort missing codecs before applications */
-	switch (gs_app_get_state (app)) {
-	case AS_APP_STATE_UNAVAILABLE:
-		g_string_append (key, "9:");
-		break;
-	default:
-		g_string_append (key, "1:");
-		break;
-	}
-
-	/* sort by the search key */
-	g_string_append_printf (key, "%05x:", gs_app_get_match_value (app));
-
-	/* sort by rating */
-	g_string_append_printf (key, "%03i:", gs_app_get_rating (app));
-
-	/* sort by kudos */
-	g_string_append_printf (key, "%03u:", gs_app_get_kudos_percentage (app));
-
-	/* tie-break with id */
-	g_string_append (key, gs_app_get_unique_id (app));
-
-	return g_string_free (key, FALSE);
-}
-
-static gboolean
-gs_search_page_sort_cb (GsApp *app1, GsApp *app2, gpointer user_data)
-{
-	g_autofree gchar *key1 = NULL;
-	g_autofree gchar *key2 = NULL;
-	key1 = gs_search_page_get_app_sort_key (app1);
-	key2 = gs_search_page_get_app_sort_key (app2);
-	return g_strcmp0 (key2, key1);
-}
-
 static void
 gs_search_page_load (GsSearchPage *self)
 {
@@ -258,6 +319,8 @@ gs_search_page_load (GsSearchPage *self)
 		g_object_unref (self->search_cancellable);
 	}
 	self->search_cancellable = g_cancellable_new ();
+	self->showing_partial = FALSE;
+	gs_app_list_remove_all (self->list_partial);
 
 	/* search for apps */
 	gs_search_page_waiting_cancel (self);
@@ -266,6 +329,7 @@ gs_search_page_load (GsSearchPage *self)
 					 "search", self->value,
 					 "max-results", self->max_results,
 					 "timeout", 10,
+					 "priority", GS_PLUGIN_JOB_PRIORITY_INTERACTIVE,
 					 "failure-flags", GS_PLUGIN_FAILURE_FLAGS_USE_EVENTS,
 					 "refine-flags", GS_PLUGIN_REFINE_FLAGS_REQUIRE_ICON |
 							 GS_PLUGIN_REFINE_FLAGS_REQUIRE_VERSION |
@@ -281,6 +345,8 @@ gs_search_page_load (GsSearchPage *self)
 					 NULL);
 	gs_plugin_job_set_sort_func (plugin_job, gs_search_page_sort_cb);
 	gs_plugin_job_set_sort_func_data (plugin_job, self);
+	gs_plugin_job_set_partial_func (plugin_job, gs_search_page_get_search_partial_cb);
+	gs_plugin_job_set_partial_func_data (plugin_job, self);
 	gs_plugin_loader_job_process_async (self->plugin_loader, plugin_job,
 					    self->search_cancellable,
 					    gs_search_page_get_search_cb,
@@ -458,6 +524,7 @@ gs_search_page_dispose (GObject *object)
 	g_clear_object (&self->plugin_loader);
 	g_clear_object (&self->cancellable);
 	g_clear_object (&self->search_cancellable);
+	g_clear_object (&self->list_partial);
 
 	G_OBJECT_CLASS (gs_search_page_parent_class)->dispose (object);
 }
@@ -506,6 +573,7 @@ gs_search_page_init (GsSearchPage *self)
 	self->sizegroup_button = gtk_size_group_new (GTK_SIZE_GROUP_HORIZONTAL);
 
 	self->max_results = GS_SEARCH_PAGE_MAX_RESULTS;
+	self->list_partial = gs_app_list_new ();
 }
 
 GsSearchPage *
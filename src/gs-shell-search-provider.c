@@ -180,6 +180,7 @@ execute_search (GsShellSearchProvider  *self,
 	plugin_job = gs_plugin_job_newv (GS_PLUGIN_ACTION_SEARCH,
 					 "search", value,
 					 "failure-flags", GS_PLUGIN_FAILURE_FLAGS_NONE,
+					 "priority", GS_PLUGIN_JOB_PRIORITY_INTERACTIVE,
 					 "refine-flags", GS_PLUGIN_REFINE_FLAGS_REQUIRE_ICON,
 					 "max-results", GS_SHELL_SEARCH_PROVIDER_MAX_RESULTS,
 					 NULL);
@@ -156,6 +156,7 @@ gs_shell_profile_dump (GsShell *shell)
 		AsProfile *profile = gs_plugin_loader_get_profile (priv->plugin_loader);
 		as_profile_prune (profile, 5000);
 		as_profile_dump (profile);
+		gs_plugin_loader_dump_memory (priv->plugin_loader);
 	}
 }
 
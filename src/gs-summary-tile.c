@@ -126,7 +126,7 @@ gs_summary_tile_set_app (GsAppTile *app_tile, GsApp *app)
 	if (tile->app)
 		g_signal_handlers_disconnect_by_func (tile->app, app_state_changed, tile);
 
-	g_set_object (&tile->app, app);
+	gs_utils_set_shown_app (&tile->app, app);
 	if (!app)
 		return;
 
@@ -176,7 +176,7 @@ gs_summary_tile_destroy (GtkWidget *widget)
 
 	if (tile->app)
 		g_signal_handlers_disconnect_by_func (tile->app, app_state_changed, tile);
-	g_clear_object (&tile->app);
+	gs_utils_set_shown_app (&tile->app, NULL);
 
 	GTK_WIDGET_CLASS (gs_summary_tile_parent_class)->destroy (widget);
 }
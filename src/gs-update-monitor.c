@@ -321,6 +321,7 @@ get_updates (GsUpdateMonitor *monitor)
 	g_debug ("Getting updates");
 	plugin_job = gs_plugin_job_newv (GS_PLUGIN_ACTION_GET_UPDATES,
 					 "failure-flags", GS_PLUGIN_FAILURE_FLAGS_NONE,
+					 "priority", GS_PLUGIN_JOB_PRIORITY_BACKGROUND,
 					 "refine-flags", GS_PLUGIN_REFINE_FLAGS_REQUIRE_UPDATE_DETAILS |
 							 GS_PLUGIN_REFINE_FLAGS_REQUIRE_UPDATE_SEVERITY,
 					 NULL);
@@ -342,6 +343,7 @@ get_upgrades (GsUpdateMonitor *monitor)
 	g_debug ("Getting upgrades");
 	plugin_job = gs_plugin_job_newv (GS_PLUGIN_ACTION_GET_DISTRO_UPDATES,
 					 "failure-flags", GS_PLUGIN_FAILURE_FLAGS_NONE,
+					 "priority", GS_PLUGIN_JOB_PRIORITY_BACKGROUND,
 					 NULL);
 	gs_plugin_loader_job_process_async (monitor->plugin_loader,
 					    plugin_job,
@@ -361,6 +363,7 @@ get_system (GsUpdateMonitor *monitor)
 	plugin_job = gs_plugin_job_newv (GS_PLUGIN_ACTION_REFINE,
 					 "app", app,
 					 "failure-flags", GS_PLUGIN_FAILURE_FLAGS_NONE,
+					 "priority", GS_PLUGIN_JOB_PRIORITY_BACKGROUND,
 					 NULL);
 	gs_plugin_loader_job_process_async (monitor->plugin_loader, plugin_job,
 					    monitor->cancellable,
@@ -472,6 +475,7 @@ check_updates (GsUpdateMonitor *monitor)
 
 	plugin_job = gs_plugin_job_newv (GS_PLUGIN_ACTION_REFRESH,
 					 "failure-flags", GS_PLUGIN_FAILURE_FLAGS_NONE,
+					 "priority", GS_PLUGIN_JOB_PRIORITY_BACKGROUND,
 					 "refresh-flags", refresh_flags,
 					 "age", 60 * 60 * 24,
 					 NULL);
@@ -667,6 +671,7 @@ cleanup_notifications_cb (gpointer user_data)
 	g_debug ("getting historical updates for fresh session");
 	plugin_job = gs_plugin_job_newv (GS_PLUGIN_ACTION_GET_UPDATES_HISTORICAL,
 					 "failure-flags", GS_PLUGIN_FAILURE_FLAGS_NONE,
+					 "priority", GS_PLUGIN_JOB_PRIORITY_BACKGROUND,
 					 NULL);
 	gs_plugin_loader_job_process_async (monitor->plugin_loader,
 					    plugin_job,